@@ -0,0 +1,152 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include "ValueFormat.h"
+#include "TextLayoutCache.h"
+
+//
+// Formatted text for a grid of cells, e.g. a car per row and a column per thing shown about
+// it, each kept together with the raw values it was formatted from. The overlay asks for a
+// cell with the values it would format; if they're the same as last time it gets the text
+// it already has, and only formats when they differ. Most cells (names, numbers, license,
+// iRating, best laps) stay the same from one frame to the next, and comparing two numbers
+// is a lot cheaper than turning them into text again.
+//
+// Each cell also remembers the hash TextLayoutCache needs for its text, so text that
+// didn't change isn't hashed again when it's drawn.
+//
+// Whatever else the text depends on (string ids of a new session string, units) isn't part
+// of the key, so call clear() when that changes.
+//
+class CellCache
+{
+    public:
+
+        // Up to two raw values a cell's text is made from
+        struct Key
+        {
+            long long   a = 0;
+            long long   b = 0;
+
+            Key() {}
+            Key( long long a_, long long b_=0 ) : a(a_), b(b_) {}
+
+            bool operator==( const Key& o ) const { return a == o.a && b == o.b; }
+            bool operator!=( const Key& o ) const { return !(*this == o); }
+        };
+
+        // Floats go into keys by their bits, so any change to the value counts
+        static long long bits( float f )
+        {
+            uint32_t u;
+            memcpy( &u, &f, sizeof(u) );
+            return u;
+        }
+
+        struct Stats
+        {
+            long long   frames = 0;
+            long long   cells = 0;          // cells asked for
+            long long   formatted = 0;      // ...that had to be formatted
+            int         lastCells = 0;      // the same for the last frame only
+            int         lastFormatted = 0;
+        };
+
+        CellCache( int rows=0, int cols=0 )
+        {
+            resize( rows, cols );
+        }
+
+        void resize( int rows, int cols )
+        {
+            m_cols = cols;
+            m_cells.clear();
+            m_cells.resize( (size_t)rows * cols );
+        }
+
+        // Every cell gets formatted again the next time it's asked for
+        void clear()
+        {
+            for( Cell& c : m_cells )
+                c.valid = false;
+        }
+
+        void beginFrame()
+        {
+            m_stats.frames++;
+            m_stats.lastCells = 0;
+            m_stats.lastFormatted = 0;
+        }
+
+        // The cell's text. Returns true if it's already the text for key, otherwise the caller
+        // formats into it (the buffer is cleared) and it is remembered for key from then on.
+        bool get( int row, int col, const Key& key, FormatBuffer*& text )
+        {
+            Cell& c = m_cells[(size_t)row * m_cols + col];
+            text = &c.text;
+            m_stats.cells++;
+            m_stats.lastCells++;
+            if( c.valid && c.key == key )
+                return true;
+
+            m_stats.formatted++;
+            m_stats.lastFormatted++;
+            c.key = key;
+            c.valid = true;
+            c.text.clear();
+            c.textHash = 0;
+            return false;
+        }
+
+        // hashLayoutText() of the cell's text, once it's formatted. Worked out on the first
+        // call after the text changed.
+        unsigned long long textHash( int row, int col )
+        {
+            Cell& c = m_cells[(size_t)row * m_cols + col];
+            if( !c.textHash )
+                c.textHash = hashLayoutText( c.text.c_str(), c.text.size() );
+            return c.textHash;
+        }
+
+        const Stats& getStats() const { return m_stats; }
+
+    private:
+
+        struct Cell
+        {
+            Key             key;
+            bool            valid = false;
+            FormatBuffer    text;
+            unsigned long long textHash = 0;    // 0 until textHash() is asked for
+        };
+
+        int                 m_cols = 0;
+        std::vector<Cell>   m_cells;
+        Stats               m_stats;
+};
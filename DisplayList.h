@@ -0,0 +1,535 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdio.h>
+#include <string.h>
+#include <wchar.h>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+//
+// What an overlay draws in one frame, recorded rather than drawn straight onto the render
+// target: rects, rounded rects, lines, geometries and text runs, each with the color that was
+// current when it was added. Nothing in here is platform specific. Text formats and geometries
+// are opaque handles owned by the overlay (IDWriteTextFormat* and ID2D1Geometry* on Windows),
+// valid until its next onConfigChanged().
+//
+// A DisplayBackend replays a list onto something (D2DDisplayBackend onto the overlay's render
+// target, DisplayListRecorder into memory or a text dump), and DisplayListPresenter only hands
+// a frame to the backend if it differs from the last one drawn.
+//
+class DisplayList
+{
+    public:
+
+        enum class Op : int
+        {
+            FillRect,
+            DrawRect,
+            FillRoundedRect,
+            DrawRoundedRect,
+            DrawLine,
+            DrawGeometry,
+            Text
+        };
+
+        struct Color
+        {
+            float r, g, b, a;
+        };
+
+        // No padding anywhere in here, so whole lists compare with a memcmp
+        struct Cmd
+        {
+            const void* handle;             // text format or geometry
+            Op          op;
+            int         align;              // text alignment, as DWRITE_TEXT_ALIGNMENT
+            Color       color;
+            float       x0, y0, x1, y1;     // rect, line end points, or text column (y0 = ycenter)
+            float       rx, ry;             // corner radii
+            float       strokeWidth;
+            float       fontSize;
+            unsigned    textOffset;         // nul terminated, see getText()
+            unsigned    textLen;
+            unsigned long long textHash;    // hashLayoutText() of the text, 0 if the backend is to work it out
+        };
+        static_assert( sizeof(Cmd) == sizeof(void*) + 16*4 + 8, "DisplayList::Cmd must not have padding" );
+
+        // Start a new frame, keeping the memory
+        void clear()
+        {
+            m_cmds.clear();
+            m_chars.clear();
+            m_color = { 0, 0, 0, 1 };
+        }
+
+        void swap( DisplayList& other )
+        {
+            m_cmds.swap( other.m_cmds );
+            m_chars.swap( other.m_chars );
+            std::swap( m_color, other.m_color );
+        }
+
+        int size() const { return (int)m_cmds.size(); }
+        bool empty() const { return m_cmds.empty(); }
+        const Cmd* begin() const { return m_cmds.data(); }
+        const Cmd* end() const { return m_cmds.data() + m_cmds.size(); }
+        const Cmd& operator[]( int i ) const { return m_cmds[i]; }
+        const wchar_t* getText( const Cmd& c ) const { return &m_chars[c.textOffset]; }
+
+        bool operator==( const DisplayList& other ) const
+        {
+            return m_cmds.size() == other.m_cmds.size() && m_chars.size() == other.m_chars.size() &&
+                   (m_cmds.empty() || !memcmp( m_cmds.data(), other.m_cmds.data(), m_cmds.size()*sizeof(Cmd) )) &&
+                   (m_chars.empty() || !wmemcmp( m_chars.data(), other.m_chars.data(), m_chars.size() ));
+        }
+
+        bool operator!=( const DisplayList& other ) const { return !(*this == other); }
+
+        // Anything with r,g,b,a (float4, D2D1_COLOR_F)
+        template<typename C>
+        void setColor( const C& c )
+        {
+            m_color = { c.r, c.g, c.b, c.a };
+        }
+
+        const Color& getColor() const { return m_color; }
+
+        void fillRect( float x0, float y0, float x1, float y1 )
+        {
+            add( Op::FillRect, x0, y0, x1, y1 );
+        }
+
+        void drawRect( float x0, float y0, float x1, float y1, float strokeWidth=1 )
+        {
+            add( Op::DrawRect, x0, y0, x1, y1 ).strokeWidth = strokeWidth;
+        }
+
+        void fillRoundedRect( float x0, float y0, float x1, float y1, float rx, float ry )
+        {
+            Cmd& c = add( Op::FillRoundedRect, x0, y0, x1, y1 );
+            c.rx = rx;
+            c.ry = ry;
+        }
+
+        void drawRoundedRect( float x0, float y0, float x1, float y1, float rx, float ry, float strokeWidth=1 )
+        {
+            Cmd& c = add( Op::DrawRoundedRect, x0, y0, x1, y1 );
+            c.rx = rx;
+            c.ry = ry;
+            c.strokeWidth = strokeWidth;
+        }
+
+        void drawLine( float x0, float y0, float x1, float y1, float strokeWidth=1 )
+        {
+            add( Op::DrawLine, x0, y0, x1, y1 ).strokeWidth = strokeWidth;
+        }
+
+        void drawGeometry( const void* geometry, float strokeWidth=1 )
+        {
+            Cmd& c = add( Op::DrawGeometry, 0, 0, 0, 0 );
+            c.handle = geometry;
+            c.strokeWidth = strokeWidth;
+        }
+
+        // Single line of text, vertically centered on ycenter, aligned within [xmin,xmax].
+        // Text that is drawn unchanged from frame to frame can come with its hash, see CellCache.
+        void text( const wchar_t* str, const void* format, float fontSize, float xmin, float xmax, float ycenter, int align, unsigned long long textHash=0 )
+        {
+            const size_t len = wcslen( str );
+            Cmd& c = add( Op::Text, xmin, ycenter, xmax, ycenter );
+            c.handle = format;
+            c.align = align;
+            c.fontSize = fontSize;
+            c.textOffset = (unsigned)m_chars.size();
+            c.textLen = (unsigned)len;
+            c.textHash = textHash;
+            m_chars.insert( m_chars.end(), str, str+len+1 );
+        }
+
+        // The same taking D2D1_RECT_F, D2D1_ROUNDED_RECT and float2 alike, and text formats that know their size
+        template<typename R>
+        void fillRect( const R& r )
+        {
+            fillRect( r.left, r.top, r.right, r.bottom );
+        }
+
+        template<typename R>
+        void drawRect( const R& r, float strokeWidth=1 )
+        {
+            drawRect( r.left, r.top, r.right, r.bottom, strokeWidth );
+        }
+
+        template<typename RR>
+        void fillRoundedRect( const RR& rr )
+        {
+            fillRoundedRect( rr.rect.left, rr.rect.top, rr.rect.right, rr.rect.bottom, rr.radiusX, rr.radiusY );
+        }
+
+        template<typename RR>
+        void drawRoundedRect( const RR& rr, float strokeWidth=1 )
+        {
+            drawRoundedRect( rr.rect.left, rr.rect.top, rr.rect.right, rr.rect.bottom, rr.radiusX, rr.radiusY, strokeWidth );
+        }
+
+        template<typename P>
+        void drawLine( const P& p0, const P& p1, float strokeWidth=1 )
+        {
+            drawLine( p0.x, p0.y, p1.x, p1.y, strokeWidth );
+        }
+
+        template<typename Format, typename = decltype( std::declval<Format&>().GetFontSize() )>
+        void text( const wchar_t* str, Format* format, float xmin, float xmax, float ycenter, int align, unsigned long long textHash=0 )
+        {
+            text( str, format, format->GetFontSize(), xmin, xmax, ycenter, align, textHash );
+        }
+
+    private:
+
+        Cmd& add( Op op, float x0, float y0, float x1, float y1 )
+        {
+            m_cmds.emplace_back();
+            Cmd& c = m_cmds.back();
+            c = {};
+            c.op = op;
+            c.color = m_color;
+            c.x0 = x0;
+            c.y0 = y0;
+            c.x1 = x1;
+            c.y1 = y1;
+            return c;
+        }
+
+        std::vector<Cmd>        m_cmds;
+        std::vector<wchar_t>    m_chars;
+        Color                   m_color = { 0, 0, 0, 1 };
+};
+
+// Draws whole frames
+class DisplayBackend
+{
+    public:
+
+        virtual         ~DisplayBackend() {}
+
+        // Draw dl onto a cleared target
+        virtual void    draw( const DisplayList& dl ) = 0;
+};
+
+//
+// Skips frames that look exactly like the last one drawn, so an overlay showing the same
+// thing as before (paused, in the garage, standings between two lap crossings) costs
+// neither the replay nor the Present.
+//
+class DisplayListPresenter
+{
+    public:
+
+        struct Stats
+        {
+            long long   frames = 0;
+            long long   drawn = 0;
+            long long   skipped = 0;
+        };
+
+        // Returns whether dl was drawn, in which case the caller needs to present. Either way,
+        // dl is left holding some earlier frame, so clear() it before recording the next one.
+        bool present( DisplayList& dl, DisplayBackend& backend )
+        {
+            m_stats.frames++;
+            if( m_valid && dl == m_last )
+            {
+                m_stats.skipped++;
+                return false;
+            }
+
+            backend.draw( dl );
+            m_last.swap( dl );
+            m_valid = true;
+            m_stats.drawn++;
+            return true;
+        }
+
+        // Draw the next frame no matter what, e.g. because the target was resized or recreated,
+        // or the handles in the last frame may have been released and reused
+        void invalidate()
+        {
+            m_valid = false;
+        }
+
+        const DisplayList& getLast() const { return m_last; }
+        const Stats& getStats() const { return m_stats; }
+
+    private:
+
+        DisplayList     m_last;
+        bool            m_valid = false;
+        Stats           m_stats;
+};
+
+//
+// Headless backend: keeps the last frame it was given and counts frames and commands, and
+// optionally writes every frame it's given to a text file, one command per line, which
+// DisplayListDumpReader reads back. Handles are written as the order in which they were
+// first seen, so dumps of two runs can be diffed. Frames the presenter skipped can be
+// reported with skip(); each frame's header says how many came before it.
+//
+class DisplayListRecorder : public DisplayBackend
+{
+    public:
+
+        explicit DisplayListRecorder( FILE* fp=nullptr, const char* name="" )
+            : m_fp( fp )
+            , m_name( name )
+        {}
+
+        virtual void draw( const DisplayList& dl )
+        {
+            if( m_fp )
+                dump( dl );
+            m_frames++;
+            m_cmds += dl.size();
+            m_skippedBefore = 0;
+            m_last = dl;
+        }
+
+        // A frame that wasn't drawn because it looked like the last one
+        void skip()
+        {
+            m_skippedBefore++;
+            m_skipped++;
+        }
+
+        // Geometry handles are opaque, so whoever builds one can describe its outline here, as
+        // line segments (x0,y0,x1,y1 each), for a raster backend reading the dump to draw
+        void defineGeometry( const void* handle, const std::vector<float>& segments )
+        {
+            if( !m_fp )
+                return;
+            fprintf( m_fp, "geometry #%d: %d segments", handleId(handle), (int)segments.size()/4 );
+            for( size_t i=0; i+3<segments.size(); i+=4 )
+                fprintf( m_fp, " %.2f,%.2f,%.2f,%.2f", segments[i], segments[i+1], segments[i+2], segments[i+3] );
+            fprintf( m_fp, "\n" );
+        }
+
+        long long getFrames() const { return m_frames; }
+        long long getSkipped() const { return m_skipped; }
+        long long getCommands() const { return m_cmds; }
+        const DisplayList& getLast() const { return m_last; }
+
+    private:
+
+        int handleId( const void* handle )
+        {
+            for( int i=0; i<(int)m_handles.size(); ++i )
+                if( m_handles[i] == handle )
+                    return i;
+            m_handles.push_back( handle );
+            return (int)m_handles.size() - 1;
+        }
+
+        void dump( const DisplayList& dl )
+        {
+            static const char* const opNames[] = { "fillrect", "drawrect", "fillroundedrect", "drawroundedrect", "line", "geometry", "text" };
+
+            fprintf( m_fp, "%s%sframe %lld: %d commands, %lld skipped before\n", m_name, *m_name ? " " : "", m_frames, dl.size(), m_skippedBefore );
+            for( const DisplayList::Cmd& c : dl )
+            {
+                fprintf( m_fp, "  %-15s rgba(%.3f,%.3f,%.3f,%.3f)", opNames[(int)c.op], c.color.r, c.color.g, c.color.b, c.color.a );
+                switch( c.op )
+                {
+                    case DisplayList::Op::FillRect:
+                        fprintf( m_fp, " %.1f,%.1f %.1f,%.1f\n", c.x0, c.y0, c.x1, c.y1 );
+                        break;
+                    case DisplayList::Op::DrawRect:
+                    case DisplayList::Op::DrawLine:
+                        fprintf( m_fp, " %.1f,%.1f %.1f,%.1f width %.1f\n", c.x0, c.y0, c.x1, c.y1, c.strokeWidth );
+                        break;
+                    case DisplayList::Op::FillRoundedRect:
+                        fprintf( m_fp, " %.1f,%.1f %.1f,%.1f radius %.1f,%.1f\n", c.x0, c.y0, c.x1, c.y1, c.rx, c.ry );
+                        break;
+                    case DisplayList::Op::DrawRoundedRect:
+                        fprintf( m_fp, " %.1f,%.1f %.1f,%.1f radius %.1f,%.1f width %.1f\n", c.x0, c.y0, c.x1, c.y1, c.rx, c.ry, c.strokeWidth );
+                        break;
+                    case DisplayList::Op::DrawGeometry:
+                        fprintf( m_fp, " #%d width %.1f\n", handleId(c.handle), c.strokeWidth );
+                        break;
+                    case DisplayList::Op::Text:
+                    {
+                        fprintf( m_fp, " font #%d size %.1f x %.1f..%.1f y %.1f align %d \"", handleId(c.handle), c.fontSize, c.x0, c.x1, c.y0, c.align );
+                        for( const wchar_t* s = dl.getText(c); *s; ++s )
+                            fputc( *s < 0x80 ? (char)*s : '?', m_fp );
+                        fprintf( m_fp, "\"\n" );
+                        break;
+                    }
+                }
+            }
+        }
+
+        FILE*                       m_fp = nullptr;
+        const char*                 m_name = "";
+        long long                   m_frames = 0;
+        long long                   m_skipped = 0;
+        long long                   m_skippedBefore = 0;    // since the last frame drawn
+        long long                   m_cmds = 0;
+        DisplayList                 m_last;
+        std::vector<const void*>    m_handles;
+};
+
+//
+// Reads back what DisplayListRecorder wrote, one frame at a time. Handles in the frames it
+// returns are made up (the number from the dump, plus one), with geometry outlines from the
+// dump available through getGeometry().
+//
+class DisplayListDumpReader
+{
+    public:
+
+        explicit DisplayListDumpReader( FILE* fp )
+            : m_fp( fp )
+        {}
+
+        // Next frame in the file, and the name of the recorder that wrote it (empty if none)
+        bool readFrame( std::string& name, DisplayList& dl )
+        {
+            dl.clear();
+            m_skippedBefore = 0;
+            bool inFrame = false;
+            char line[4096];
+            while( true )
+            {
+                const long pos = ftell( m_fp );
+                if( !fgets( line, sizeof(line), m_fp ) )
+                    return inFrame;
+
+                if( line[0] == ' ' )
+                {
+                    if( inFrame )
+                        parseCmd( line, dl );
+                    continue;
+                }
+
+                if( !strncmp( line, "geometry #", 10 ) )
+                {
+                    parseGeometry( line );
+                    continue;
+                }
+
+                const char* frame = strstr( line, "frame " );
+                if( !frame )
+                    continue;
+                if( inFrame )
+                {
+                    fseek( m_fp, pos, SEEK_SET );   // start of the next one
+                    return true;
+                }
+                name.assign( line, frame > line ? frame - line - 1 : 0 );
+                if( sscanf( frame, "frame %*d: %*d commands, %lld skipped", &m_skippedBefore ) != 1 )
+                    m_skippedBefore = 0;    // dumps from before skip() was there
+                inFrame = true;
+            }
+        }
+
+        // Frames the presenter skipped between the last frame read and the one before it
+        long long getSkippedBefore() const { return m_skippedBefore; }
+
+        const std::vector<float>* getGeometry( const void* handle ) const
+        {
+            const size_t id = (uintptr_t)handle - 1;
+            return id < m_geometries.size() && !m_geometries[id].empty() ? &m_geometries[id] : nullptr;
+        }
+
+    private:
+
+        static const void* toHandle( int id )
+        {
+            return (const void*)(uintptr_t)(id + 1);
+        }
+
+        void parseGeometry( const char* line )
+        {
+            int id = 0, n = 0, len = 0;
+            if( sscanf( line, "geometry #%d: %d segments%n", &id, &n, &len ) < 2 || id < 0 )
+                return;
+            if( (int)m_geometries.size() <= id )
+                m_geometries.resize( id + 1 );
+            std::vector<float>& segs = m_geometries[id];
+            segs.clear();
+            const char* s = line + len;
+            float x0, y0, x1, y1;
+            for( int i=0; i<n && sscanf( s, " %f,%f,%f,%f%n", &x0, &y0, &x1, &y1, &len ) == 4; ++i, s += len )
+            {
+                segs.push_back( x0 );
+                segs.push_back( y0 );
+                segs.push_back( x1 );
+                segs.push_back( y1 );
+            }
+        }
+
+        void parseCmd( const char* line, DisplayList& dl )
+        {
+            char op[32];
+            DisplayList::Color c;
+            int len = 0;
+            if( sscanf( line, " %31s rgba(%f,%f,%f,%f)%n", op, &c.r, &c.g, &c.b, &c.a, &len ) < 5 )
+                return;
+            dl.setColor( c );
+
+            const char* s = line + len;
+            float x0 = 0, y0 = 0, x1 = 0, y1 = 0, rx = 0, ry = 0, w = 1;
+            int id = 0;
+            if( !strcmp( op, "fillrect" ) && sscanf( s, " %f,%f %f,%f", &x0, &y0, &x1, &y1 ) == 4 )
+                dl.fillRect( x0, y0, x1, y1 );
+            else if( !strcmp( op, "drawrect" ) && sscanf( s, " %f,%f %f,%f width %f", &x0, &y0, &x1, &y1, &w ) == 5 )
+                dl.drawRect( x0, y0, x1, y1, w );
+            else if( !strcmp( op, "line" ) && sscanf( s, " %f,%f %f,%f width %f", &x0, &y0, &x1, &y1, &w ) == 5 )
+                dl.drawLine( x0, y0, x1, y1, w );
+            else if( !strcmp( op, "fillroundedrect" ) && sscanf( s, " %f,%f %f,%f radius %f,%f", &x0, &y0, &x1, &y1, &rx, &ry ) == 6 )
+                dl.fillRoundedRect( x0, y0, x1, y1, rx, ry );
+            else if( !strcmp( op, "drawroundedrect" ) && sscanf( s, " %f,%f %f,%f radius %f,%f width %f", &x0, &y0, &x1, &y1, &rx, &ry, &w ) == 7 )
+                dl.drawRoundedRect( x0, y0, x1, y1, rx, ry, w );
+            else if( !strcmp( op, "geometry" ) && sscanf( s, " #%d width %f", &id, &w ) == 2 )
+                dl.drawGeometry( toHandle(id), w );
+            else if( !strcmp( op, "text" ) )
+            {
+                float size = 0;
+                int align = 0;
+                const char* q0 = strchr( s, '"' );
+                const char* q1 = strrchr( s, '"' );
+                if( sscanf( s, " font #%d size %f x %f..%f y %f align %d", &id, &size, &x0, &x1, &y0, &align ) != 6 || !q0 || q1 <= q0 )
+                    return;
+                m_text.assign( q0+1, q1 );
+                dl.text( m_text.c_str(), toHandle(id), size, x0, x1, y0, align );
+            }
+        }
+
+        FILE*                           m_fp = nullptr;
+        long long                       m_skippedBefore = 0;
+        std::vector<std::vector<float>> m_geometries;
+        std::wstring                    m_text;
+};
@@ -0,0 +1,109 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <d2d1_3.h>
+#include <dwrite.h>
+#include "DisplayList.h"
+#include "util.h"
+
+//
+// Replays a DisplayList onto a Direct2D render target. Handles in the list are the
+// IDWriteTextFormat* and ID2D1Geometry* the overlay recorded, text goes through TextCache.
+//
+class D2DDisplayBackend : public DisplayBackend
+{
+    public:
+
+        // The overlay's render target gets recreated on resize, so this is set before every frame
+        void setTarget( ID2D1RenderTarget* renderTarget, ID2D1SolidColorBrush* brush, TextCache* text )
+        {
+            m_renderTarget = renderTarget;
+            m_brush = brush;
+            m_text = text;
+        }
+
+        virtual void draw( const DisplayList& dl )
+        {
+            m_text->beginFrame();
+            m_renderTarget->BeginDraw();
+            m_renderTarget->Clear( float4(0,0,0,0) );
+
+            DisplayList::Color col = { -1, -1, -1, -1 };
+            for( const DisplayList::Cmd& c : dl )
+            {
+                if( memcmp( &col, &c.color, sizeof(col) ) )
+                {
+                    col = c.color;
+                    m_brush->SetColor( float4(col.r,col.g,col.b,col.a) );
+                }
+
+                switch( c.op )
+                {
+                    case DisplayList::Op::FillRect:
+                    {
+                        const D2D1_RECT_F r = { c.x0, c.y0, c.x1, c.y1 };
+                        m_renderTarget->FillRectangle( &r, m_brush );
+                        break;
+                    }
+                    case DisplayList::Op::DrawRect:
+                    {
+                        const D2D1_RECT_F r = { c.x0, c.y0, c.x1, c.y1 };
+                        m_renderTarget->DrawRectangle( &r, m_brush, c.strokeWidth );
+                        break;
+                    }
+                    case DisplayList::Op::FillRoundedRect:
+                    {
+                        const D2D1_ROUNDED_RECT rr = { { c.x0, c.y0, c.x1, c.y1 }, c.rx, c.ry };
+                        m_renderTarget->FillRoundedRectangle( &rr, m_brush );
+                        break;
+                    }
+                    case DisplayList::Op::DrawRoundedRect:
+                    {
+                        const D2D1_ROUNDED_RECT rr = { { c.x0, c.y0, c.x1, c.y1 }, c.rx, c.ry };
+                        m_renderTarget->DrawRoundedRectangle( &rr, m_brush, c.strokeWidth );
+                        break;
+                    }
+                    case DisplayList::Op::DrawLine:
+                        m_renderTarget->DrawLine( float2(c.x0,c.y0), float2(c.x1,c.y1), m_brush, c.strokeWidth );
+                        break;
+                    case DisplayList::Op::DrawGeometry:
+                        m_renderTarget->DrawGeometry( (ID2D1Geometry*)c.handle, m_brush, c.strokeWidth );
+                        break;
+                    case DisplayList::Op::Text:
+                        m_text->render( m_renderTarget, dl.getText(c), (IDWriteTextFormat*)c.handle, c.x0, c.x1, c.y0, m_brush, (DWRITE_TEXT_ALIGNMENT)c.align, (int)c.textLen, c.textHash );
+                        break;
+                }
+            }
+
+            m_renderTarget->EndDraw();
+        }
+
+    private:
+
+        ID2D1RenderTarget*      m_renderTarget = nullptr;
+        ID2D1SolidColorBrush*   m_brush = nullptr;
+        TextCache*              m_text = nullptr;
+};
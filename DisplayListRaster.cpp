@@ -0,0 +1,375 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include "DisplayListRaster.h"
+
+// 5x7 pixel font for ASCII 32..126, one byte per row from the top, bit 4 is the leftmost column
+static const uint8_t Font5x7[95][7] =
+{
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // ' '
+    { 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04 },   // '!'
+    { 0x0A, 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00 },   // '"'
+    { 0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A },   // '#'
+    { 0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04 },   // '$'
+    { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 },   // '%'
+    { 0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D },   // '&'
+    { 0x04, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00 },   // '''
+    { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 },   // '('
+    { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 },   // ')'
+    { 0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00 },   // '*'
+    { 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 },   // '+'
+    { 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 },   // ','
+    { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 },   // '-'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C },   // '.'
+    { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 },   // '/'
+    { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E },   // '0'
+    { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E },   // '1'
+    { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F },   // '2'
+    { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E },   // '3'
+    { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 },   // '4'
+    { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E },   // '5'
+    { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E },   // '6'
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 },   // '7'
+    { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E },   // '8'
+    { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C },   // '9'
+    { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 },   // ':'
+    { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08 },   // ';'
+    { 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02 },   // '<'
+    { 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 },   // '='
+    { 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08 },   // '>'
+    { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 },   // '?'
+    { 0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E },   // '@'
+    { 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 },   // 'A'
+    { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E },   // 'B'
+    { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E },   // 'C'
+    { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C },   // 'D'
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F },   // 'E'
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 },   // 'F'
+    { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F },   // 'G'
+    { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 },   // 'H'
+    { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E },   // 'I'
+    { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C },   // 'J'
+    { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 },   // 'K'
+    { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F },   // 'L'
+    { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 },   // 'M'
+    { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 },   // 'N'
+    { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E },   // 'O'
+    { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 },   // 'P'
+    { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D },   // 'Q'
+    { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 },   // 'R'
+    { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E },   // 'S'
+    { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 },   // 'T'
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E },   // 'U'
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 },   // 'V'
+    { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A },   // 'W'
+    { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 },   // 'X'
+    { 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04, 0x04 },   // 'Y'
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F },   // 'Z'
+    { 0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E },   // '['
+    { 0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00 },   // backslash
+    { 0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E },   // ']'
+    { 0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00 },   // '^'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F },   // '_'
+    { 0x08, 0x04, 0x02, 0x00, 0x00, 0x00, 0x00 },   // '`'
+    { 0x00, 0x00, 0x0E, 0x01, 0x0F, 0x11, 0x0F },   // 'a'
+    { 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x1E },   // 'b'
+    { 0x00, 0x00, 0x0E, 0x10, 0x10, 0x11, 0x0E },   // 'c'
+    { 0x01, 0x01, 0x0D, 0x13, 0x11, 0x11, 0x0F },   // 'd'
+    { 0x00, 0x00, 0x0E, 0x11, 0x1F, 0x10, 0x0E },   // 'e'
+    { 0x06, 0x09, 0x08, 0x1C, 0x08, 0x08, 0x08 },   // 'f'
+    { 0x00, 0x0F, 0x11, 0x11, 0x0F, 0x01, 0x0E },   // 'g'
+    { 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x11 },   // 'h'
+    { 0x04, 0x00, 0x0C, 0x04, 0x04, 0x04, 0x0E },   // 'i'
+    { 0x02, 0x00, 0x06, 0x02, 0x02, 0x12, 0x0C },   // 'j'
+    { 0x10, 0x10, 0x12, 0x14, 0x18, 0x14, 0x12 },   // 'k'
+    { 0x0C, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E },   // 'l'
+    { 0x00, 0x00, 0x1A, 0x15, 0x15, 0x11, 0x11 },   // 'm'
+    { 0x00, 0x00, 0x16, 0x19, 0x11, 0x11, 0x11 },   // 'n'
+    { 0x00, 0x00, 0x0E, 0x11, 0x11, 0x11, 0x0E },   // 'o'
+    { 0x00, 0x00, 0x1E, 0x11, 0x1E, 0x10, 0x10 },   // 'p'
+    { 0x00, 0x00, 0x0D, 0x13, 0x0F, 0x01, 0x01 },   // 'q'
+    { 0x00, 0x00, 0x16, 0x19, 0x10, 0x10, 0x10 },   // 'r'
+    { 0x00, 0x00, 0x0E, 0x10, 0x0E, 0x01, 0x1E },   // 's'
+    { 0x08, 0x08, 0x1C, 0x08, 0x08, 0x09, 0x06 },   // 't'
+    { 0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0D },   // 'u'
+    { 0x00, 0x00, 0x11, 0x11, 0x11, 0x0A, 0x04 },   // 'v'
+    { 0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0A },   // 'w'
+    { 0x00, 0x00, 0x11, 0x0A, 0x04, 0x0A, 0x11 },   // 'x'
+    { 0x00, 0x00, 0x11, 0x11, 0x0F, 0x01, 0x0E },   // 'y'
+    { 0x00, 0x00, 0x1F, 0x02, 0x04, 0x08, 0x1F },   // 'z'
+    { 0x02, 0x04, 0x04, 0x08, 0x04, 0x04, 0x02 },   // '{'
+    { 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 },   // '|'
+    { 0x08, 0x04, 0x04, 0x02, 0x04, 0x04, 0x08 },   // '}'
+    { 0x00, 0x00, 0x08, 0x15, 0x02, 0x00, 0x00 },   // '~'
+};
+
+static const int   GlyphCols = 5;
+static const int   GlyphRows = 7;
+static const float GlyphAdvance = 6;        // in font pixels, one column of spacing
+static const float FontPixelsPerEm = 10;    // so 7 rows come out about as tall as DirectWrite's capitals
+
+RasterDisplayBackend::RasterDisplayBackend( int width, int height, float scale )
+{
+    resize( width, height, scale );
+}
+
+void RasterDisplayBackend::resize( int width, int height, float scale )
+{
+    m_width = std::max( width, 0 );
+    m_height = std::max( height, 0 );
+    m_scale = scale;
+    m_pixels.assign( (size_t)m_width * m_height * 4, 0 );
+}
+
+void RasterDisplayBackend::defineGeometry( const void* handle, const std::vector<float>& segments )
+{
+    m_geometries[handle] = segments;
+}
+
+void RasterDisplayBackend::draw( const DisplayList& dl )
+{
+    std::fill( m_pixels.begin(), m_pixels.end(), (uint8_t)0 );
+
+    const float s = m_scale;
+    for( const DisplayList::Cmd& c : dl )
+    {
+        const Paint p = { c.color.r * c.color.a * 255, c.color.g * c.color.a * 255, c.color.b * c.color.a * 255, c.color.a };
+        switch( c.op )
+        {
+            case DisplayList::Op::FillRect:
+                fillRect( c.x0*s, c.y0*s, c.x1*s, c.y1*s, p );
+                break;
+            case DisplayList::Op::DrawRect:
+                roundedRect( c.x0*s, c.y0*s, c.x1*s, c.y1*s, 0, 0, c.strokeWidth*s, false, p );
+                break;
+            case DisplayList::Op::FillRoundedRect:
+                roundedRect( c.x0*s, c.y0*s, c.x1*s, c.y1*s, c.rx*s, c.ry*s, 0, true, p );
+                break;
+            case DisplayList::Op::DrawRoundedRect:
+                roundedRect( c.x0*s, c.y0*s, c.x1*s, c.y1*s, c.rx*s, c.ry*s, c.strokeWidth*s, false, p );
+                break;
+            case DisplayList::Op::DrawLine:
+                line( c.x0*s, c.y0*s, c.x1*s, c.y1*s, c.strokeWidth*s, p );
+                break;
+            case DisplayList::Op::DrawGeometry:
+            {
+                auto it = m_geometries.find( c.handle );
+                if( it == m_geometries.end() )
+                {
+                    m_undefinedGeometries++;
+                    break;
+                }
+                const std::vector<float>& seg = it->second;
+                for( size_t i=0; i+3<seg.size(); i+=4 )
+                    line( seg[i]*s, seg[i+1]*s, seg[i+2]*s, seg[i+3]*s, c.strokeWidth*s, p );
+                break;
+            }
+            case DisplayList::Op::Text:
+                text( dl.getText(c), c.fontSize*s, c.x0*s, c.x1*s, c.y0*s, c.align, p );
+                break;
+        }
+    }
+}
+
+void RasterDisplayBackend::blend( uint8_t* px, int count, float coverage, const Paint& p )
+{
+    // Source-over in 8 bit fixed point, the paint scaled by coverage once for the whole span.
+    // Premultiplied channels never exceed alpha, so src + dst*(255-sa)/255 can't overflow.
+    const uint32_t sr = (uint32_t)(p.r * coverage + 0.5f);
+    const uint32_t sg = (uint32_t)(p.g * coverage + 0.5f);
+    const uint32_t sb = (uint32_t)(p.b * coverage + 0.5f);
+    const uint32_t sa = (uint32_t)(p.a * coverage * 255 + 0.5f);
+    const uint32_t src = sr | sg << 8 | sb << 16 | sa << 24;
+    if( !src )
+        return;
+
+    // Two channels per multiply, each divided by 255 with rounding
+    const uint32_t inv = 255 - sa;
+    for( int i=0; i<count; ++i, px+=4 )
+    {
+        uint32_t dst;
+        memcpy( &dst, px, 4 );
+        uint32_t rb = (dst & 0x00ff00ff) * inv + 0x00800080;
+        uint32_t ga = ((dst >> 8) & 0x00ff00ff) * inv + 0x00800080;
+        rb = ((rb + ((rb >> 8) & 0x00ff00ff)) >> 8) & 0x00ff00ff;
+        ga = (ga + ((ga >> 8) & 0x00ff00ff)) & 0xff00ff00;
+        dst = src + (rb | ga);
+        memcpy( px, &dst, 4 );
+    }
+}
+
+void RasterDisplayBackend::fillRect( float x0, float y0, float x1, float y1, const Paint& p, float clipX0, float clipX1 )
+{
+    x0 = std::max( x0, std::max( clipX0, 0.0f ) );
+    x1 = std::min( x1, std::min( clipX1, (float)m_width ) );
+    y0 = std::max( y0, 0.0f );
+    y1 = std::min( y1, (float)m_height );
+    if( x1 <= x0 || y1 <= y0 )
+        return;
+
+    // Partially covered pixels along the edges get the fraction of them that is covered
+    const int px0 = (int)x0, px1 = (int)ceilf( x1 );
+    const int py0 = (int)y0, py1 = (int)ceilf( y1 );
+    for( int py=py0; py<py1; ++py )
+    {
+        const float cy = std::min( py+1.0f, y1 ) - std::max( (float)py, y0 );
+        uint8_t* row = &m_pixels[((size_t)py * m_width + px0) * 4];
+        if( px1 - px0 == 1 )
+        {
+            blend( row, 1, (x1 - x0) * cy, p );
+            continue;
+        }
+        blend( row, 1, (px0 + 1 - x0) * cy, p );
+        blend( row + 4, px1 - px0 - 2, cy, p );
+        blend( row + (px1 - px0 - 1) * 4, 1, (x1 - (px1 - 1)) * cy, p );
+    }
+}
+
+void RasterDisplayBackend::roundedRect( float x0, float y0, float x1, float y1, float rx, float ry, float strokeWidth, bool fill, const Paint& p )
+{
+    // Coverage from the distance of each pixel center to the outline
+    const float cx = (x0 + x1) * 0.5f, cy = (y0 + y1) * 0.5f;
+    const float hx = fabsf( x1 - x0 ) * 0.5f, hy = fabsf( y1 - y0 ) * 0.5f;
+    const float r = std::max( 0.0f, std::min( std::min(rx,ry), std::min(hx,hy) ) );
+    const float halfWidth = fill ? 0 : strokeWidth * 0.5f;
+    const float thin = fill ? 1 : std::min( strokeWidth, 1.0f );
+
+    const int px0 = std::max( 0, (int)floorf( cx - hx - halfWidth - 1 ) );
+    const int px1 = std::min( m_width, (int)ceilf( cx + hx + halfWidth + 1 ) );
+    const int py0 = std::max( 0, (int)floorf( cy - hy - halfWidth - 1 ) );
+    const int py1 = std::min( m_height, (int)ceilf( cy + hy + halfWidth + 1 ) );
+    for( int py=py0; py<py1; ++py )
+    {
+        const float dy = fabsf( py + 0.5f - cy ) - hy;
+        const float qy = dy + r;
+        uint8_t* row = &m_pixels[((size_t)py * m_width + px0) * 4];
+
+        // Away from the corners the distance is max(|x-cx|-hx, dy), so between the left and
+        // right edge bands it is either dy or deep enough inside that coverage no longer changes.
+        // That span gets one coverage value without the per-pixel distance.
+        int in0 = px1, in1 = px1;
+        if( qy <= 0 )
+        {
+            const float e = std::min( std::max( dy, -(halfWidth + 0.5f) ), -r );
+            in0 = std::min( px1, std::max( px0, (int)ceilf( cx - hx - e - 0.5f ) ) );
+            in1 = std::max( in0, std::min( px1, (int)floorf( cx + hx + e - 0.5f ) + 1 ) );
+        }
+
+        auto edge = [&]( int from, int to ) {
+            uint8_t* px = row + (from - px0) * 4;
+            for( int x=from; x<to; ++x, px+=4 )
+            {
+                const float qx = fabsf( x + 0.5f - cx ) - (hx - r);
+                const float ox = std::max( qx, 0.0f ), oy = std::max( qy, 0.0f );
+                const float d = sqrtf( ox*ox + oy*oy ) + std::min( std::max(qx,qy), 0.0f ) - r;
+                const float cov = fill ? 0.5f - d : halfWidth + 0.5f - fabsf( d );
+                if( cov > 0 )
+                    blend( px, 1, std::min( cov, 1.0f ) * thin, p );
+            }
+        };
+
+        edge( px0, in0 );
+        const float inCov = std::min( fill ? 0.5f - dy : halfWidth + 0.5f - fabsf( dy ), 1.0f ) * thin;
+        if( inCov > 0 )
+            blend( row + (in0 - px0) * 4, in1 - in0, inCov, p );
+        edge( in1, px1 );
+    }
+}
+
+void RasterDisplayBackend::line( float x0, float y0, float x1, float y1, float strokeWidth, const Paint& p )
+{
+    const float halfWidth = strokeWidth * 0.5f;
+    const float thin = std::min( strokeWidth, 1.0f );
+    const float dx = x1 - x0, dy = y1 - y0;
+    const float len = sqrtf( dx*dx + dy*dy );
+    const float ux = len > 0 ? dx / len : 1, uy = len > 0 ? dy / len : 0;
+
+    const int px0 = std::max( 0, (int)floorf( std::min(x0,x1) - halfWidth - 1 ) );
+    const int px1 = std::min( m_width, (int)ceilf( std::max(x0,x1) + halfWidth + 1 ) );
+    const int py0 = std::max( 0, (int)floorf( std::min(y0,y1) - halfWidth - 1 ) );
+    const int py1 = std::min( m_height, (int)ceilf( std::max(y0,y1) + halfWidth + 1 ) );
+    for( int py=py0; py<py1; ++py )
+    {
+        uint8_t* row = &m_pixels[((size_t)py * m_width + px0) * 4];
+        for( int px=px0; px<px1; ++px, row+=4 )
+        {
+            // Across the line, and along it past either end, with square caps so outlines
+            // made of segments get filled corners
+            const float ex = px + 0.5f - x0, ey = py + 0.5f - y0;
+            const float along = ex*ux + ey*uy;
+            const float across = fabsf( ex*uy - ey*ux );
+            const float beyond = std::max( -along, along - len );
+            const float d = std::max( across, beyond );
+            const float cov = halfWidth + 0.5f - d;
+            if( cov > 0 )
+                blend( row, 1, std::min( cov, 1.0f ) * thin, p );
+        }
+    }
+}
+
+void RasterDisplayBackend::text( const wchar_t* str, float fontSize, float xmin, float xmax, float ycenter, int align, const Paint& p )
+{
+    if( xmax < xmin || fontSize <= 0 )
+        return;
+
+    const int len = (int)wcslen( str );
+    const float u = fontSize / FontPixelsPerEm;
+    const float width = len > 0 ? (len * GlyphAdvance - 1) * u : 0;
+
+    // Alignment as DWRITE_TEXT_ALIGNMENT: leading, trailing, center (and justified, which is leading for one line)
+    float x = xmin;
+    if( align == 1 )
+        x = xmax - width;
+    else if( align == 2 )
+        x = (xmin + xmax - width) * 0.5f;
+    x = floorf( x + 0.5f );
+    const float y = floorf( ycenter - GlyphRows * u * 0.5f + 0.5f );
+
+    for( int i=0; i<len; ++i, x += GlyphAdvance * u )
+    {
+        const wchar_t ch = str[i];
+        const uint8_t* glyph = Font5x7[(ch >= 32 && ch < 127 ? ch : L'?') - 32];
+        for( int row=0; row<GlyphRows; ++row )
+        {
+            // Runs of set pixels in a row are one rect, so they don't show seams
+            const unsigned bits = glyph[row];
+            for( int col=0; col<GlyphCols; )
+            {
+                if( !(bits & (0x10 >> col)) )
+                {
+                    col++;
+                    continue;
+                }
+                int end = col + 1;
+                while( end < GlyphCols && (bits & (0x10 >> end)) )
+                    end++;
+                fillRect( x + col*u, y + row*u, x + end*u, y + (row+1)*u, p, xmin, xmax );
+                col = end;
+            }
+        }
+    }
+}
@@ -0,0 +1,81 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+#include "DisplayList.h"
+
+//
+// Replays a DisplayList on the CPU into an RGBA framebuffer, premultiplied like the overlays'
+// swap chains, so drawing can be timed and checked against golden images without Windows or
+// a GPU (see tools/cmd_rasterbench.cpp).
+//
+// Shapes are anti-aliased by how much of each pixel they cover. Text uses a built in 5x7 pixel
+// font scaled to the font size: it gets the layout, alignment, clipping and amount of ink
+// about right, not what DirectWrite would draw. Geometry handles are opaque, so only
+// the ones given an outline with defineGeometry() get drawn, the rest are counted.
+//
+class RasterDisplayBackend : public DisplayBackend
+{
+    public:
+
+                        RasterDisplayBackend( int width=0, int height=0, float scale=1 );
+
+        // Framebuffer size in pixels, and how many pixels a display list unit is
+        void            resize( int width, int height, float scale=1 );
+
+        // Outline for a geometry handle, as line segments (x0,y0,x1,y1 each)
+        void            defineGeometry( const void* handle, const std::vector<float>& segments );
+
+        virtual void    draw( const DisplayList& dl );
+
+        int             getWidth() const { return m_width; }
+        int             getHeight() const { return m_height; }
+        const uint8_t*  getPixels() const { return m_pixels.data(); }   // r,g,b,a per pixel, rows top to bottom
+        long long       getUndefinedGeometries() const { return m_undefinedGeometries; }
+
+    private:
+
+        // Color premultiplied by its alpha, r,g,b scaled to 0..255
+        struct Paint
+        {
+            float r, g, b, a;
+        };
+
+        void            fillRect( float x0, float y0, float x1, float y1, const Paint& p, float clipX0=-1e9f, float clipX1=1e9f );
+        void            roundedRect( float x0, float y0, float x1, float y1, float rx, float ry, float strokeWidth, bool fill, const Paint& p );
+        void            line( float x0, float y0, float x1, float y1, float strokeWidth, const Paint& p );
+        void            text( const wchar_t* str, float fontSize, float xmin, float xmax, float ycenter, int align, const Paint& p );
+        static void     blend( uint8_t* px, int count, float coverage, const Paint& p );
+
+        int                     m_width = 0;
+        int                     m_height = 0;
+        float                   m_scale = 1;
+        std::vector<uint8_t>    m_pixels;
+        long long               m_undefinedGeometries = 0;
+        std::unordered_map<const void*,std::vector<float>>  m_geometries;
+};
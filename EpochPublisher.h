@@ -0,0 +1,137 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+// Hands immutable objects from one writer thread to any number of reader threads.
+//
+// The writer publishes a fresh object by swapping a pointer, so readers never wait for it
+// and never see a half-built object.  Replaced objects are freed once no reader can still
+// be looking at them, which is tracked with epochs: a reader announces the epoch it pinned
+// in, and an object retired in epoch r is only freed when every active reader pinned after r.
+//
+// Each reader thread uses its own slot, 0..MaxReaders-1.  What pin() returns stays valid
+// until that slot's next pin() or unpin().
+template<typename T>
+class EpochPublisher
+{
+public:
+
+    static const int MaxReaders = 4;
+
+    explicit EpochPublisher( T* initial )
+        : m_current( initial )
+        , m_epoch( 1 )
+    {
+        for( auto& r : m_readers )
+            r = 0;
+    }
+
+    ~EpochPublisher()
+    {
+        delete m_current.load();
+        for( const Retired& r : m_retired )
+            delete r.obj;
+    }
+
+    EpochPublisher( const EpochPublisher& ) = delete;
+    EpochPublisher& operator=( const EpochPublisher& ) = delete;
+
+    // Reader side
+    const T* pin( int reader )
+    {
+        m_readers[reader].store( m_epoch.load() );
+        return m_current.load();
+    }
+
+    void unpin( int reader )
+    {
+        m_readers[reader].store( 0 );
+    }
+
+    // Writer side. The latest object, for building the next one from.
+    const T* latest() const
+    {
+        return m_current.load();
+    }
+
+    // Writer side. Takes ownership of obj.
+    void publish( T* obj )
+    {
+        T* old = m_current.exchange( obj );
+        {
+            std::lock_guard<std::mutex> lock( m_retiredMutex );
+            m_retired.push_back( { old, m_epoch.fetch_add(1) } );
+        }
+        reclaim();
+    }
+
+    // Free whatever no reader can see anymore. publish() does this too.
+    void reclaim()
+    {
+        unsigned long long minEpoch = ~0ull;
+        for( const auto& r : m_readers )
+        {
+            const unsigned long long e = r.load();
+            if( e && e < minEpoch )
+                minEpoch = e;
+        }
+
+        std::lock_guard<std::mutex> lock( m_retiredMutex );
+        size_t kept = 0;
+        for( const Retired& r : m_retired )
+        {
+            if( r.epoch < minEpoch )
+                delete r.obj;
+            else
+                m_retired[kept++] = r;
+        }
+        m_retired.resize( kept );
+    }
+
+    size_t numRetired() const
+    {
+        std::lock_guard<std::mutex> lock( m_retiredMutex );
+        return m_retired.size();
+    }
+
+private:
+
+    struct Retired
+    {
+        T*                  obj;
+        unsigned long long  epoch;
+    };
+
+    std::atomic<T*>                     m_current;
+    std::atomic<unsigned long long>     m_epoch;
+    std::atomic<unsigned long long>     m_readers[MaxReaders];
+
+    mutable std::mutex                  m_retiredMutex;
+    std::vector<Retired>                m_retired;
+};
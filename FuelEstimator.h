@@ -0,0 +1,114 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <deque>
+#include <algorithm>
+#include "irsdk/irsdk_defines.h"
+
+// Per-lap fuel bookkeeping behind the HUD's fuel box.  Kept free of the live telemetry
+// so it can be fed from the live sim or from recorded columns (see irsdkColumns).
+class FuelEstimator
+{
+public:
+
+    // Flags that make a lap unrepresentative of green-flag fuel use
+    static const int InvalidLapFlags = irsdk_yellow | irsdk_yellowWaving | irsdk_red | irsdk_checkered | irsdk_crossed | irsdk_oneLapToGreen | irsdk_caution | irsdk_cautionWaving | irsdk_disqualify | irsdk_repair;
+
+    void configure( bool allLapsCount, int numLapsToAvg )
+    {
+        m_allLapsCount = allLapsCount;
+        m_numLapsToAvg = numLapsToAvg;
+    }
+
+    // Start over, e.g. on a session change
+    void reset( float fuelLevel )
+    {
+        m_isLapValid = false;  // avoid confusing the fuel calculator logic with session changes
+        m_remainingAtLapStart = fuelLevel;
+        m_lapsUsed.clear();
+    }
+
+    // Call when the car starts a new lap, with the state at that moment
+    void onLapChanged( float fuelLevel, int sessionFlags, bool onPitRoad )
+    {
+        m_used = std::max( 0.0f, m_remainingAtLapStart - fuelLevel );
+        m_remainingAtLapStart = fuelLevel;
+
+        if( m_isLapValid )
+            m_lapsUsed.push_back( m_used );
+
+        while( (int)m_lapsUsed.size() >= m_numLapsToAvg && !m_lapsUsed.empty() )
+            m_lapsUsed.pop_front();
+
+        if( m_allLapsCount )
+            m_isLapValid = true;
+        else
+            m_isLapValid = !(sessionFlags & InvalidLapFlags) && !onPitRoad;
+    }
+
+    // Fuel used on the last completed lap, valid or not
+    float lastLapUsed() const { return m_used; }
+
+    // Average over the laps we kept, 0 if there are none yet
+    float avgPerLap() const
+    {
+        if( m_lapsUsed.empty() )
+            return 0;
+
+        float sum = 0;
+        for( float v : m_lapsUsed )
+            sum += v;
+        return sum / (float)m_lapsUsed.size();
+    }
+
+    // Fuel left when crossing the finish line, never negative
+    float atFinish( float remainingFuel, float remainingLaps ) const
+    {
+        return std::max( 0.0f, remainingFuel - remainingLaps * avgPerLap() );
+    }
+
+    // Fuel to add at the next stop to make the finish, plus additionalLaps worth of margin
+    float toAdd( float remainingFuel, float remainingLaps, float additionalLaps ) const
+    {
+        if( atFinish(remainingFuel, remainingLaps) > 0 )
+            return 0;
+
+        float add = remainingLaps * avgPerLap() - remainingFuel;
+        if( additionalLaps > 0 )
+            add += avgPerLap() * additionalLaps;
+        return add;
+    }
+
+private:
+
+    float               m_remainingAtLapStart = 0;
+    std::deque<float>   m_lapsUsed;
+    bool                m_isLapValid = false;
+    float               m_used = 0;
+
+    bool                m_allLapsCount = true;
+    int                 m_numLapsToAvg = 5;
+};
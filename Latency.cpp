@@ -0,0 +1,190 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <windows.h>
+#include <algorithm>
+#include <fstream>
+#include "nlohmann/json.hpp"
+#include "Latency.h"
+#include "OverlayDebug.h"
+
+using json = nlohmann::json;
+
+LatencyTracker g_latency;
+
+static const double HistogramBinMs = 0.1;
+
+void LatencyHistogram::add( double ms )
+{
+    const int bin = std::min( NumBins-1, std::max( 0, int(ms / HistogramBinMs) ) );
+    m_bins[bin]++;
+    m_count++;
+    m_max = std::max( m_max, ms );
+}
+
+void LatencyHistogram::reset()
+{
+    std::fill( m_bins.begin(), m_bins.end(), 0 );
+    m_count = 0;
+    m_max = 0;
+}
+
+double LatencyHistogram::percentile( double p ) const
+{
+    if( !m_count )
+        return 0;
+
+    const double target = p * m_count;
+    long long cnt = 0;
+    for( int i=0; i<NumBins; ++i )
+    {
+        cnt += m_bins[i];
+        if( cnt >= target && cnt > 0 )
+            return std::min( m_max, (i + 0.5) * HistogramBinMs );
+    }
+    return m_max;
+}
+
+long long LatencyTracker::now()
+{
+    LARGE_INTEGER t;
+    QueryPerformanceCounter( &t );
+    return t.QuadPart;
+}
+
+double LatencyTracker::toMs( long long qpcTicks )
+{
+    static const long long freq = [](){ LARGE_INTEGER f; QueryPerformanceFrequency( &f ); return f.QuadPart; }();
+    return double(qpcTicks) * 1000.0 / double(freq);
+}
+
+void LatencyTracker::beginFrame( int tickCount, long long lineTime, long long tickStart, long long tickEnd )
+{
+    if( m_frameStart )
+        m_frameMs.add( toMs(tickStart - m_frameStart) );
+    m_frameStart = tickStart;
+    m_frames++;
+
+    m_tickMs.add( toMs(tickEnd - tickStart) );
+
+    if( !lineTime )
+    {
+        m_tickCount = -1;
+        m_lineTime = 0;
+        return;
+    }
+
+    if( tickCount == m_tickCount )
+        m_repeatedFrames++;
+    else
+    {
+        if( m_tickCount >= 0 && tickCount > m_tickCount + 1 )
+            m_droppedTicks += tickCount - m_tickCount - 1;
+        m_tickAge.add( toMs(tickEnd - lineTime) );
+    }
+
+    m_tickCount = tickCount;
+    m_lineTime = lineTime;
+}
+
+void LatencyTracker::overlayDrawn( const std::string& name, long long updateStart, long long drawEnd, long long presentEnd )
+{
+    OverlayLatency& o = overlay( name );
+    o.drawMs.add( toMs(drawEnd - updateStart) );
+    o.presentMs.add( toMs(presentEnd - drawEnd) );
+    if( m_lineTime )
+        o.age.add( toMs(drawEnd - m_lineTime) );
+}
+
+void LatencyTracker::reset()
+{
+    *this = LatencyTracker();
+}
+
+LatencyTracker::OverlayLatency& LatencyTracker::overlay( const std::string& name )
+{
+    for( OverlayLatency& o : m_overlays )
+        if( o.name == name )
+            return o;
+
+    m_overlays.emplace_back();
+    m_overlays.back().name = name;
+    return m_overlays.back();
+}
+
+void LatencyTracker::dbgPrint() const
+{
+    dbg( "latency: tick age p50 %.1f p99 %.1f max %.1f ms, ir_tick p99 %.2f ms, frame p50 %.1f p99 %.1f ms",
+        m_tickAge.percentile(0.5), m_tickAge.percentile(0.99), m_tickAge.max(), m_tickMs.percentile(0.99), m_frameMs.percentile(0.5), m_frameMs.percentile(0.99) );
+    dbg( "latency: %lld frames, %lld without a new line, %lld ticks never drawn", m_frames, m_repeatedFrames, m_droppedTicks );
+
+    for( const OverlayLatency& o : m_overlays )
+    {
+        dbg( "latency: %-20s age p50 %.1f p99 %.1f max %.1f ms, draw p99 %.2f ms, present p99 %.2f ms",
+            o.name.c_str(), o.age.percentile(0.5), o.age.percentile(0.99), o.age.max(), o.drawMs.percentile(0.99), o.presentMs.percentile(0.99) );
+    }
+}
+
+static json histogramJson( const LatencyHistogram& h )
+{
+    json j;
+    j["count"] = h.count();
+    j["p50"] = h.percentile( 0.5 );
+    j["p90"] = h.percentile( 0.9 );
+    j["p99"] = h.percentile( 0.99 );
+    j["max"] = h.max();
+    return j;
+}
+
+std::string LatencyTracker::toJson() const
+{
+    json j;
+    j["frames"] = m_frames;
+    j["repeated_frames"] = m_repeatedFrames;
+    j["dropped_ticks"] = m_droppedTicks;
+    j["tick_age_ms"] = histogramJson( m_tickAge );
+    j["tick_ms"] = histogramJson( m_tickMs );
+    j["frame_ms"] = histogramJson( m_frameMs );
+
+    json overlays = json::object();
+    for( const OverlayLatency& o : m_overlays )
+    {
+        json& jo = overlays[o.name];
+        jo["age_ms"] = histogramJson( o.age );
+        jo["draw_ms"] = histogramJson( o.drawMs );
+        jo["present_ms"] = histogramJson( o.presentMs );
+    }
+    j["overlays"] = overlays;
+
+    return j.dump( 4 );
+}
+
+bool LatencyTracker::dump( const char* path ) const
+{
+    std::ofstream out( path );
+    if( !out )
+        return false;
+    out << toJson() << std::endl;
+    return true;
+}
@@ -0,0 +1,108 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Millisecond latencies in fixed 0.1 ms bins up to 250 ms, anything slower goes
+// into the last bin.  Cheap enough to feed every frame, and percentiles come
+// straight out of the bins.
+class LatencyHistogram
+{
+public:
+
+    void        add( double ms );
+    void        reset();
+
+    // p in [0,1], 0 if empty
+    double      percentile( double p ) const;
+    double      max() const { return m_max; }
+    long long   count() const { return m_count; }
+
+private:
+
+    static const int        NumBins = 2500;
+    std::vector<unsigned>   m_bins = std::vector<unsigned>( NumBins );
+    long long               m_count = 0;
+    double                  m_max = 0;
+};
+
+// How old the telemetry on screen is.
+//
+// Every line is stamped when irsdk_getNewData() first sees its tick count.  The main
+// loop reports the line it drew each frame, and Overlay::update() reports when it
+// started, when it finished drawing, and when Present() returned.  From that we keep:
+// - per overlay: line age just before Present, time spent drawing, time in Present
+// - line age when ir_tick() was done with it, ir_tick() time and whole frame time
+// - frames that drew no new line, and ticks the sim produced that we never drew
+class LatencyTracker
+{
+public:
+
+    static long long    now();
+    static double       toMs( long long qpcTicks );
+
+    // Once per main loop iteration, right after ir_tick(). tickCount/lineTime are
+    // those of the line this frame draws, lineTime 0 when there is none.
+    void        beginFrame( int tickCount, long long lineTime, long long tickStart, long long tickEnd );
+    void        overlayDrawn( const std::string& name, long long updateStart, long long drawEnd, long long presentEnd );
+
+    void        reset();
+
+    // Summary lines via dbg(), for OverlayDebug
+    void        dbgPrint() const;
+
+    // Everything as JSON, percentiles rather than raw bins
+    std::string toJson() const;
+    bool        dump( const char* path ) const;
+
+private:
+
+    struct OverlayLatency
+    {
+        std::string         name;
+        LatencyHistogram    age;        // line first seen -> just before Present
+        LatencyHistogram    drawMs;     // Overlay::update() up to Present
+        LatencyHistogram    presentMs;  // Present itself
+    };
+
+    OverlayLatency& overlay( const std::string& name );
+
+    int                         m_tickCount = -1;
+    long long                   m_lineTime = 0;
+    long long                   m_frameStart = 0;
+
+    long long                   m_frames = 0;
+    long long                   m_repeatedFrames = 0;
+    long long                   m_droppedTicks = 0;
+
+    LatencyHistogram            m_tickAge;
+    LatencyHistogram            m_tickMs;
+    LatencyHistogram            m_frameMs;
+    std::vector<OverlayLatency> m_overlays;
+};
+
+extern LatencyTracker g_latency;
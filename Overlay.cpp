@@ -28,6 +28,7 @@ SOFTWARE.
 #include "Overlay.h"
 #include "Config.h"
 #include "iracing.h"
+#include "Latency.h"
 
 using namespace Microsoft::WRL;
 
@@ -207,6 +208,17 @@ void Overlay::enable( bool on )
         // Default brush
         HRCHECK(m_renderTarget->CreateSolidColorBrush( float4(0,0,0,1), &m_brush ));
 
+        m_text.reset( m_dwriteFactory.Get() );
+        m_presenter.invalidate();
+
+        if( g_cfg.getBool( "General", "record_frames", false ) )
+        {
+            const std::string path = m_name + ".frames.txt";
+            m_recordFile = fopen( path.c_str(), "w" );
+            if( m_recordFile )
+                m_recorder.reset( new DisplayListRecorder( m_recordFile, m_name.c_str() ) );
+        }
+
         //
         // Finalize enable
         //
@@ -218,6 +230,12 @@ void Overlay::enable( bool on )
     {
         onDisable();
 
+        m_recorder.reset();
+        if( m_recordFile )
+            fclose( m_recordFile );
+        m_recordFile = nullptr;
+
+        m_text.reset();
         m_dwriteFactory.Reset();
         m_compositionVisual.Reset();
         m_compositionTarget.Reset();
@@ -269,6 +287,9 @@ void Overlay::configChanged()
     setWindowPosAndSize( x, y, w, h );
 
     onConfigChanged();
+
+    // Text formats and geometries got recreated, and may well live where the old ones did
+    m_presenter.invalidate();
 }
 
 void Overlay::sessionChanged()
@@ -291,25 +312,25 @@ void Overlay::update()
     if( !m_enabled )
         return;
 
+    const long long updateStart = LatencyTracker::now();
+
     const float w = (float)m_width;
     const float h = (float)m_height;
     const float cornerRadius = g_cfg.getFloat( m_name, "corner_radius", m_name=="OverlayInputs"?2.0f:6.0f );
 
-    // Clear/draw background
+    // Background
+    m_dl.clear();
     if( !hasCustomBackground() )
     {
-        m_renderTarget->BeginDraw();
-        m_renderTarget->Clear( float4(0,0,0,0) );
         D2D1_ROUNDED_RECT rr = {};
         rr.rect = { 0.5f, 0.5f, w-0.5f, h-0.5f };
         rr.radiusX = cornerRadius;
         rr.radiusY = cornerRadius;
-        m_brush->SetColor( g_cfg.getFloat4( m_name, "background_col", float4(0,0,0,0.7f) ) );
-        m_renderTarget->FillRoundedRectangle( &rr, m_brush.Get() );
-        m_renderTarget->EndDraw();
+        m_dl.setColor( g_cfg.getFloat4( m_name, "background_col", float4(0,0,0,0.7f) ) );
+        m_dl.fillRoundedRect( rr );
     }
 
-	const int  carIdx = ir_session.driverCarIdx;
+	const int  carIdx = ir_session->driverCarIdx;
 	const int  currentLap = ir_isPreStart() ? 0 : std::max(0, ir_CarIdxLap.getInt(carIdx));
 	const bool lapCountUpdated = currentLap != mPrevLap;
 
@@ -333,19 +354,30 @@ void Overlay::update()
     if( m_uiEditEnabled )
     {
         // Draw highlight frame and resize corner indicators
-        m_renderTarget->BeginDraw();
         D2D1_ROUNDED_RECT rr = {};
         rr.rect = { 0.5f, 0.5f, w-0.5f, h-0.5f };
         rr.radiusX = cornerRadius;
         rr.radiusY = cornerRadius;
-        m_brush->SetColor( float4(1,1,1,0.7f) );
-        m_renderTarget->DrawRoundedRectangle( &rr, m_brush.Get(), 2 );
-        m_renderTarget->DrawLine( float2(w-0.5f,h-0.5f-ResizeBorderWidth), float2(w-0.5f-ResizeBorderWidth,h-0.5f-ResizeBorderWidth), m_brush.Get(), 2 );
-        m_renderTarget->DrawLine( float2(w-0.5f-ResizeBorderWidth,h-0.5f), float2(w-0.5f-ResizeBorderWidth,h-0.5f-ResizeBorderWidth), m_brush.Get(), 2 );
-        m_renderTarget->EndDraw();
+        m_dl.setColor( float4(1,1,1,0.7f) );
+        m_dl.drawRoundedRect( rr, 2 );
+        m_dl.drawLine( float2(w-0.5f,h-0.5f-ResizeBorderWidth), float2(w-0.5f-ResizeBorderWidth,h-0.5f-ResizeBorderWidth), 2 );
+        m_dl.drawLine( float2(w-0.5f-ResizeBorderWidth,h-0.5f), float2(w-0.5f-ResizeBorderWidth,h-0.5f-ResizeBorderWidth), 2 );
+    }
+
+    // Draw and present, unless the frame looks exactly like the one on screen
+    m_backend.setTarget( m_renderTarget.Get(), m_brush.Get(), &m_text );
+    if( !m_presenter.present( m_dl, m_backend ) )
+    {
+        if( m_recorder )
+            m_recorder->skip();
+        return;
     }
+    if( m_recorder )
+        m_recorder->draw( m_presenter.getLast() );
 
+    const long long drawEnd = LatencyTracker::now();
     HRCHECK(m_swapChain->Present( 1, 0 ));
+    g_latency.overlayDrawn( m_name, updateStart, drawEnd, LatencyTracker::now() );
 }
 
 void Overlay::setWindowPosAndSize( int x, int y, int w, int h, bool callSetWindowPos )
@@ -373,6 +405,9 @@ void Overlay::setWindowPosAndSize( int x, int y, int w, int h, bool callSetWindo
     targetProperties.pixelFormat.format = DXGI_FORMAT_UNKNOWN;
     targetProperties.pixelFormat.alphaMode = D2D1_ALPHA_MODE_PREMULTIPLIED;
     HRCHECK(m_d2dFactory->CreateDxgiSurfaceRenderTarget( dxgiSurface.Get(), &targetProperties, &m_renderTarget ));
+
+    // New back buffers, nothing of the last frame in them
+    m_presenter.invalidate();
 }
 
 void Overlay::saveWindowPosAndSize()
@@ -385,6 +420,17 @@ void Overlay::saveWindowPosAndSize()
     g_cfg.save();
 }
 
+const DisplayListPresenter::Stats& Overlay::getDisplayStats() const
+{
+    return m_presenter.getStats();
+}
+
+void Overlay::defineGeometry( const void* geometry, const std::vector<float>& segments )
+{
+    if( m_recorder )
+        m_recorder->defineGeometry( geometry, segments );
+}
+
 bool Overlay::canEnableWhileNotDriving() const
 {
     return false;
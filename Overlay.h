@@ -26,6 +26,8 @@ SOFTWARE.
 
 #include <windows.h>
 #include <string>
+#include <memory>
+#include <vector>
 #include <dxgi1_6.h>
 #include <d3d11_4.h>
 #include <d2d1_3.h>
@@ -33,6 +35,8 @@ SOFTWARE.
 #include <dwrite.h>
 #include <wrl.h>
 #include "util.h"
+#include "DisplayList.h"
+#include "DisplayListD2D.h"
 
 class Overlay
 {
@@ -62,6 +66,8 @@ class Overlay
         void            setWindowPosAndSize( int x, int y, int w, int h, bool callSetWindowPos=true );
         void            saveWindowPosAndSize();
 
+        const DisplayListPresenter::Stats& getDisplayStats() const;
+
     protected:
 
         virtual void    onEnable();
@@ -75,6 +81,9 @@ class Overlay
         virtual float2  getDefaultSize();
         virtual bool    hasCustomBackground();
 
+        // Outline of a geometry handed to m_dl.drawGeometry(), for the frame recording
+        void            defineGeometry( const void* geometry, const std::vector<float>& segments );
+
         std::string     m_name;
         HWND            m_hwnd = 0;
         bool            m_enabled = false;
@@ -95,4 +104,15 @@ class Overlay
         Microsoft::WRL::ComPtr<IDCompositionVisual>     m_compositionVisual;
         Microsoft::WRL::ComPtr<IDWriteFactory>          m_dwriteFactory;
         Microsoft::WRL::ComPtr<ID2D1SolidColorBrush>    m_brush;
+
+        // onUpdate() records into m_dl, which is only replayed onto the render target if it changed
+        DisplayList             m_dl;
+        DisplayListPresenter    m_presenter;
+        D2DDisplayBackend       m_backend;
+        TextCache               m_text;
+
+        // With General/record_frames on, every frame that gets drawn is also dumped as text to
+        // <name>.frames.txt, which "irtool rasterbench" can replay without iRacing or Direct2D
+        FILE*                                   m_recordFile = nullptr;
+        std::unique_ptr<DisplayListRecorder>    m_recorder;
 };
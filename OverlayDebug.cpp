@@ -89,6 +89,7 @@ void OverlayDebug::onEnable()
 
 void OverlayDebug::onConfigChanged()
 {
+    m_text.reset( m_dwriteFactory.Get() );
     HRCHECK(m_dwriteFactory->CreateTextFormat( L"Consolas", NULL, DWRITE_FONT_WEIGHT_NORMAL, DWRITE_FONT_STYLE_NORMAL, DWRITE_FONT_STRETCH_NORMAL, 15, L"en-us", &m_textFormat ));
     m_textFormat->SetParagraphAlignment( DWRITE_PARAGRAPH_ALIGNMENT_CENTER );
     m_textFormat->SetWordWrapping( DWRITE_WORD_WRAPPING_NO_WRAP );
@@ -98,22 +99,16 @@ void OverlayDebug::onUpdate()
 {
     const float lineHeight = 20;
 
-    m_renderTarget->BeginDraw();
-
     for( int i=0; i<(int)g_dbgLines.size(); ++i )
     {
         const DbgLine& line = g_dbgLines[i];
 
         const float y = 10 + lineHeight/2 + i*lineHeight;
         
-        m_brush->SetColor( line.col );
-        D2D1_RECT_F r = { 10, y-lineHeight/2, (float)m_width-10, y+lineHeight/2 };
-        auto wstr = toWide( line.s );
-        m_renderTarget->DrawTextA( wstr.c_str(), (int)wstr.size(), m_textFormat.Get(), &r, m_brush.Get(), D2D1_DRAW_TEXT_OPTIONS_CLIP );
+        m_dl.setColor( line.col );
+        m_dl.text( toWide( line.s ).c_str(), m_textFormat.Get(), 10, (float)m_width-10, y, DWRITE_TEXT_ALIGNMENT_LEADING );
     }
 
-    m_renderTarget->EndDraw();
-
     g_dbgLines.clear();
 }
 
@@ -27,14 +27,14 @@ SOFTWARE.
 #include <vector>
 #include <algorithm>
 #include <deque>
-#include <sstream>
-#include <iomanip>
 #include <time.h>
 #include "Overlay.h"
 #include "iracing.h"
 #include "Config.h"
 #include "OverlayDebug.h"
 #include "ui_utils.h"
+#include "FuelEstimator.h"
+#include "ValueFormat.h"
 
 
 class OverlayHUD : public Overlay
@@ -64,7 +64,7 @@ protected:
 
     virtual void onDisable()
     {
-        mText.reset();
+        m_text.reset();
     }
 
     virtual void onConfigChanged()
@@ -79,10 +79,11 @@ protected:
         mNumLapsToAvg = g_cfg.getInt(m_name, "fuel_estimate_avg_green_laps", 5);
         mAdditionalFuel = g_cfg.getFloat(m_name, "fuel_additional_fuel", 0.0f);
         mAutoRefuel = g_cfg.getBool(m_name, "fuel_auto_refuel", false);
+        mFuel.configure(mAllLapsCount, mNumLapsToAvg);
 
         // Font stuff
         {
-            mText.reset(m_dwriteFactory.Get());
+            m_text.reset(m_dwriteFactory.Get());
 
             const std::string font = g_cfg.getString(m_name, "font", "Arial");
             const float fontSize = g_cfg.getFloat(m_name, "font_size", DefaultFontSize);
@@ -136,6 +137,7 @@ protected:
             Microsoft::WRL::ComPtr<ID2D1GeometrySink>  geometrySink;
             m_d2dFactory->CreatePathGeometry(&m_boxPathGeometry);
             m_boxPathGeometry->Open(&geometrySink);
+            std::vector<float> segments;
 
             const float hgap = 0.02f;
             const float vgap = 0.05f;
@@ -154,33 +156,34 @@ protected:
             getDimensions(0, 1, 3, vdivs, 0, vgap, h, yoffset);
             makeBox(xoffset, w, yoffset, h, m_width, m_height, "Fuel", m_boxFuel);
             //m_boxFuel = makeBox(xoffset, w, yoffset, h, m_width, m_height, "Fuel");
-            addBoxFigure(mText, mTextFormat, geometrySink.Get(), m_boxFuel);
+            addBoxFigure(m_text, mTextFormat, geometrySink.Get(), m_boxFuel, &segments);
 
             getDimensions(1, cols, 2, hdivs, 4, hgap, w, xoffset);
             getDimensions(0, 2, 1, vdivs, 0, vgap, h, yoffset);
             makeBox(xoffset, w, yoffset, h, m_width, m_height, "Session", m_boxSession);
-            addBoxFigure(mText, mTextFormat, geometrySink.Get(), m_boxSession);
+            addBoxFigure(m_text, mTextFormat, geometrySink.Get(), m_boxSession, &segments);
 
 
             getDimensions(1, 2, 2, vdivs, 1, vgap, h, yoffset);
             makeBox(xoffset, w, yoffset, h, m_width, m_height, "Lap", m_boxLaps);
-            addBoxFigure(mText, mTextFormat, geometrySink.Get(), m_boxLaps);
+            addBoxFigure(m_text, mTextFormat, geometrySink.Get(), m_boxLaps, &segments);
 
 
             getDimensions(2, cols, 2, hdivs, 6, hgap, h, xoffset);
             getDimensions(0, 3, 1, vdivs, 0, vgap, h, yoffset);
             makeBox(xoffset, w, yoffset, h, m_width, m_height, "TOD", m_boxTime);
-            addBoxFigure(mText, mTextFormat, geometrySink.Get(), m_boxTime);
+            addBoxFigure(m_text, mTextFormat, geometrySink.Get(), m_boxTime, &segments);
 
             getDimensions(1, 3, 1, vdivs, 1, vgap, h, yoffset);
             makeBox(xoffset, w, yoffset, h, m_width, m_height, "INCS", m_boxIncs);
-            addBoxFigure(mText, mTextFormat, geometrySink.Get(), m_boxIncs);
+            addBoxFigure(m_text, mTextFormat, geometrySink.Get(), m_boxIncs, &segments);
 
             getDimensions(2, 3, 1, vdivs, 2, vgap, h, yoffset);
             makeBox(xoffset, w, yoffset, h, m_width, m_height, "TTemp", m_boxTrackTemp);
-            addBoxFigure(mText, mTextFormat, geometrySink.Get(), m_boxTrackTemp);
+            addBoxFigure(m_text, mTextFormat, geometrySink.Get(), m_boxTrackTemp, &segments);
 
             geometrySink->Close();
+            defineGeometry(m_boxPathGeometry.Get(), segments);
         }
     }
 
@@ -192,14 +195,8 @@ protected:
     virtual void resetFuel()
     {
         mAdd = 0; // reset refuel amount
-        mIsFuelLapValid = false;  // avoid confusing the fuel calculator logic with session changes
-        mRemainingAtLapStart = ir_FuelLevel.getFloat(); // reset the start of lap value
-        mFuelLapsUsed.clear(); // session has changed, clear the lap history
+        mFuel.reset(ir_FuelLevel.getFloat()); // session has changed, clear the lap history
         mFuelSet = true; // wont be reset until out on track, prevents filling
-
-        m_renderTarget->BeginDraw();
-        setAddFuel();
-        m_renderTarget->EndDraw();
     }
 
     virtual void setAddFuel()
@@ -210,9 +207,9 @@ protected:
         if (isImperial())
             add *= 0.264172f;
 
-        wchar_t s[256] = { 0 };
-        swprintf(s, _countof(s), isImperial() ? L"%3.1f gl" : L"%3.1f lt", add);
-        mText.render(m_renderTarget.Get(), s, mTextFormatMed.Get(), m_boxFuel.x0, m_boxFuel.x1 - xoff, m_boxFuel.y0 + m_boxFuel.h * .65f, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_TRAILING);
+        FormatBuffer s;
+        appendFuel(s, add, isImperial());
+        m_dl.text(s.c_str(), mTextFormatMed.Get(), m_boxFuel.x0, m_boxFuel.x1 - xoff, m_boxFuel.y0 + m_boxFuel.h * .65f, DWRITE_TEXT_ALIGNMENT_TRAILING);
     }
 
     virtual bool isImperial()
@@ -243,36 +240,25 @@ protected:
 
     virtual void setTrackTemp()
     {
-        // setTrackTemp;
-        std::wstringstream tempwss;
-        tempwss.precision(3);
-        tempwss << ir_TrackTemp.getFloat();
-
-        if (isImperial())
-            tempwss << "F";
-        else
-            tempwss << "C";
-
-        mText.render(m_renderTarget.Get(), tempwss.str().c_str(), mTextFormat.Get(), m_boxTrackTemp.x0, m_boxTrackTemp.x1, m_boxTrackTemp.y0 + m_boxTrackTemp.h * 0.5f, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER);
+        FormatBuffer s;
+        appendTemperature(s, ir_TrackTemp.getFloat(), isImperial());
+        m_dl.text(s.c_str(), mTextFormat.Get(), m_boxTrackTemp.x0, m_boxTrackTemp.x1, m_boxTrackTemp.y0 + m_boxTrackTemp.h * 0.5f, DWRITE_TEXT_ALIGNMENT_CENTER);
     }
 
     virtual void setTimeOfDay()
     {
         time_t     now = time(0);
         struct tm  tstruct;
-        char       timeStr[9];
         tstruct = *localtime(&now);
 
-        strftime(timeStr, sizeof(timeStr), "%H:%M", &tstruct);
-        std::wstringstream twss;
-        twss << timeStr;
-        
-        mText.render(m_renderTarget.Get(), twss.str().c_str(), mTextFormat.Get(), m_boxTime.x0, m_boxTime.x1, m_boxTime.y0 + m_boxTime.h * 0.5f, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER);
+        FormatBuffer s;
+        appendClock(s, tstruct.tm_hour, tstruct.tm_min);
+        m_dl.text(s.c_str(), mTextFormat.Get(), m_boxTime.x0, m_boxTime.x1, m_boxTime.y0 + m_boxTime.h * 0.5f, DWRITE_TEXT_ALIGNMENT_CENTER);
     }
 
     virtual int getCarIdx()
     {
-        return ir_session.driverCarIdx;
+        return ir_session->driverCarIdx;
     }
 
     virtual float getRaceProgress()
@@ -301,136 +287,113 @@ protected:
 
     virtual void setLaps()
     {
-        wchar_t lapstr[100];
-        wchar_t laps[100];
+        FormatBuffer lapstr;
+        FormatBuffer laps;
         const double remainingLaps = getRemainingLaps();
         //const double remainingLaps = getEstimatedTotalLaps() - getRaceProgress();
         //int lapsStarted = getLapsStarted();
 
 
-        if (ir_session.sessionType == SessionType::UNKNOWN || remainingLaps < 0)
+        if (ir_session->sessionType == SessionType::UNKNOWN || remainingLaps < 0)
         {
-            swprintf(laps, _countof(laps), L"-- / --");
-            swprintf(lapstr, _countof(lapstr), L"--");
+            laps.chars(L"-- / --");
+            lapstr.chars(L"--");
         }
         else if (isTimeLimited())
         {
-            swprintf(lapstr, _countof(lapstr), L"~%.01f", remainingLaps);
-            swprintf(laps, _countof(laps), L"%.01f / ~%.0f", getRaceProgress(), getEstimatedTotalLaps());
+            lapstr.ch(L'~').fixed(remainingLaps, 1);
+            laps.fixed(getRaceProgress(), 1).chars(L" / ~").fixed(getEstimatedTotalLaps(), 0);
         }
         else
-            swprintf(lapstr, _countof(lapstr), L"%d", (int)remainingLaps);
+            lapstr.integer((int)remainingLaps);
 
         
-        mText.render(m_renderTarget.Get(), lapstr, mTextFormatLarge.Get(), m_boxLaps.x0, m_boxLaps.x1, m_boxLaps.y0 + m_boxLaps.h * 0.40f, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER);
-        mText.render(m_renderTarget.Get(), laps, mTextFormatVerySmall.Get(), m_boxLaps.x0, m_boxLaps.x1, m_boxLaps.y0 + m_boxLaps.h * 0.75f, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER);
+        m_dl.text(lapstr.c_str(), mTextFormatLarge.Get(), m_boxLaps.x0, m_boxLaps.x1, m_boxLaps.y0 + m_boxLaps.h * 0.40f, DWRITE_TEXT_ALIGNMENT_CENTER);
+        m_dl.text(laps.c_str(), mTextFormatVerySmall.Get(), m_boxLaps.x0, m_boxLaps.x1, m_boxLaps.y0 + m_boxLaps.h * 0.75f, DWRITE_TEXT_ALIGNMENT_CENTER);
     }
 
     virtual void setSessionTime()
     {
-        std::wstringstream ss;
+        FormatBuffer s;
         const double remainingSessionTime = getRemainingSessionTime();
 
         // TODO Quali is Time Limited & Lap Limited
-        if (!isTimeLimited() || ir_session.sessionType == SessionType::UNKNOWN)
-            ss << "n/a";
+        if (!isTimeLimited() || ir_session->sessionType == SessionType::UNKNOWN)
+            s.chars(L"n/a");
         else
         {
             const double sessionTime = remainingSessionTime >= 0 ? remainingSessionTime : ir_SessionTime.getDouble();
-
-            const int    hours = int(sessionTime / 3600.0);
-            const int    mins = int(sessionTime / 60.0) % 60;
-            const int    secs = (int)fmod(sessionTime, 60.0);
-
-            if (hours)
-                ss << hours << ":";
-
-            ss << std::setfill(L'0') << std::setw(2) << mins << ":";
-            ss << std::setfill(L'0') << std::setw(2) << secs;
+            appendDuration(s, sessionTime);
         }
 
-        mText.render(m_renderTarget.Get(), ss.str().c_str(), mTextFormatSmall.Get(), m_boxSession.x0, m_boxSession.x1, m_boxSession.y0 + m_boxSession.h * 0.55f, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER);
+        m_dl.text(s.c_str(), mTextFormatSmall.Get(), m_boxSession.x0, m_boxSession.x1, m_boxSession.y0 + m_boxSession.h * 0.55f, DWRITE_TEXT_ALIGNMENT_CENTER);
     }
 
     virtual void setIncs()
     {
-        std::wstringstream wss;
-        wss << ir_PlayerCarMyIncidentCount.getInt() << "x";
-        mText.render(m_renderTarget.Get(), wss.str().c_str(), mTextFormat.Get(), m_boxIncs.x0, m_boxIncs.x1, m_boxIncs.y0 + m_boxIncs.h * 0.5f, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER);
+        FormatBuffer s;
+        s.integer(ir_PlayerCarMyIncidentCount.getInt()).ch(L'x');
+        m_dl.text(s.c_str(), mTextFormat.Get(), m_boxIncs.x0, m_boxIncs.x1, m_boxIncs.y0 + m_boxIncs.h * 0.5f, DWRITE_TEXT_ALIGNMENT_CENTER);
     }
 
     virtual void setFuel()
     {
         const float xoff = 7;
 
-        const float fuelMax = ir_session.fuelMaxLtr;
-        float sumFuel = 0;
-        float avgPerLap = 0;
+        const float fuelMax = ir_session->fuelMaxLtr;
+        const float avgPerLap = mFuel.avgPerLap();
         const float remainingFuel = ir_FuelLevel.getFloat();
         //const float remainingLaps = (float)getRemainingLaps();
         const float remainingLaps = (float)getEstimatedTotalLaps() - getRaceProgress();
 
-        m_brush->SetColor(mTextCol);
-        mText.render(m_renderTarget.Get(), L"Rem:", mTextFormatMed.Get(), m_boxFuel.x0 + xoff, m_boxFuel.x1, m_boxFuel.y0 + m_boxFuel.h * 0.15f, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_LEADING);
-        mText.render(m_renderTarget.Get(), L"Avg:", mTextFormatMed.Get(), m_boxFuel.x0 + xoff, m_boxFuel.x1, m_boxFuel.y0 + m_boxFuel.h * 0.4f, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_LEADING);
-        mText.render(m_renderTarget.Get(), L"Add:", mTextFormatMed.Get(), m_boxFuel.x0 + xoff, m_boxFuel.x1, m_boxFuel.y0 + m_boxFuel.h * 0.65f, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_LEADING);
-        mText.render(m_renderTarget.Get(), L"Fin:", mTextFormatMed.Get(), m_boxFuel.x0 + xoff, m_boxFuel.x1, m_boxFuel.y0 + m_boxFuel.h * 0.9f, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_LEADING);
-
-        wchar_t s[512];
+        m_dl.setColor(mTextCol);
+        m_dl.text(L"Rem:", mTextFormatMed.Get(), m_boxFuel.x0 + xoff, m_boxFuel.x1, m_boxFuel.y0 + m_boxFuel.h * 0.15f, DWRITE_TEXT_ALIGNMENT_LEADING);
+        m_dl.text(L"Avg:", mTextFormatMed.Get(), m_boxFuel.x0 + xoff, m_boxFuel.x1, m_boxFuel.y0 + m_boxFuel.h * 0.4f, DWRITE_TEXT_ALIGNMENT_LEADING);
+        m_dl.text(L"Add:", mTextFormatMed.Get(), m_boxFuel.x0 + xoff, m_boxFuel.x1, m_boxFuel.y0 + m_boxFuel.h * 0.65f, DWRITE_TEXT_ALIGNMENT_LEADING);
+        m_dl.text(L"Fin:", mTextFormatMed.Get(), m_boxFuel.x0 + xoff, m_boxFuel.x1, m_boxFuel.y0 + m_boxFuel.h * 0.9f, DWRITE_TEXT_ALIGNMENT_LEADING);
 
-        for (float v : mFuelLapsUsed)
-            sumFuel += v;
-
-        if (!mFuelLapsUsed.empty())
-            avgPerLap = sumFuel / (float)mFuelLapsUsed.size();
+        FormatBuffer s;
 
         // Remaining
-        swprintf(s, _countof(s), isImperial() ? L"%3.1f gl" : L"%3.1f lt", remainingFuel);
-        mText.render(m_renderTarget.Get(), s, mTextFormatMed.Get(), m_boxFuel.x0, m_boxFuel.x1 - xoff, m_boxFuel.y0 + m_boxFuel.h * 0.15f, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_TRAILING);
+        appendFuel(s, remainingFuel, isImperial());
+        m_dl.text(s.c_str(), mTextFormatMed.Get(), m_boxFuel.x0, m_boxFuel.x1 - xoff, m_boxFuel.y0 + m_boxFuel.h * 0.15f, DWRITE_TEXT_ALIGNMENT_TRAILING);
 
         // Per Lap
         if (avgPerLap > 0)
         {
             float avgVal = avgPerLap;
-            float usedVal = mUsed;
+            float usedVal = mFuel.lastLapUsed();
             if (isImperial())
             {
                 avgVal *= 0.264172f;
                 usedVal *= 0.264172f;
             }
 
-            swprintf(s, _countof(s), isImperial() ? L"%5.2f [%5.2f] gl" : L"%5.2f [%5.2f] lt", avgVal, usedVal);
-            mText.render(m_renderTarget.Get(), s, mTextFormatMed.Get(), m_boxFuel.x0, m_boxFuel.x1 - xoff, m_boxFuel.y0 + m_boxFuel.h * .4f, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_TRAILING);
+            s.clear().fixed(avgVal, 2, 5).chars(L" [").fixed(usedVal, 2, 5).chars(isImperial() ? L"] gl" : L"] lt");
+            m_dl.text(s.c_str(), mTextFormatMed.Get(), m_boxFuel.x0, m_boxFuel.x1 - xoff, m_boxFuel.y0 + m_boxFuel.h * .4f, DWRITE_TEXT_ALIGNMENT_TRAILING);
         }
 
         // To Finish
         if (remainingLaps >= 0 && avgPerLap > 0)
         {
-            float atFinish = std::max(0.0f, remainingFuel - remainingLaps * avgPerLap);
-            mAdd = 0;
-
-            if (atFinish <= 0)
-            {
-                mAdd = (remainingLaps * avgPerLap) - remainingFuel;
-                if (mAdditionalFuel > 0)
-                    mAdd += avgPerLap * mAdditionalFuel;
-            }
+            float atFinish = mFuel.atFinish(remainingFuel, remainingLaps);
+            mAdd = mFuel.toAdd(remainingFuel, remainingLaps, mAdditionalFuel);
 
             if (isImperial())
                 atFinish *= 0.264172f;
 
-            swprintf(s, _countof(s), isImperial() ? L"%3.1f gl" : L"%3.1f lt", atFinish);
+            appendFuel(s.clear(), atFinish, isImperial());
 
-            m_brush->SetColor(atFinish <= 0.0f ? mWarnCol : mGoodCol);
-            mText.render(m_renderTarget.Get(), s, mTextFormatMed.Get(), m_boxFuel.x0, m_boxFuel.x1 - xoff, m_boxFuel.y0 + m_boxFuel.h * .9f, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_TRAILING);
-            m_brush->SetColor(mTextCol);
+            m_dl.setColor(atFinish <= 0.0f ? mWarnCol : mGoodCol);
+            m_dl.text(s.c_str(), mTextFormatMed.Get(), m_boxFuel.x0, m_boxFuel.x1 - xoff, m_boxFuel.y0 + m_boxFuel.h * .9f, DWRITE_TEXT_ALIGNMENT_TRAILING);
+            m_dl.setColor(mTextCol);
 
             // Add
             if (mAdd >= 0)
             {
                 mAdd = std::min(mAdd, fuelMax);
                 setAddFuel();
-                m_brush->SetColor(mTextCol);
+                m_dl.setColor(mTextCol);
             }
         }
     }
@@ -445,7 +408,7 @@ protected:
         printf("onEnteredPitRoad()");
         if (mAutoRefuel)
         {
-            if (!mFuelSet && mAdd > 0 && ir_session.sessionType != SessionType::QUALIFY)
+            if (!mFuelSet && mAdd > 0 && ir_session->sessionType != SessionType::QUALIFY)
             {
                 irsdk_broadcastMsg(irsdk_BroadcastPitCommand, irsdk_PitCommand_Fuel, (int)round(mAdd));
                 irsdk_broadcastMsg(irsdk_BroadcastPitCommand, irsdk_PitCommand_Fuel, 0);
@@ -463,36 +426,14 @@ protected:
     virtual void onLapChanged()
     {
         printf("onLapChanged()\n");
-        const int  carIdx = ir_session.driverCarIdx;
-
-        float remainingFuel = ir_FuelLevel.getFloat();
-
-        mUsed = std::max(0.0f, mRemainingAtLapStart - remainingFuel);
-        mRemainingAtLapStart = remainingFuel;
+        const int  carIdx = ir_session->driverCarIdx;
 
-        if (mIsFuelLapValid)
-            mFuelLapsUsed.push_back(mUsed);
-
-        while (mFuelLapsUsed.size() >= mNumLapsToAvg)
-            mFuelLapsUsed.pop_front();
-
-        if (mAllLapsCount)
-        {
-            mIsFuelLapValid = true;
-        }
-        else
-        {
-            if ((ir_SessionFlags.getInt() & (irsdk_yellow | irsdk_yellowWaving | irsdk_red | irsdk_checkered | irsdk_crossed | irsdk_oneLapToGreen | irsdk_caution | irsdk_cautionWaving | irsdk_disqualify | irsdk_repair)) || ir_CarIdxOnPitRoad.getBool(carIdx))
-                mIsFuelLapValid = false;
-            else
-                mIsFuelLapValid = true;
-        }
+        mFuel.onLapChanged(ir_FuelLevel.getFloat(), ir_SessionFlags.getInt(), ir_CarIdxOnPitRoad.getBool(carIdx));
     }
 
     virtual void onUpdate()
     {
-        m_renderTarget->BeginDraw();
-        m_brush->SetColor(mTextCol);
+        m_dl.setColor(mTextCol);
 
         setTrackTemp();
         setTimeOfDay();
@@ -501,30 +442,28 @@ protected:
         setIncs();
         setFuel();
 
-        m_brush->SetColor(mOutlineCol);
-        m_renderTarget->DrawGeometry(m_boxPathGeometry.Get(), m_brush.Get());
+        m_dl.setColor(mOutlineCol);
+        m_dl.drawGeometry(m_boxPathGeometry.Get());
 
-        mText.render(m_renderTarget.Get(), L"Lap", mTextFormatSmall.Get(), m_boxLaps.x0, m_boxLaps.x1, m_boxLaps.y0, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER);
+        m_dl.text(L"Lap", mTextFormatSmall.Get(), m_boxLaps.x0, m_boxLaps.x1, m_boxLaps.y0, DWRITE_TEXT_ALIGNMENT_CENTER);
 
         if (ir_PitsOpen.getBool())
         {
-            m_brush->SetColor(mGoodCol);
-            mText.render(m_renderTarget.Get(), L"Open", mTextFormatSmall.Get(), m_boxFuel.x0, m_boxFuel.x1, m_boxFuel.y0, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER);
+            m_dl.setColor(mGoodCol);
+            m_dl.text(L"Open", mTextFormatSmall.Get(), m_boxFuel.x0, m_boxFuel.x1, m_boxFuel.y0, DWRITE_TEXT_ALIGNMENT_CENTER);
         }
         else
         {
-            m_brush->SetColor(mBadCol);
-            mText.render(m_renderTarget.Get(), L"Closed", mTextFormatSmall.Get(), m_boxFuel.x0, m_boxFuel.x1, m_boxFuel.y0, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER);
+            m_dl.setColor(mBadCol);
+            m_dl.text(L"Closed", mTextFormatSmall.Get(), m_boxFuel.x0, m_boxFuel.x1, m_boxFuel.y0, DWRITE_TEXT_ALIGNMENT_CENTER);
         }
 
-        m_brush->SetColor(mOutlineCol);
-
-        mText.render(m_renderTarget.Get(), L"Session", mTextFormatSmall.Get(), m_boxSession.x0, m_boxSession.x1, m_boxSession.y0, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER);
-        mText.render(m_renderTarget.Get(), L"Time", mTextFormatSmall.Get(), m_boxTime.x0, m_boxTime.x1, m_boxTime.y0, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER);
-        mText.render(m_renderTarget.Get(), L"Incs", mTextFormatSmall.Get(), m_boxIncs.x0, m_boxIncs.x1, m_boxIncs.y0, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER);
-        mText.render(m_renderTarget.Get(), L"TTemp", mTextFormatSmall.Get(), m_boxTrackTemp.x0, m_boxTrackTemp.x1, m_boxTrackTemp.y0, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER);
+        m_dl.setColor(mOutlineCol);
 
-        m_renderTarget->EndDraw();
+        m_dl.text(L"Session", mTextFormatSmall.Get(), m_boxSession.x0, m_boxSession.x1, m_boxSession.y0, DWRITE_TEXT_ALIGNMENT_CENTER);
+        m_dl.text(L"Time", mTextFormatSmall.Get(), m_boxTime.x0, m_boxTime.x1, m_boxTime.y0, DWRITE_TEXT_ALIGNMENT_CENTER);
+        m_dl.text(L"Incs", mTextFormatSmall.Get(), m_boxIncs.x0, m_boxIncs.x1, m_boxIncs.y0, DWRITE_TEXT_ALIGNMENT_CENTER);
+        m_dl.text(L"TTemp", mTextFormatSmall.Get(), m_boxTrackTemp.x0, m_boxTrackTemp.x1, m_boxTrackTemp.y0, DWRITE_TEXT_ALIGNMENT_CENTER);
     }
 
 protected:
@@ -552,13 +491,8 @@ protected:
     Microsoft::WRL::ComPtr<ID2D1PathGeometry1> m_boxPathGeometry;
     Microsoft::WRL::ComPtr<ID2D1PathGeometry1> m_backgroundPathGeometry;
 
-    TextCache           mText;
-
-    float               mRemainingAtLapStart = 0;
-    std::deque<float>   mFuelLapsUsed;
-    bool                mIsFuelLapValid = false;
+    FuelEstimator       mFuel;
     float               mAdd = 0;
-    float               mUsed = 0;
     bool                mFuelSet = true;
 
     float4              mTextCol;
@@ -3,14 +3,13 @@
 #include <vector>
 #include <algorithm>
 #include <deque>
-#include <sstream>
-#include <iomanip>
 #include <time.h>
 #include "Overlay.h"
 #include "iracing.h"
 #include "Config.h"
 #include "OverlayDebug.h"
 #include "ui_utils.h"
+#include "ValueFormat.h"
 
 
 class OverlayInputTesting : public Overlay
@@ -40,14 +39,14 @@ protected:
 
     virtual void onDisable()
     {
-        mText.reset();
+        m_text.reset();
     }
 
     virtual void onConfigChanged()
     {
         // Font stuff
         {
-            mText.reset(m_dwriteFactory.Get());
+            m_text.reset(m_dwriteFactory.Get());
 
             const std::string font = g_cfg.getString(m_name, "font", "Arial");
             const float fontSize = g_cfg.getFloat(m_name, "font_size", DefaultFontSize);
@@ -93,6 +92,7 @@ protected:
             Microsoft::WRL::ComPtr<ID2D1GeometrySink>  geometrySink;
             m_d2dFactory->CreatePathGeometry(&m_boxPathGeometry);
             m_boxPathGeometry->Open(&geometrySink);
+            std::vector<float> segments;
 
             const float hgap = 0.02f;
             const float vgap = 0.05f;
@@ -110,73 +110,71 @@ protected:
             getDimensions(0, cols, 1, hdivs, 0, hgap, w, xoffset);
             getDimensions(0, vdivs, 1, vdivs, 0, vgap, h, yoffset);
             makeBox(xoffset, w, yoffset, h, m_width, m_height, "Clutch", m_boxClutch);
-            addBoxFigure(mText, mTextFormat, geometrySink.Get(), m_boxClutch);
+            addBoxFigure(m_text, mTextFormat, geometrySink.Get(), m_boxClutch, &segments);
 
             getDimensions(1, cols, 1, hdivs, 1, hgap, w, xoffset);
             makeBox(xoffset, w, yoffset, h, m_width, m_height, "Brake", m_boxBrake);
-            addBoxFigure(mText, mTextFormat, geometrySink.Get(), m_boxBrake);
+            addBoxFigure(m_text, mTextFormat, geometrySink.Get(), m_boxBrake, &segments);
 
             getDimensions(2, cols, 1, hdivs, 2, hgap, w, xoffset);
             makeBox(xoffset, w, yoffset, h, m_width, m_height, "Throttle", m_boxThrottle);
-            addBoxFigure(mText, mTextFormat, geometrySink.Get(), m_boxThrottle);
+            addBoxFigure(m_text, mTextFormat, geometrySink.Get(), m_boxThrottle, &segments);
 
             geometrySink->Close();
+            defineGeometry(m_boxPathGeometry.Get(), segments);
         }
     }
 
     virtual void setClutch()
     {
-        wchar_t str[100];
+        FormatBuffer str;
         float val = (1 - ir_Clutch.getFloat()) * 100;
 
-		m_brush->SetColor(mClutchCol);
-		swprintf(str, _countof(str), L"%.0f%%", val);
-		mText.render(m_renderTarget.Get(), str, mTextFormatXLarge.Get(), m_boxClutch.x0, m_boxClutch.x1, m_boxClutch.y0 + m_boxClutch.h * 0.50f, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER);
-        m_brush->SetColor(mTextCol);
+		m_dl.setColor(mClutchCol);
+		str.fixed(val, 0).ch(L'%');
+		m_dl.text(str.c_str(), mTextFormatXLarge.Get(), m_boxClutch.x0, m_boxClutch.x1, m_boxClutch.y0 + m_boxClutch.h * 0.50f, DWRITE_TEXT_ALIGNMENT_CENTER);
+        m_dl.setColor(mTextCol);
     }
 
     virtual void setBrake()
     {
-        wchar_t str[100];
+        FormatBuffer str;
         float val = ir_Brake.getFloat();
         val *= 100;
 
-		swprintf(str, _countof(str), L"%.0f%%", val);
-        m_brush->SetColor(mBrakeCol);
-		mText.render(m_renderTarget.Get(), str, mTextFormatXLarge.Get(), m_boxBrake.x0, m_boxBrake.x1, m_boxBrake.y0 + m_boxBrake.h * 0.50f, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER);
-        m_brush->SetColor(mTextCol);
+		str.fixed(val, 0).ch(L'%');
+        m_dl.setColor(mBrakeCol);
+		m_dl.text(str.c_str(), mTextFormatXLarge.Get(), m_boxBrake.x0, m_boxBrake.x1, m_boxBrake.y0 + m_boxBrake.h * 0.50f, DWRITE_TEXT_ALIGNMENT_CENTER);
+        m_dl.setColor(mTextCol);
     }
 
     virtual void setThrottle()
     {
-        wchar_t str[100];
+        FormatBuffer str;
         float val = ir_Throttle.getFloat() * 100;
 
-		swprintf(str, _countof(str), L"%.0f%%", val);
-        m_brush->SetColor(mThrottleCol);
-		mText.render(m_renderTarget.Get(), str, mTextFormatXLarge.Get(), m_boxThrottle.x0, m_boxThrottle.x1, m_boxThrottle.y0 + m_boxThrottle.h * 0.50f, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER);
-        m_brush->SetColor(mTextCol);
+		str.fixed(val, 0).ch(L'%');
+        m_dl.setColor(mThrottleCol);
+		m_dl.text(str.c_str(), mTextFormatXLarge.Get(), m_boxThrottle.x0, m_boxThrottle.x1, m_boxThrottle.y0 + m_boxThrottle.h * 0.50f, DWRITE_TEXT_ALIGNMENT_CENTER);
+        m_dl.setColor(mTextCol);
     }
 
     virtual void onUpdate()
     {
 
-        m_renderTarget->BeginDraw();
-        m_brush->SetColor(mTextCol);
+        m_dl.setColor(mTextCol);
 
-        m_brush->SetColor(mOutlineCol);
-        m_renderTarget->DrawGeometry(m_boxPathGeometry.Get(), m_brush.Get());
+        m_dl.setColor(mOutlineCol);
+        m_dl.drawGeometry(m_boxPathGeometry.Get());
 
-        mText.render(m_renderTarget.Get(), L"Brake", mTextFormatSmall.Get(), m_boxBrake.x0, m_boxBrake.x1, m_boxBrake.y0, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER);
-		mText.render(m_renderTarget.Get(), L"Clutch", mTextFormatSmall.Get(), m_boxClutch.x0, m_boxClutch.x1, m_boxClutch.y0, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER);
-        mText.render(m_renderTarget.Get(), L"Throttle", mTextFormatSmall.Get(), m_boxThrottle.x0, m_boxThrottle.x1, m_boxThrottle.y0, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER);
+        m_dl.text(L"Brake", mTextFormatSmall.Get(), m_boxBrake.x0, m_boxBrake.x1, m_boxBrake.y0, DWRITE_TEXT_ALIGNMENT_CENTER);
+		m_dl.text(L"Clutch", mTextFormatSmall.Get(), m_boxClutch.x0, m_boxClutch.x1, m_boxClutch.y0, DWRITE_TEXT_ALIGNMENT_CENTER);
+        m_dl.text(L"Throttle", mTextFormatSmall.Get(), m_boxThrottle.x0, m_boxThrottle.x1, m_boxThrottle.y0, DWRITE_TEXT_ALIGNMENT_CENTER);
 
-        m_brush->SetColor(mTextCol);
+        m_dl.setColor(mTextCol);
         setClutch();
         setBrake();
         setThrottle();
-
-        m_renderTarget->EndDraw();
     }
 
 protected:
@@ -197,8 +195,6 @@ protected:
     Microsoft::WRL::ComPtr<ID2D1PathGeometry1> m_boxPathGeometry;
     Microsoft::WRL::ComPtr<ID2D1PathGeometry1> m_backgroundPathGeometry;
 
-    TextCache           mText;
-
     float4              mTextCol;
     float4              mOutlineCol;
 
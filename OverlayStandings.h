@@ -29,6 +29,8 @@ SOFTWARE.
 #include "Overlay.h"
 #include "Config.h"
 #include "OverlayDebug.h"
+#include "ValueFormat.h"
+#include "CellCache.h"
 
 const double EPSILON = 0.0000001;
 
@@ -45,10 +47,11 @@ public:
 
     const float DefaultFontSize = 15;
 
-    enum class Columns { POSITION, CAR_NUMBER, NAME, DELTA, BEST, LAST, LICENSE, IRATING, PIT };
+    enum class Columns { POSITION, CAR_NUMBER, NAME, DELTA, BEST, LAST, LICENSE, IRATING, PIT, NUM_COLUMNS };
 
     OverlayStandings()
         : Overlay("OverlayStandings")
+        , m_cells( IR_MAX_CARS, (int)Columns::NUM_COLUMNS )
     {}
 
 protected:
@@ -66,6 +69,7 @@ protected:
     virtual void onConfigChanged()
     {
         m_text.reset( m_dwriteFactory.Get() );
+        m_cells.clear();
 
         const std::string font = g_cfg.getString( m_name, "font", "Microsoft YaHei UI" );
         const float fontSize = g_cfg.getFloat( m_name, "font_size", DefaultFontSize );
@@ -118,46 +122,50 @@ protected:
         float fastestLapTime = FLT_MAX;
         int fastestLapIdx = -1;
 
-        std::string userName;
         std::string driverClass = g_cfg.getString("OverlayStandings", "driver_class", "");
 
         bool classFilter = true;
         if (driverClass.empty())
             classFilter = false;
 
+        // Grab each per-car array once, rather than going through irsdkCVar per car.
+        // The rest comes from the hot table, only the class filter looks at ir_session->cars[].
+        const CarTable& cars           = ir_cars;
+        const auto& carIdxLapDistPct   = irv_CarIdxLapDistPct.all();
+        const auto& carIdxF2Time       = irv_CarIdxF2Time.all();
+        const auto& carIdxLastLapTime  = irv_CarIdxLastLapTime.all();
+        const bool  isRace             = ir_session->sessionType==SessionType::RACE;
+
         for( int i=0; i<IR_MAX_CARS; ++i )
         {
-            const Car& car = ir_session.cars[i];
-
-            if( car.isPaceCar || car.isSpectator || car.userName.empty() )
+            if( !cars.isValid(i) )
                 continue;
 
             CarInfo ci;
             ci.carIdx       = i;
-            ci.lapCount     = std::max( ir_CarIdxLap.getInt(i), ir_CarIdxLapCompleted.getInt(i) );
-            ci.position     = ir_getPosition(i);
-            ci.pctAroundLap = ir_CarIdxLapDistPct.getFloat(i);
-            ci.delta        = ir_session.sessionType!=SessionType::RACE ? 0 : -ir_CarIdxF2Time.getFloat(i);
-            ci.last         = ir_CarIdxLastLapTime.getFloat(i);
-            ci.pitAge       = ir_CarIdxLap.getInt(i) - car.lastLapInPits;
-
-            ci.best         = ir_CarIdxBestLapTime.getFloat(i);
-            if( ir_session.sessionType==SessionType::RACE && ir_SessionState.getInt()<=irsdk_StateWarmup || ir_session.sessionType==SessionType::QUALIFY && ci.best<=0 )
-                ci.best = car.qualTime;
-
+            ci.lapCount     = cars.lapCount[i];
+            ci.position     = cars.position[i];
+            ci.pctAroundLap = carIdxLapDistPct[i];
+            ci.delta        = isRace ? -carIdxF2Time[i] : 0;
+            ci.last         = carIdxLastLapTime[i];
+            ci.pitAge       = cars.pitAge[i];
+            ci.best         = cars.bestLapTime[i];
+
+            // Unfiltered, the fastest lap is the one the car table keeps track of anyway
             if (classFilter)
             {
-                userName.assign(car.userName);
-                if (userName.rfind(driverClass, 0) == 0)
-					carInfo.push_back( ci );
+                if (ir_session->text.view(ir_session->cars[i].userName).rfind(driverClass, 0) != 0)
+                    continue;
+
+                if( ci.best > 0 && ci.best < fastestLapTime ) {
+                    fastestLapTime = ci.best;
+                    fastestLapIdx = (int)carInfo.size();
+                }
             }
             else
-				carInfo.push_back( ci );
+                ci.hasFastestLap = i == cars.fastestIdx;
 
-            if( ci.best > 0 && ci.best < fastestLapTime ) {
-                fastestLapTime = ci.best;
-                fastestLapIdx = (int)carInfo.size()-1;
-            }
+            carInfo.push_back( ci );
         }
 
         if( fastestLapIdx >= 0 )
@@ -177,7 +185,7 @@ protected:
         {
             const CarInfo& ciLeader = carInfo[0];
             CarInfo&       ci       = carInfo[i];
-            const Car&      car = ir_session.cars[ci.carIdx];
+            const Car&      car = ir_session->cars[ci.carIdx];
 
             if (car.isSelf)
                 positionSelf = i;
@@ -210,50 +218,48 @@ protected:
         const float ybottom = m_height - lineHeight * 1.5f;
 
         const ColumnLayout::Column* clm = nullptr;
-        wchar_t s[512];
-        std::string str;
+        FormatBuffer s;
+        FormatBuffer* t = nullptr;
         D2D1_RECT_F r = {};
         D2D1_ROUNDED_RECT rr = {};
 
-        m_renderTarget->BeginDraw();
-        m_brush->SetColor( headerCol );
+        m_dl.setColor( headerCol );
 
         // Headers
         clm = m_columns.get( (int)Columns::POSITION );
-        swprintf( s, _countof(s), L"Pos." );
-        m_text.render( m_renderTarget.Get(), s, m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER );
+        m_dl.text( L"Pos.", m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, DWRITE_TEXT_ALIGNMENT_CENTER );
 
         clm = m_columns.get( (int)Columns::CAR_NUMBER );
-        swprintf( s, _countof(s), L"No." );
-        m_text.render( m_renderTarget.Get(), s, m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER );
+        m_dl.text( L"No.", m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, DWRITE_TEXT_ALIGNMENT_CENTER );
 
         clm = m_columns.get( (int)Columns::NAME );
-        swprintf( s, _countof(s), L"Driver" );
-        m_text.render( m_renderTarget.Get(), s, m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_LEADING );
+        m_dl.text( L"Driver", m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, DWRITE_TEXT_ALIGNMENT_LEADING );
 
         clm = m_columns.get( (int)Columns::PIT );
-        swprintf( s, _countof(s), L"P.Age" );
-        m_text.render( m_renderTarget.Get(), s, m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER );
+        m_dl.text( L"P.Age", m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, DWRITE_TEXT_ALIGNMENT_CENTER );
 
         clm = m_columns.get( (int)Columns::LICENSE );
-        swprintf( s, _countof(s), L"SR" );
-        m_text.render( m_renderTarget.Get(), s, m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER );
+        m_dl.text( L"SR", m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, DWRITE_TEXT_ALIGNMENT_CENTER );
 
         clm = m_columns.get( (int)Columns::IRATING );
-        swprintf( s, _countof(s), L"IR" );
-        m_text.render( m_renderTarget.Get(), s, m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER );
+        m_dl.text( L"IR", m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, DWRITE_TEXT_ALIGNMENT_CENTER );
 
         clm = m_columns.get( (int)Columns::BEST );
-        swprintf( s, _countof(s), L"Best" );
-        m_text.render( m_renderTarget.Get(), s, m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_TRAILING );
+        m_dl.text( L"Best", m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, DWRITE_TEXT_ALIGNMENT_TRAILING );
 
         clm = m_columns.get( (int)Columns::LAST );
-        swprintf( s, _countof(s), L"Last" );
-        m_text.render( m_renderTarget.Get(), s, m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_TRAILING );
+        m_dl.text( L"Last", m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, DWRITE_TEXT_ALIGNMENT_TRAILING );
 
         clm = m_columns.get( (int)Columns::DELTA );
-        swprintf( s, _countof(s), L"Delta" );
-        m_text.render( m_renderTarget.Get(), s, m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_TRAILING );
+        m_dl.text( L"Delta", m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, DWRITE_TEXT_ALIGNMENT_TRAILING );
+
+        // Car numbers and names are keyed by their text ids, which only hold within one session string update
+        if( ir_session->updateNum != m_cellsSessionUpdate )
+        {
+            m_cells.clear();
+            m_cellsSessionUpdate = ir_session->updateNum;
+        }
+        m_cells.beginFrame();
 
         // Content
         float gap = 0.0f;
@@ -299,18 +305,18 @@ protected:
             if( line & 1 && alternateLineBgCol.a > 0 )
             {
                 r = { 0, y-lineHeight/2, (float)m_width,  y+lineHeight/2 };
-                m_brush->SetColor( alternateLineBgCol );
-                m_renderTarget->FillRectangle( &r, m_brush.Get() );
+                m_dl.setColor( alternateLineBgCol );
+                m_dl.fillRect( r );
             }
 
 
             const CarInfo&  ci  = carInfo[i];
-            const Car&      car = ir_session.cars[ci.carIdx];
+            const Car&      car = ir_session->cars[ci.carIdx];
 
             // Dim color if player is disconnected.
             // TODO: this isn't 100% accurate, I think, because a car might be "not in world" while the player
             // is still connected? I haven't been able to find a better way to do this, though.
-            const bool isGone = !car.isSelf && ir_CarIdxTrackSurface.getInt(ci.carIdx) == irsdk_NotInWorld;
+            const bool isGone = !car.isSelf && irv_CarIdxTrackSurface[ci.carIdx] == irsdk_NotInWorld;
             float4 textCol = car.isSelf ? selfCol : (car.isBuddy ? buddyCol : (car.isFlagged?flaggedCol:otherCarCol));
             if( isGone )
                 textCol.a *= 0.5f;
@@ -319,124 +325,136 @@ protected:
             if( ci.position > 0 )
             {
                 clm = m_columns.get( (int)Columns::POSITION );
-                m_brush->SetColor( textCol );
-                swprintf( s, _countof(s), L"P%d", ci.position );
-                m_text.render( m_renderTarget.Get(), s, m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_TRAILING );
+                m_dl.setColor( textCol );
+                if( !m_cells.get( ci.carIdx, (int)Columns::POSITION, ci.position, t ) )
+                    appendPosition( *t, ci.position );
+                m_dl.text( t->c_str(), m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, DWRITE_TEXT_ALIGNMENT_TRAILING, m_cells.textHash( ci.carIdx, (int)Columns::POSITION ) );
             }
 
             // Car number
             {
                 clm = m_columns.get( (int)Columns::CAR_NUMBER );
-                swprintf( s, _countof(s), L"#%S", car.carNumberStr.c_str() );
+                if( !m_cells.get( ci.carIdx, (int)Columns::CAR_NUMBER, CellCache::Key(car.carNumberStr.off, car.carNumberStr.len), t ) )
+                    t->ch( L'#' ).chars( ir_session->str(car.carNumberStr) );
                 r = { xoff+clm->textL, y-lineHeight/2, xoff+clm->textR, y+lineHeight/2 };
                 rr.rect = { r.left-2, r.top+1, r.right+2, r.bottom-1 };
                 rr.radiusX = 3;
                 rr.radiusY = 3;
-                m_brush->SetColor( textCol );
-                m_renderTarget->FillRoundedRectangle( &rr, m_brush.Get() );
-                m_brush->SetColor( carNumberTextCol );
-                m_text.render( m_renderTarget.Get(), s, m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER );
+                m_dl.setColor( textCol );
+                m_dl.fillRoundedRect( rr );
+                m_dl.setColor( carNumberTextCol );
+                m_dl.text( t->c_str(), m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, DWRITE_TEXT_ALIGNMENT_CENTER, m_cells.textHash( ci.carIdx, (int)Columns::CAR_NUMBER ) );
             }
 
             // Name
             {
                 clm = m_columns.get( (int)Columns::NAME );
-                m_brush->SetColor( textCol );
-                swprintf( s, _countof(s), L"%S", car.userName.c_str() );
-                m_text.render( m_renderTarget.Get(), s, m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_LEADING );
+                m_dl.setColor( textCol );
+                if( !m_cells.get( ci.carIdx, (int)Columns::NAME, CellCache::Key(car.userName.off, car.userName.len), t ) )
+                    t->chars( ir_session->str(car.userName) );
+                m_dl.text( t->c_str(), m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, DWRITE_TEXT_ALIGNMENT_LEADING, m_cells.textHash( ci.carIdx, (int)Columns::NAME ) );
             }
 
             // Pit age
-            if( !ir_isPreStart() && (ci.pitAge>=0||ir_CarIdxOnPitRoad.getBool(ci.carIdx)) )
+            if( !ir_isPreStart() && (ci.pitAge>=0||irv_CarIdxOnPitRoad[ci.carIdx]) )
             {
                 clm = m_columns.get( (int)Columns::PIT );
-                m_brush->SetColor( pitCol );
-                swprintf( s, _countof(s), L"%d", ci.pitAge );
+                m_dl.setColor( pitCol );
                 r = { xoff+clm->textL, y-lineHeight/2+2, xoff+clm->textR, y+lineHeight/2-2 };
-                if( ir_CarIdxOnPitRoad.getBool(ci.carIdx) ) {
-                    swprintf( s, _countof(s), L"PIT" );
-                    m_renderTarget->FillRectangle( &r, m_brush.Get() );
-                    m_brush->SetColor( float4(0,0,0,1) );
+                const bool onPitRoad = irv_CarIdxOnPitRoad[ci.carIdx];
+                if( !m_cells.get( ci.carIdx, (int)Columns::PIT, CellCache::Key(onPitRoad, ci.pitAge), t ) )
+                {
+                    if( onPitRoad )
+                        t->chars( L"PIT" );
+                    else
+                        t->integer( ci.pitAge );
+                }
+                if( onPitRoad ) {
+                    m_dl.fillRect( r );
+                    m_dl.setColor( float4(0,0,0,1) );
                 }
                 else {
-                    swprintf( s, _countof(s), L"%d", ci.pitAge );
-                    m_renderTarget->DrawRectangle( &r, m_brush.Get() );
+                    m_dl.drawRect( r );
                 }
-                m_text.render( m_renderTarget.Get(), s, m_textFormatSmall.Get(), xoff+clm->textL, xoff+clm->textR, y, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER );
+                m_dl.text( t->c_str(), m_textFormatSmall.Get(), xoff+clm->textL, xoff+clm->textR, y, DWRITE_TEXT_ALIGNMENT_CENTER, m_cells.textHash( ci.carIdx, (int)Columns::PIT ) );
             }
 
             // License/SR
             {
                 clm = m_columns.get( (int)Columns::LICENSE );
-                swprintf( s, _countof(s), L"%C %.1f", car.licenseChar, car.licenseSR );
+                if( !m_cells.get( ci.carIdx, (int)Columns::LICENSE, CellCache::Key(car.licenseChar, CellCache::bits(car.licenseSR)), t ) )
+                    t->ch( (wchar_t)(unsigned char)car.licenseChar ).ch( L' ' ).fixed( car.licenseSR, 1 );
                 r = { xoff+clm->textL, y-lineHeight/2, xoff+clm->textR, y+lineHeight/2 };
                 rr.rect = { r.left+1, r.top+1, r.right-1, r.bottom-1 };
                 rr.radiusX = 3;
                 rr.radiusY = 3;
                 float4 c = car.licenseCol;
                 c.a = licenseBgAlpha;
-                m_brush->SetColor( c );
-                m_renderTarget->FillRoundedRectangle( &rr, m_brush.Get() );
-                m_brush->SetColor( licenseTextCol );
-                m_text.render( m_renderTarget.Get(), s, m_textFormatSmall.Get(), xoff+clm->textL, xoff+clm->textR, y, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER );
+                m_dl.setColor( c );
+                m_dl.fillRoundedRect( rr );
+                m_dl.setColor( licenseTextCol );
+                m_dl.text( t->c_str(), m_textFormatSmall.Get(), xoff+clm->textL, xoff+clm->textR, y, DWRITE_TEXT_ALIGNMENT_CENTER, m_cells.textHash( ci.carIdx, (int)Columns::LICENSE ) );
             }
 
             // Irating
             {
                 clm = m_columns.get( (int)Columns::IRATING );
-                swprintf( s, _countof(s), L"%.1fk", (float)car.irating/1000.0f );
+                if( !m_cells.get( ci.carIdx, (int)Columns::IRATING, car.irating, t ) )
+                    t->fixed( (float)car.irating/1000.0f, 1 ).ch( L'k' );
                 r = { xoff+clm->textL, y-lineHeight/2, xoff+clm->textR, y+lineHeight/2 };
                 rr.rect = { r.left+1, r.top+1, r.right-1, r.bottom-1 };
                 rr.radiusX = 3;
                 rr.radiusY = 3;
-                m_brush->SetColor( iratingBgCol );
-                m_renderTarget->FillRoundedRectangle( &rr, m_brush.Get() );
-                m_brush->SetColor( iratingTextCol );
-                m_text.render( m_renderTarget.Get(), s, m_textFormatSmall.Get(), xoff+clm->textL, xoff+clm->textR, y, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_CENTER );
+                m_dl.setColor( iratingBgCol );
+                m_dl.fillRoundedRect( rr );
+                m_dl.setColor( iratingTextCol );
+                m_dl.text( t->c_str(), m_textFormatSmall.Get(), xoff+clm->textL, xoff+clm->textR, y, DWRITE_TEXT_ALIGNMENT_CENTER, m_cells.textHash( ci.carIdx, (int)Columns::IRATING ) );
             }
 
             // Best
             {
                 clm = m_columns.get( (int)Columns::BEST );
-                str.clear();
-                if( ci.best > 0 )
-                    str = formatLaptime( ci.best );
-                m_brush->SetColor( ci.hasFastestLap ? fastestLapCol : otherCarCol );
-                m_text.render( m_renderTarget.Get(), toWide(str).c_str(), m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_TRAILING );
+                if( !m_cells.get( ci.carIdx, (int)Columns::BEST, CellCache::bits(ci.best), t ) && ci.best > 0 )
+                    appendLaptime( *t, ci.best );
+                m_dl.setColor( ci.hasFastestLap ? fastestLapCol : otherCarCol );
+                m_dl.text( t->c_str(), m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, DWRITE_TEXT_ALIGNMENT_TRAILING, m_cells.textHash( ci.carIdx, (int)Columns::BEST ) );
             }
 
             // Last
             {
                 clm = m_columns.get( (int)Columns::LAST );
-                str.clear();
-                if( ci.last > 0 )
-                    str = formatLaptime( ci.last );
-                m_brush->SetColor( otherCarCol );
-                m_text.render( m_renderTarget.Get(), toWide(str).c_str(), m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_TRAILING );
+                if( !m_cells.get( ci.carIdx, (int)Columns::LAST, CellCache::bits(ci.last), t ) && ci.last > 0 )
+                    appendLaptime( *t, ci.last );
+                m_dl.setColor( otherCarCol );
+                m_dl.text( t->c_str(), m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, DWRITE_TEXT_ALIGNMENT_TRAILING, m_cells.textHash( ci.carIdx, (int)Columns::LAST ) );
             }
 
             // Delta
             if( ci.lapDelta || ci.delta )
             {
                 clm = m_columns.get( (int)Columns::DELTA );
-                if( ci.lapDelta < 0 )
-                    swprintf( s, _countof(s), L"%d L", ci.lapDelta );
-                else
+                float delta = ci.delta;
+                if( ci.lapDelta >= 0 && classFilter )
                 {
-                    if (classFilter)
-                    {
-                        if (fabs(gap - 0.0f) < EPSILON)
-                            gap = ci.delta;
-
-						swprintf(s, _countof(s), L"%.03f", ci.delta - gap);
-                    }
+                    if (fabs(gap - 0.0f) < EPSILON)
+                        gap = ci.delta;
+                    delta = ci.delta - gap;
+                }
+                if( !m_cells.get( ci.carIdx, (int)Columns::DELTA, CellCache::Key(ci.lapDelta, CellCache::bits(delta)), t ) )
+                {
+                    if( ci.lapDelta < 0 )
+                        appendLapDelta( *t, ci.lapDelta );
                     else
-						swprintf(s, _countof(s), L"%.03f", ci.delta);
+                        appendDelta( *t, delta );
                 }
-                m_brush->SetColor( otherCarCol );
-                m_text.render( m_renderTarget.Get(), s, m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_TRAILING );
+                m_dl.setColor( otherCarCol );
+                m_dl.text( t->c_str(), m_textFormat.Get(), xoff+clm->textL, xoff+clm->textR, y, DWRITE_TEXT_ALIGNMENT_TRAILING, m_cells.textHash( ci.carIdx, (int)Columns::DELTA ) );
             }
         }
+
+        const CellCache::Stats& cellStats = m_cells.getStats();
+        dbg( "standings cells: %d of %d formatted this frame, %.1f%% since enabled", cellStats.lastFormatted, cellStats.lastCells,
+            cellStats.cells ? 100.0 * cellStats.formatted / cellStats.cells : 0.0 );
         
         // Footer
         {
@@ -450,15 +468,19 @@ protected:
                 tempUnit  = 'F';
             }
 
-            m_brush->SetColor(float4(1,1,1,0.4f));
-            m_renderTarget->DrawLine( float2(0,ybottom),float2((float)m_width,ybottom),m_brush.Get() );
-            swprintf(s, _countof(s), L"        SoF: %d", ir_session.sof);
+            m_dl.setColor(float4(1,1,1,0.4f));
+            m_dl.drawLine( float2(0,ybottom),float2((float)m_width,ybottom) );
+            // On multiclass grids, also the SoF of our own class
+            const int selfIdx = ir_session->driverCarIdx;
+            const int selfClass = selfIdx >= 0 && selfIdx < IR_MAX_CARS ? ir_session->cars[selfIdx].classIdx : -1;
+            if( selfClass >= 0 && ir_session->classes[selfClass].numCars < ir_session->numCars )
+                s.clear().chars(L"        SoF: ").integer(ir_session->sof).chars(L" (class ").integer(ir_session->classes[selfClass].sof).ch(L')');
+            else
+                s.clear().chars(L"        SoF: ").integer(ir_session->sof);
             y = m_height - (m_height-ybottom)/2;
-            m_brush->SetColor( headerCol );
-            m_text.render( m_renderTarget.Get(), s, m_textFormat.Get(), xoff, (float)m_width-2*xoff, y, m_brush.Get(), DWRITE_TEXT_ALIGNMENT_LEADING);
+            m_dl.setColor( headerCol );
+            m_dl.text( s.c_str(), m_textFormat.Get(), xoff, (float)m_width-2*xoff, y, DWRITE_TEXT_ALIGNMENT_LEADING);
         }
-
-        m_renderTarget->EndDraw();
     }
 
     virtual bool canEnableWhileNotDriving() const
@@ -477,6 +499,9 @@ protected:
     Microsoft::WRL::ComPtr<IDWriteTextFormat>  m_textFormatSmall;
 
     ColumnLayout m_columns;
-    TextCache    m_text;
     StandingsCfg mCfg;
+
+    // Text of each car's cells, only formatted again when what it shows has changed
+    CellCache    m_cells;
+    long long    m_cellsSessionUpdate = -1;
 };
@@ -0,0 +1,465 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "SessionDecode.h"
+#include "irsdk/irsdk_yamltree.h"
+#include "irsdk/irsdk_yamlschema.h"
+#include <string>
+#include <vector>
+#include <charconv>
+
+static bool parseYamlInt(const irsdkYamlTree& yaml, const char *path, int *dest, int from=-1)
+{
+    int count = 0;
+    const char *s = nullptr;
+
+    if( yaml.getVal(path, &s, &count, from) )
+    {
+        *dest = irsdk_yamlToInt( s, count );
+        return true;
+    }
+
+    return false;
+}
+
+static bool parseYamlStr(const irsdkYamlTree& yaml, const char *path, std::string& dest, int from=-1)
+{
+    int count = 0;
+    const char *s = nullptr;
+
+    if( yaml.getVal(path, &s, &count, from) )
+    {
+        const std::string_view v = irsdk_yamlToStr( s, count );
+        dest.assign( v.data(), v.size() );
+        return true;
+    }
+
+    return false;
+}
+
+// What was decoded from the session string last time, with the fingerprint of the
+// text it came from. See irsdkYamlTree::hash().
+struct DecodedResult
+{
+    unsigned long long  hash = 0;
+    int                 position = -1;
+    int                 carIdx = -1;
+    float               fastestTime = 0;
+};
+
+struct DecodedSession
+{
+    unsigned long long          hash = 0;   // everything but the results
+    int                         sessionNum = -1;
+    std::string                 name;
+    int                         isUnlimitedTime = 0;
+    int                         isUnlimitedLaps = 0;
+    std::vector<DecodedResult>  results;
+};
+
+struct DecodeCache
+{
+    unsigned long long          weekendInfo = 0;
+    unsigned long long          driverInfo = 0;
+    unsigned long long          drivers[IR_MAX_CARS] = {};
+    std::vector<DecodedResult>  qualResults;
+    std::vector<DecodedSession> sessions;
+};
+
+// Where the session string's keys go. One line per field, see irsdkYamlSchema.
+static constexpr auto WeekendInfoSchema = irsdk_makeYamlSchema<Session>({
+    { "SubSessionID",           &Session::subsessionId },
+    { "SeriesID",               &Session::seriesId },
+});
+
+static constexpr auto WeekendOptionsSchema = irsdk_makeYamlSchema<Session>({
+    { "IsFixedSetup",           &Session::isFixedSetup },
+});
+
+static constexpr auto DriverInfoSchema = irsdk_makeYamlSchema<Session>({
+    { "DriverCarIdx",           &Session::driverCarIdx },
+    { "DriverCarFuelMaxLtr",    &Session::fuelMaxLtr },
+    { "DriverCarIdleRPM",       &Session::rpmIdle },
+    { "DriverCarRedLine",       &Session::rpmRedline },
+    { "DriverCarSLFirstRPM",    &Session::rpmSLFirst },
+    { "DriverCarSLShiftRPM",    &Session::rpmSLShift },
+    { "DriverCarSLLastRPM",     &Session::rpmSLLast },
+    { "DriverCarSLBlinkRPM",    &Session::rpmSLBlink },
+});
+
+static constexpr auto DriverSchema = irsdk_makeYamlSchema<Car>({
+    { "UserName",               &Car::userName },
+    { "CarNumber",              &Car::carNumberStr },
+    { "CarNumberRaw",           &Car::carNumber },
+    { "LicString",              &Car::licenseStr },
+    { "LicColor",               &Car::licenseColStr },
+    { "IRating",                &Car::irating },
+    { "CarIsPaceCar",           &Car::isPaceCar },
+    { "IsSpectator",            &Car::isSpectator },
+    { "CurDriverIncidentCount", &Car::incidentCount },
+    { "CarClassEstLapTime",     &Car::carClassEstLapTime },
+    { "CarClassID",             &Car::carClassId },
+});
+
+// The text fields of Car, everything in Session::text that is still in use
+static constexpr irsdkStrId Car::* CarText[] = {
+    &Car::userName, &Car::carNumberStr, &Car::licenseStr, &Car::licenseColStr
+};
+
+static constexpr auto ResultSchema = irsdk_makeYamlSchema<DecodedResult>({
+    { "Position",               &DecodedResult::position },
+    { "CarIdx",                 &DecodedResult::carIdx },
+    { "FastestTime",            &DecodedResult::fastestTime },
+});
+
+// Only touched by whoever is decoding, see ir_decodeSessionStr()
+static DecodeCache          s_decodeCache;
+static SessionDecodeStats   s_decodeStats;
+static irsdkYamlTree        s_sessionYaml;
+static irsdkStringArena     s_sessionText;
+
+// Count a block or record, and remember its new fingerprint if it changed
+static bool recordChanged( unsigned long long hash, unsigned long long& lastHash )
+{
+    s_decodeStats.records++;
+    if( hash == lastHash )
+    {
+        s_decodeStats.skipped++;
+        s_decodeStats.totalSkipped++;
+        return false;
+    }
+
+    s_decodeStats.decoded++;
+    lastHash = hash;
+    return true;
+}
+
+// Start the session's text over with only what its cars still refer to, so strings
+// replaced by earlier updates don't pile up. This moves ids around, which is why
+// they can't be compared across Sessions.
+static void rebuildText( Session& session )
+{
+    irsdkStringArena& text = s_sessionText;
+    text.clear();
+    for( Car& car : session.cars )
+        for( irsdkStrId Car::* field : CarText )
+            car.*field = text.intern( session.text.view(car.*field) );
+    session.text = text;
+}
+
+// Index of a class in session.classes, added if it's new. Sessions are copied from the
+// previous one, so over a long run (several series, say) the classes fill up. Then a
+// class that no car refers to any more is reused, -1 if there is none.
+static int findClass( Session& session, int classId )
+{
+    for( int i=0; i<session.numClasses; ++i )
+        if( session.classes[i].classId == classId )
+            return i;
+
+    int idx = session.numClasses;
+    if( idx == IR_MAX_CLASSES )
+    {
+        bool used[IR_MAX_CLASSES] = {};
+        for( const Car& car : session.cars )
+            if( car.classIdx >= 0 )
+                used[car.classIdx] = true;
+
+        idx = 0;
+        while( idx < IR_MAX_CLASSES && used[idx] )
+            ++idx;
+        if( idx == IR_MAX_CLASSES )
+            return -1;
+    }
+    else
+        session.numClasses++;
+
+    CarClass& cls = session.classes[idx] = CarClass();
+    cls.classId = classId;
+    return idx;
+}
+
+// Add a car's share to the session and class totals (sign 1) or take it out again (-1).
+// Done around every change to a car, so the totals never need a pass over all cars.
+static void countCar( Session& session, const Car& car, int sign )
+{
+    if( !ir_isRacingCar(car) )
+        return;
+
+    session.numCars += sign;
+    session.iratingSum += sign * car.irating;
+    if( car.classIdx >= 0 )
+    {
+        CarClass& cls = session.classes[car.classIdx];
+        cls.numCars += sign;
+        cls.iratingSum += sign * car.irating;
+    }
+}
+
+// Decode the changed records of a results list (Position/CarIdx/FastestTime items)
+static void decodeResults( const irsdkYamlTree& yaml, int list, std::vector<DecodedResult>& results )
+{
+    int cnt = 0;
+    for( int item = list>=0 ? yaml.getNode(list).firstChild : -1; item>=0; item = yaml.getNode(item).nextSibling )
+    {
+        if( cnt == (int)results.size() )
+            results.emplace_back();
+        DecodedResult& res = results[cnt++];
+
+        if( !recordChanged( yaml.hash(item), res.hash ) )
+            continue;
+
+        res.position = -1;
+        res.carIdx = -1;
+        res.fastestTime = 0;
+        ResultSchema.decode( yaml, item, res );
+    }
+    results.resize( cnt );
+}
+
+// Bring session up to date with a new session string, session starts out as a copy of
+// the previous result.
+static void decodeSession( const char* sessionYaml, int sessionNum, Session& session )
+{
+    // Tokenize once, every lookup below then only walks the nodes on its path
+    irsdkYamlTree& yaml = s_sessionYaml;
+    yaml.parse( sessionYaml );
+
+    // Only decode blocks and records whose text changed since the last update.
+    // During a race that is mostly just the results of the current session.
+    s_decodeStats.records = 0;
+    s_decodeStats.decoded = 0;
+    s_decodeStats.skipped = 0;
+    s_decodeStats.updates++;
+
+    rebuildText( session );
+
+    // Weekend info
+    const int weekendInfo = yaml.find( "WeekendInfo:" );
+    if( recordChanged( weekendInfo>=0 ? yaml.hash(weekendInfo) : 0, s_decodeCache.weekendInfo ) )
+    {
+        WeekendInfoSchema.decode( yaml, weekendInfo, session );
+        WeekendOptionsSchema.decode( yaml, yaml.find("WeekendOptions:", weekendInfo), session );
+    }
+
+    // Sessions. Their results are fingerprinted separately, since they change all the time.
+    const int sessions = yaml.find( "SessionInfo:Sessions:" );
+    int numSessions = 0;
+    for( int item = sessions>=0 ? yaml.getNode(sessions).firstChild : -1; item>=0; item = yaml.getNode(item).nextSibling )
+    {
+        if( numSessions == (int)s_decodeCache.sessions.size() )
+            s_decodeCache.sessions.emplace_back();
+        DecodedSession& rec = s_decodeCache.sessions[numSessions++];
+
+        const irsdkYamlTree::Node& n = yaml.getNode( item );
+        const int results = yaml.find( "ResultsPositions:", item );
+        unsigned long long hash = yaml.hash( item );
+        if( results >= 0 )
+        {
+            const irsdkYamlTree::Node& r = yaml.getNode( results );
+            hash = irsdkYamlTree::hash( yaml.getData() + n.key, r.key - n.key );
+            hash = irsdkYamlTree::hash( yaml.getData() + r.end, n.end - r.end, hash );
+        }
+
+        if( recordChanged( hash, rec.hash ) )
+        {
+            rec.sessionNum = -1;
+            parseYamlInt( yaml, "SessionNum:", &rec.sessionNum, item );
+            parseYamlStr( yaml, "SessionName:", rec.name, item );
+
+            const char* val = nullptr;
+            int len = 0;
+            rec.isUnlimitedTime = int( yaml.getVal("SessionTime:", &val, &len, item) && irsdk_yamlToStr(val, len)=="unlimited" );
+            rec.isUnlimitedLaps = int( yaml.getVal("SessionLaps:", &val, &len, item) && irsdk_yamlToStr(val, len)=="unlimited" );
+        }
+
+        decodeResults( yaml, results, rec.results );
+    }
+    s_decodeCache.sessions.resize( numSessions );
+
+    // Current session type
+    std::string sessionNameStr;
+    for( const DecodedSession& rec : s_decodeCache.sessions )
+        if( rec.sessionNum == sessionNum )
+            sessionNameStr = rec.name;
+    if( sessionNameStr == "PRACTICE" )
+        session.sessionType = SessionType::PRACTICE;
+    if( sessionNameStr == "QUALIFY" )
+        session.sessionType = SessionType::QUALIFY;
+    else if( sessionNameStr == "RACE" )
+        session.sessionType = SessionType::RACE;
+
+    // Driver/car info
+    const int driverInfo = yaml.find( "DriverInfo:" );
+    if( recordChanged( driverInfo>=0 ? yaml.hash(driverInfo) : 0, s_decodeCache.driverInfo ) )
+    {
+        DriverInfoSchema.decode( yaml, driverInfo, session );
+    }
+
+    // Per-Driver info
+    bool present[IR_MAX_CARS] = {};
+    const int drivers = driverInfo>=0 ? yaml.find( "Drivers:", driverInfo ) : -1;
+    for( int item = drivers>=0 ? yaml.getNode(drivers).firstChild : -1; item>=0; item = yaml.getNode(item).nextSibling )
+    {
+        int carIdx = -1;
+        if( !parseYamlInt( yaml, "CarIdx:", &carIdx, item ) || carIdx < 0 || carIdx >= IR_MAX_CARS || present[carIdx] )
+            continue;
+        present[carIdx] = true;
+
+        if( !recordChanged( yaml.hash(item), s_decodeCache.drivers[carIdx] ) )
+            continue;
+
+        // Every mapped field in one pass over the item, into a blank car so nothing of the
+        // previous record (a field it had and this one lacks, its class) carries over.
+        // What isn't in the driver record is filled in again below.
+        Car& car = session.cars[carIdx];
+        countCar( session, car, -1 );
+        car = Car();
+        constexpr unsigned long long hasUserName = 1ull << DriverSchema.indexOf( "UserName" );
+        if( !(DriverSchema.decode( yaml, item, car, &session.text ) & hasUserName) )
+        {
+            car = Car();
+            continue;
+        }
+
+        // classIdx is -1 from the reset above, so findClass() doesn't see this car as
+        // still using the class it had before
+        car.classIdx = findClass( session, car.carClassId );
+
+        // Remove line breaks in user names if we find any (saw this happen once)
+        const std::string_view userName = session.text.view( car.userName );
+        if( userName.find_first_of( "\r\n" ) != std::string_view::npos )
+        {
+            std::string s( userName );
+            for( char& c : s )
+                c = (c=='\n'||c=='\r') ? ' ' : c;
+            car.userName = session.text.intern( s );
+        }
+
+        // "A 3.41": class and safety rating
+        const std::string_view lic = session.text.view( car.licenseStr );
+        car.licenseChar = lic.empty() ? 'R' : lic[0];
+        car.licenseSR = lic.empty() ? 0 : irsdk_yamlToFloat( lic.data()+1, (int)lic.size()-1 );
+
+        // "0xfeec04"
+        const std::string_view licCol = session.text.view( car.licenseColStr );
+        unsigned licColHex = 0;
+        if( licCol.size() > 2 && licCol[0]=='0' && licCol[1]=='x' )
+            std::from_chars( licCol.data()+2, licCol.data()+licCol.size(), licColHex, 16 );
+        car.licenseCol.r = float((licColHex >> 16) & 0xff) / 255.f;
+        car.licenseCol.g = float((licColHex >> 8) & 0xff) / 255.f;
+        car.licenseCol.b = float((licColHex >> 0) & 0xff) / 255.f;
+        car.licenseCol.a = 1;
+
+        countCar( session, car, 1 );
+    }
+
+    // Drivers that left
+    for( int carIdx=0; carIdx<IR_MAX_CARS; ++carIdx )
+    {
+        Car& car = session.cars[carIdx];
+        if( !present[carIdx] )
+        {
+            if( s_decodeCache.drivers[carIdx] )
+            {
+                countCar( session, car, -1 );
+                car = Car();
+            }
+            s_decodeCache.drivers[carIdx] = 0;
+            continue;
+        }
+
+        car.isSelf = int( carIdx==session.driverCarIdx );
+        car.practicePosition = 0;
+        car.qualPosition = 0;
+        car.racePosition = 0;
+    }
+
+    // Cars that found no class above because they were all taken, possibly by cars that
+    // have left since. Drivers aren't decoded again until their record changes, so retry now.
+    for( Car& car : session.cars )
+    {
+        if( car.classIdx >= 0 || car.userName.empty() )
+            continue;
+
+        countCar( session, car, -1 );
+        car.classIdx = findClass( session, car.carClassId );
+        countCar( session, car, 1 );
+    }
+
+    // Qualifying results info
+    const int qualResults = yaml.find( "QualifyResultsInfo:Results:" );
+    decodeResults( yaml, qualResults, s_decodeCache.qualResults );
+    for( const DecodedResult& res : s_decodeCache.qualResults )
+    {
+        // positions are 0-based here
+        if( res.carIdx < 0 || res.carIdx >= IR_MAX_CARS || res.position < 0 || res.position >= IR_MAX_CARS )
+            continue;
+        session.cars[res.carIdx].qualPosition = res.position + 1;
+        session.cars[res.carIdx].qualTime = res.fastestTime;
+    }
+
+    // Session results (may override qual results from above, but that's ok since hopefully they're the same!)
+    for( const DecodedSession& rec : s_decodeCache.sessions )
+    {
+        session.isUnlimitedTime = rec.isUnlimitedTime;
+        session.isUnlimitedLaps = rec.isUnlimitedLaps;
+
+        for( const DecodedResult& res : rec.results )
+        {
+            if( res.carIdx < 0 || res.carIdx >= IR_MAX_CARS || res.position < 1 || res.position > IR_MAX_CARS )
+                continue;
+
+            Car& car = session.cars[res.carIdx];
+            if( rec.name == "PRACTICE" )
+                car.practicePosition = res.position;
+            else if( rec.name == "QUALIFY" )
+                car.qualPosition = res.position;
+            else if( rec.name == "RACE" )
+                car.racePosition = res.position;
+        }
+    }
+
+    // SoF, from the totals kept up to date above
+    session.sof = session.numCars ? int(session.iratingSum / session.numCars) : 0;
+    for( int i=0; i<session.numClasses; ++i )
+    {
+        CarClass& cls = session.classes[i];
+        cls.sof = cls.numCars ? int(cls.iratingSum / cls.numCars) : 0;
+    }
+
+    s_decodeStats.textBytes = session.text.getUsed();
+    s_decodeStats.textMisses = session.text.getMisses();
+}
+
+void ir_decodeSessionStr( const char* sessionYaml, int sessionNum, Session& session, bool cold )
+{
+    if( cold )
+        s_decodeCache = DecodeCache();
+    decodeSession( sessionYaml, sessionNum, session );
+}
+
+const SessionDecodeStats& ir_getLastDecodeStats()
+{
+    return s_decodeStats;
+}
@@ -0,0 +1,143 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+// The Session that overlays read, and decoding it from the session string. Needs no
+// Windows, so the tools can run it anywhere.
+
+#include <string>
+#include "irsdk/irsdk_stringarena.h"
+#include "VecTypes.h"
+
+#define IR_MAX_CARS 64
+#define IR_MAX_CLASSES 16
+
+enum class SessionType
+{
+    UNKNOWN = 0,
+    PRACTICE,
+    QUALIFY,
+    RACE
+};
+static const char* const SessionTypeStr[] = {"UNKNOWN","PRACTICE","QUALIFY","RACE"};
+
+// Text fields are ids into the owning Session's text, see Session::str().
+struct Car
+{    
+    irsdkStrId      userName;
+    int             carNumber = 0;
+    irsdkStrId      carNumberStr;
+    irsdkStrId      licenseStr;
+    char            licenseChar = 'R';
+    float           licenseSR = 0;
+    irsdkStrId      licenseColStr;
+    float4          licenseCol = float4(0,0,0,1);
+    int             irating = 0;
+    int             isSelf = 0;
+    int             isPaceCar = 0;
+    int             isSpectator = 0;
+    int             isBuddy = 0;
+    int             isFlagged = 0;
+    int             incidentCount = 0;
+    float           carClassEstLapTime = 0;
+    int             carClassId = 0;
+    int             classIdx = -1;      // into Session::classes, -1 if there were too many
+    int             practicePosition = 0;
+    int             qualPosition = 0;
+    float           qualTime = 0;
+    int             racePosition = 0;
+};
+
+// Whether a car counts towards the SoF and car counts
+inline bool ir_isRacingCar( const Car& car )
+{
+    return !car.isPaceCar && !car.isSpectator && !car.userName.empty();
+}
+
+// Totals of a car class, over the cars that have a driver and aren't the pace car or spectating
+struct CarClass
+{
+    int             classId = 0;        // CarClassID, same as the CarIdxClass telemetry
+    int             numCars = 0;
+    long long       iratingSum = 0;
+    int             sof = 0;            // average irating
+};
+
+struct Session
+{
+    SessionType     sessionType = SessionType::UNKNOWN;
+    Car             cars[IR_MAX_CARS];
+    int             driverCarIdx = -1;
+    int             sof = 0;            // average irating, as in CarClass
+    int             numCars = 0;        // ...over this many cars
+    long long       iratingSum = 0;
+    CarClass        classes[IR_MAX_CLASSES];    // in order of appearance, reused once no car refers to them and all are taken
+    int             numClasses = 0;
+    int             subsessionId = 0;
+    int             seriesId = 0;
+    int             isFixedSetup = 0;
+    int             isUnlimitedTime = 0;
+    int             isUnlimitedLaps = 0;
+    float           fuelMaxLtr = 0;
+    float           rpmIdle = 0;
+    float           rpmRedline = 0;
+    float           rpmSLFirst = 0;
+    float           rpmSLShift = 0;
+    float           rpmSLLast = 0;
+    float           rpmSLBlink = 0;
+
+    // All the text of the cars above. Rebuilt with each update, so ids are only
+    // comparable within the same Session.
+    irsdkStringArena text;
+
+    // Which session string update this was decoded from, counting from 1. Sessions with the
+    // same one have the same text ids, a new one can have any.
+    long long       updateNum = 0;
+
+    const char* str( irsdkStrId id ) const { return text.c_str( id ); }
+};
+
+// How much of a session string update had to be decoded. Top-level blocks,
+// drivers, sessions and result records are fingerprinted, and only decoded when changed.
+struct SessionDecodeStats
+{
+    int         records = 0;        // blocks and records fingerprinted in the last update
+    int         decoded = 0;        // ...of which changed and were decoded
+    int         skipped = 0;        // ...of which were unchanged
+    long long   updates = 0;
+    long long   totalSkipped = 0;
+    int         textBytes = 0;      // size of the last Session's text
+    int         textMisses = 0;     // strings that didn't fit and came out empty
+};
+
+// Bring session up to date with a session string. session starts out as the result of the
+// previous call, and only records whose text changed since then are decoded. That state
+// is shared by all callers, so calls must not overlap: in iRon only the session decoder
+// thread behind ir_tick() makes them, a benchmark must not run alongside it. With cold,
+// the fingerprints of the last update are dropped and every record is decoded.
+void ir_decodeSessionStr( const char* sessionYaml, int sessionNum, Session& session, bool cold );
+
+// What the last ir_decodeSessionStr() call did. Only valid on the thread that made it.
+const SessionDecodeStats& ir_getLastDecodeStats();
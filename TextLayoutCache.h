@@ -0,0 +1,288 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <wchar.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+//
+// The caching policy behind TextCache: a bounded LRU of text layouts, without anything
+// platform specific, so it runs (and gets benchmarked, see tools/cmd_textbench.cpp) with a
+// fake factory as well as with DirectWrite.
+//
+// A layout is keyed by its full text, the format, the width and the alignment, and all
+// of it is compared on lookup, so a hash collision can't hand out the wrong string.
+// Once the cache is full, the least recently used layout makes room. Call beginFrame()
+// once per frame to also let go of layouts that haven't been used for a while, so
+// strings that are gone for good (old lap times, deltas...) don't stick around.
+// The text is hashed first and the rest of the key mixed in after, so a caller that draws
+// the same text frame after frame can hash it once (hashLayoutText()) and pass it to get().
+//
+// Factory makes and releases the layouts:
+//
+//   struct Factory
+//   {
+//       typedef ... Format;
+//       typedef ... Layout;
+//       Layout* create( const wchar_t* str, int len, Format* format, float width );
+//       void    release( Layout* layout );
+//   };
+//
+// FNV-1a over the text, the part of TextLayoutCache's key hash that is worth keeping around
+inline unsigned long long hashLayoutText( const wchar_t* str, int len )
+{
+    unsigned long long h = 14695981039346656037ull;
+    for( int i=0; i<len; ++i )
+        h = (h ^ (unsigned long long)str[i]) * 1099511628211ull;
+    return h;
+}
+
+template<typename Factory>
+class TextLayoutCache
+{
+    public:
+
+        typedef typename Factory::Format    Format;
+        typedef typename Factory::Layout    Layout;
+
+        struct Stats
+        {
+            long long   hits = 0;
+            long long   misses = 0;
+            long long   evictions = 0;      // made room for a new layout
+            long long   expired = 0;        // unused for maxIdleFrames
+            int         size = 0;
+        };
+
+        explicit TextLayoutCache( int capacity=1024, int maxIdleFrames=600 )
+            : m_entries( capacity )
+            , m_maxIdleFrames( maxIdleFrames )
+        {
+            int numBuckets = 16;
+            while( numBuckets < capacity*2 )
+                numBuckets *= 2;
+            m_buckets.assign( numBuckets, -1 );
+            clear();
+        }
+
+        ~TextLayoutCache()
+        {
+            clear();
+        }
+
+        TextLayoutCache( const TextLayoutCache& ) = delete;
+        TextLayoutCache& operator=( const TextLayoutCache& ) = delete;
+
+        // Release everything and make layouts with this factory from now on
+        void setFactory( Factory* factory )
+        {
+            clear();
+            m_factory = factory;
+        }
+
+        void clear()
+        {
+            for( Entry& e : m_entries )
+            {
+                if( e.layout )
+                    m_factory->release( e.layout );
+                e = Entry();
+            }
+            for( int& b : m_buckets )
+                b = -1;
+
+            m_head = m_tail = -1;
+            m_free = -1;
+            for( int i=(int)m_entries.size()-1; i>=0; --i )
+            {
+                m_entries[i].next = m_free;
+                m_free = i;
+            }
+            m_stats.size = 0;
+        }
+
+        // Cached layout for this text, made on a miss. Null if the factory failed, or there is none.
+        Layout* get( const wchar_t* str, int len, Format* format, float width, int align )
+        {
+            return get( str, len, format, width, align, hashLayoutText(str, len) );
+        }
+
+        // The same with textHash = hashLayoutText(str,len) worked out by the caller
+        Layout* get( const wchar_t* str, int len, Format* format, float width, int align, unsigned long long textHash )
+        {
+            unsigned widthBits;
+            memcpy( &widthBits, &width, sizeof(widthBits) );
+            const unsigned hash = hashKey( textHash, format, widthBits, align );
+            int& bucket = m_buckets[hash & (m_buckets.size()-1)];
+
+            for( int i=bucket; i>=0; i=m_entries[i].chain )
+            {
+                Entry& e = m_entries[i];
+                if( e.hash == hash && e.format == format && e.widthBits == widthBits && e.align == align &&
+                    (int)e.text.size() == len && !wmemcmp(e.text.data(), str, len) )
+                {
+                    m_stats.hits++;
+                    e.lastFrame = m_frame;
+                    if( i != m_head )
+                    {
+                        unlinkLru( i );
+                        linkLruFront( i );
+                    }
+                    return e.layout;
+                }
+            }
+
+            m_stats.misses++;
+            if( !m_factory || m_entries.empty() )
+                return nullptr;
+
+            // Make room first, so there are never more than capacity layouts around
+            if( m_free < 0 )
+            {
+                m_stats.evictions++;
+                remove( m_tail );
+            }
+
+            Layout* layout = m_factory->create( str, len, format, width );
+            if( !layout )
+                return nullptr;
+
+            const int i = m_free;
+            Entry& e = m_entries[i];
+            m_free = e.next;
+
+            e.text.assign( str, len );
+            e.format = format;
+            e.widthBits = widthBits;
+            e.align = align;
+            e.hash = hash;
+            e.layout = layout;
+            e.lastFrame = m_frame;
+            e.chain = bucket;
+            bucket = i;
+            linkLruFront( i );
+            m_stats.size++;
+
+            return layout;
+        }
+
+        // Let go of layouts that weren't used in the last maxIdleFrames frames. The least
+        // recently used ones are at the tail, so this only looks at the ones it releases.
+        void beginFrame()
+        {
+            m_frame++;
+            while( m_tail >= 0 && m_frame - m_entries[m_tail].lastFrame > m_maxIdleFrames )
+            {
+                m_stats.expired++;
+                remove( m_tail );
+            }
+        }
+
+        const Stats& getStats() const { return m_stats; }
+        int getCapacity() const { return (int)m_entries.size(); }
+
+    private:
+
+        struct Entry
+        {
+            std::wstring    text;
+            Format*         format = nullptr;
+            unsigned        widthBits = 0;
+            int             align = 0;
+            unsigned        hash = 0;
+            Layout*         layout = nullptr;
+            long long       lastFrame = 0;
+            int             chain = -1;     // next in the same bucket
+            int             prev = -1;      // LRU list, most recent first
+            int             next = -1;      // ...also the free list
+        };
+
+        static unsigned hashKey( unsigned long long textHash, Format* format, unsigned widthBits, int align )
+        {
+            unsigned long long h = textHash;
+            auto mix = [&h]( unsigned long long v ) { h = (h ^ v) * 1099511628211ull; };
+            mix( (unsigned long long)(size_t)format );
+            mix( widthBits );
+            mix( (unsigned)align );
+            return (unsigned)(h ^ (h >> 32));
+        }
+
+        void linkLruFront( int i )
+        {
+            Entry& e = m_entries[i];
+            e.prev = -1;
+            e.next = m_head;
+            if( m_head >= 0 )
+                m_entries[m_head].prev = i;
+            m_head = i;
+            if( m_tail < 0 )
+                m_tail = i;
+        }
+
+        void unlinkLru( int i )
+        {
+            Entry& e = m_entries[i];
+            if( e.prev >= 0 )
+                m_entries[e.prev].next = e.next;
+            else
+                m_head = e.next;
+            if( e.next >= 0 )
+                m_entries[e.next].prev = e.prev;
+            else
+                m_tail = e.prev;
+        }
+
+        void remove( int i )
+        {
+            Entry& e = m_entries[i];
+
+            int* link = &m_buckets[e.hash & (m_buckets.size()-1)];
+            while( *link != i )
+                link = &m_entries[*link].chain;
+            *link = e.chain;
+
+            unlinkLru( i );
+            m_factory->release( e.layout );
+
+            e.layout = nullptr;
+            e.format = nullptr;
+            e.text.clear();
+            e.next = m_free;
+            m_free = i;
+            m_stats.size--;
+        }
+
+        std::vector<Entry>  m_entries;
+        std::vector<int>    m_buckets;      // first entry of each chain
+        int                 m_head = -1;
+        int                 m_tail = -1;
+        int                 m_free = -1;
+        long long           m_frame = 0;
+        int                 m_maxIdleFrames;
+        Factory*            m_factory = nullptr;
+        Stats               m_stats;
+};
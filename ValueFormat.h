@@ -0,0 +1,186 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <wchar.h>
+#include <math.h>
+#include <charconv>
+
+//
+// Number and time formatting for overlay text, written straight into a fixed-size wide
+// char buffer that lives on the stack. Built on std::to_chars: no heap, no locale, no
+// format string to parse every frame. Appending stops at the capacity, and the text is
+// always zero-terminated, so it can go right into DisplayList::text().
+//
+// The append* functions produce exactly what the overlays used to get out of swprintf and
+// wstringstream, see tools/cmd_fmtbench.cpp.
+//
+class FormatBuffer
+{
+    public:
+
+        static const int Capacity = 128;
+
+        FormatBuffer() { clear(); }
+
+        FormatBuffer& clear()
+        {
+            m_len = 0;
+            m_s[0] = 0;
+            return *this;
+        }
+
+        FormatBuffer& ch( wchar_t c )
+        {
+            if( m_len < Capacity-1 )
+            {
+                m_s[m_len++] = c;
+                m_s[m_len] = 0;
+            }
+            return *this;
+        }
+
+        // Narrow strings are widened byte by byte, like toWide()
+        FormatBuffer& chars( const char* s )
+        {
+            while( *s && m_len < Capacity-1 )
+                m_s[m_len++] = (wchar_t)(unsigned char)*s++;
+            m_s[m_len] = 0;
+            return *this;
+        }
+
+        FormatBuffer& chars( const wchar_t* s )
+        {
+            while( *s && m_len < Capacity-1 )
+                m_s[m_len++] = *s++;
+            m_s[m_len] = 0;
+            return *this;
+        }
+
+        // Like "%*lld", or "%0*lld" with fill '0'
+        FormatBuffer& integer( long long v, int width=0, char fill=' ' )
+        {
+            char tmp[24];
+            const std::to_chars_result r = std::to_chars( tmp, tmp+sizeof(tmp), v );
+            return padded( tmp, r.ptr, width, fill );
+        }
+
+        // Like "%*.*f", or "%0*.*f" with fill '0'
+        FormatBuffer& fixed( double v, int decimals, int width=0, char fill=' ' )
+        {
+            char tmp[64];
+            std::to_chars_result r = std::to_chars( tmp, tmp+sizeof(tmp), v, std::chars_format::fixed, decimals );
+            if( r.ec != std::errc() )  // too many digits for any overlay, print it short instead
+                r = std::to_chars( tmp, tmp+sizeof(tmp), v );
+            return padded( tmp, r.ptr, width, fill );
+        }
+
+        // Like "%.*g", which is also what a stream prints with precision() set
+        FormatBuffer& general( double v, int precision )
+        {
+            char tmp[64];
+            const std::to_chars_result r = std::to_chars( tmp, tmp+sizeof(tmp), v, std::chars_format::general, precision );
+            return padded( tmp, r.ptr, 0, ' ' );
+        }
+
+        const wchar_t*  c_str() const { return m_s; }
+        int             size() const { return m_len; }
+        bool            empty() const { return m_len == 0; }
+
+    private:
+
+        FormatBuffer& padded( const char* begin, const char* end, int width, char fill )
+        {
+            int pad = width - (int)(end - begin);
+            if( fill == '0' && begin < end && *begin == '-' )   // zeros go after the sign
+                ch( (wchar_t)*begin++ );
+            for( ; pad > 0; --pad )
+                ch( (wchar_t)fill );
+            for( ; begin < end && m_len < Capacity-1; ++begin )
+                m_s[m_len++] = (wchar_t)*begin;
+            m_s[m_len] = 0;
+            return *this;
+        }
+
+        wchar_t     m_s[Capacity];
+        int         m_len = 0;
+};
+
+// Lap time as "1:23.456", or "59.123" under a minute
+inline FormatBuffer& appendLaptime( FormatBuffer& buf, float secs )
+{
+    const int mins = int(secs/60.0f);
+    if( mins )
+        return buf.integer( mins ).ch( L':' ).fixed( fmodf(secs,60.0f), 3, 6, '0' );
+    return buf.fixed( secs, 3 );
+}
+
+// Time or gap to another car in seconds, "12.345"
+inline FormatBuffer& appendDelta( FormatBuffer& buf, float secs )
+{
+    return buf.fixed( secs, 3 );
+}
+
+// Gap in whole laps, "-2 L"
+inline FormatBuffer& appendLapDelta( FormatBuffer& buf, int laps )
+{
+    return buf.integer( laps ).chars( " L" );
+}
+
+// Fuel volume, already in the units shown, with them: "12.3 lt" or "3.2 gl"
+inline FormatBuffer& appendFuel( FormatBuffer& buf, float volume, bool imperial, int decimals=1, int width=3 )
+{
+    return buf.fixed( volume, decimals, width ).chars( imperial ? " gl" : " lt" );
+}
+
+// Temperature to three significant digits, already in the units shown: "31.4C"
+inline FormatBuffer& appendTemperature( FormatBuffer& buf, float degrees, bool imperial )
+{
+    return buf.general( degrees, 3 ).ch( imperial ? L'F' : L'C' );
+}
+
+// Time of day, "09:41"
+inline FormatBuffer& appendClock( FormatBuffer& buf, int hours, int mins )
+{
+    return buf.integer( hours, 2, '0' ).ch( L':' ).integer( mins, 2, '0' );
+}
+
+// Duration as "1:02:03", or "02:03" under an hour
+inline FormatBuffer& appendDuration( FormatBuffer& buf, double secs )
+{
+    const int hours = int(secs / 3600.0);
+    const int mins = int(secs / 60.0) % 60;
+    const int s = (int)fmod(secs, 60.0);
+    if( hours )
+        buf.integer( hours ).ch( L':' );
+    return buf.integer( mins, 2, '0' ).ch( L':' ).integer( s, 2, '0' );
+}
+
+// Race position, "P3"
+inline FormatBuffer& appendPosition( FormatBuffer& buf, int position )
+{
+    return buf.ch( L'P' ).integer( position );
+}
@@ -0,0 +1,63 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+// Small vectors, convertible to and from their Direct2D counterparts on Windows.
+// Kept out of util.h so code that runs without Windows (the session decoder, say)
+// can use them too.
+
+#ifdef _WIN32
+#include <d2d1.h>
+#endif
+
+struct float2
+{
+    union { float r; float x; };
+    union { float g; float y; };
+    float2() = default;
+    float2( float _x, float _y ) : x(_x), y(_y) {}
+#ifdef _WIN32
+    float2( const D2D1_POINT_2F& p ) : x(p.x), y(p.y) {}
+    operator D2D1_POINT_2F() const { return {x,y}; }
+#endif
+    float* operator&() { return &x; }
+    const float* operator&() const { return &x; }
+};
+
+struct float4
+{
+    union { float r; float x; };
+    union { float g; float y; };
+    union { float b; float z; };
+    union { float a; float w; };
+    float4() = default;
+    float4( float _x, float _y, float _z, float _w ) : x(_x), y(_y), z(_z), w(_w) {}
+#ifdef _WIN32
+    float4( const D2D1_COLOR_F& c ) : r(c.r), g(c.g), b(c.b), a(c.a) {}
+    operator D2D1_COLOR_F() const { return {r,g,b,a}; }
+#endif
+    float* operator&() { return &x; }
+    const float* operator&() const { return &x; }
+};
@@ -24,6 +24,15 @@ SOFTWARE.
 
 #include "iracing.h"
 #include "Config.h"
+#include "EpochPublisher.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define IR_CARTABLE_SSE2
+    #include <emmintrin.h>
+#endif
 
 irsdkCVar ir_SessionTime("SessionTime");    // double[1] Seconds since session start (s)
 irsdkCVar ir_SessionTick("SessionTick");    // int[1] Current update number ()
@@ -316,248 +325,452 @@ irsdkCVar ir_LFSHshockDefl_ST("LFSHshockDefl_ST");    // float[6] LFSH shock def
 irsdkCVar ir_LFSHshockVel("LFSHshockVel");    // float[1] LFSH shock velocity (m/s)
 irsdkCVar ir_LFSHshockVel_ST("LFSHshockVel_ST");    // float[6] LFSH shock velocity at 360 Hz (m/s)
 
-Session ir_session;
-
-static bool parseYamlInt(const char *yamlStr, const char *path, int *dest)
+irsdkVar<int,IR_MAX_CARS>   irv_CarIdxLap("CarIdxLap");
+irsdkVar<int,IR_MAX_CARS>   irv_CarIdxLapCompleted("CarIdxLapCompleted");
+irsdkVar<float,IR_MAX_CARS> irv_CarIdxLapDistPct("CarIdxLapDistPct");
+irsdkVar<int,IR_MAX_CARS>   irv_CarIdxTrackSurface("CarIdxTrackSurface");
+irsdkVar<bool,IR_MAX_CARS>  irv_CarIdxOnPitRoad("CarIdxOnPitRoad");
+irsdkVar<int,IR_MAX_CARS>   irv_CarIdxPosition("CarIdxPosition");
+irsdkVar<int,IR_MAX_CARS>   irv_CarIdxClassPosition("CarIdxClassPosition");
+irsdkVar<float,IR_MAX_CARS> irv_CarIdxF2Time("CarIdxF2Time");
+irsdkVar<float,IR_MAX_CARS> irv_CarIdxLastLapTime("CarIdxLastLapTime");
+irsdkVar<float,IR_MAX_CARS> irv_CarIdxBestLapTime("CarIdxBestLapTime");
+irsdkVar<int>               irv_SessionState("SessionState");
+irsdkVar<double>            irv_SessionTime("SessionTime");
+
+static_assert( sizeof(SampleChannelVar)/sizeof(SampleChannelVar[0]) == (int)SampleChannel::COUNT, "SampleChannelVar out of sync" );
+irsdkSampleStream ir_samples( SampleChannelVar, (int)SampleChannel::COUNT );
+
+static const Session         s_noSession;
+const Session*               ir_session = &s_noSession;
+
+static irsdkAcquisition      s_acquisition;
+static const irsdkSnapshot*  s_snapshot = nullptr;
+static int                   s_parsedSessionCt = -1;
+static int                   s_parsedStatusID = -1;
+static TelemetryStaleness    s_staleness;
+static CarTable              s_cars;
+static long long             s_carsSessionUpdate = -1;
+const CarTable&              ir_cars = s_cars;
+
+// Decodes session strings on a thread of its own and publishes each result as a new,
+// immutable Session. Only the latest posted string is decoded, anything posted while
+// the thread is busy replaces the one still waiting.
+class SessionDecoder
 {
-    int count = 0;
-    const char *s = nullptr;
+public:
 
-    if( parseYaml(yamlStr, path, &s, &count) )
+    SessionDecoder()
+        : m_sessions( new Session() )
+    {}
+
+    ~SessionDecoder()
     {
-        *dest = atoi( s );
-        return true;
+        if( m_thread.joinable() )
+        {
+            {
+                std::lock_guard<std::mutex> lock( m_mutex );
+                m_stop = true;
+            }
+            m_cond.notify_all();
+            m_thread.join();
+        }
     }
 
-    return false;
-}
+    void post( const char* sessionYaml, int sessionNum )
+    {
+        if( !m_thread.joinable() )
+            m_thread = std::thread( &SessionDecoder::run, this );
 
-static bool parseYamlFloat(const char *yamlStr, const char *path, float *dest)
-{
-    int count = 0;
-    const char *s = nullptr;
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            m_pendingYaml = sessionYaml ? sessionYaml : "";
+            m_pendingSessionNum = sessionNum;
+            m_posted++;
+        }
+        m_cond.notify_all();
+    }
 
-    if( parseYaml(yamlStr, path, &s, &count) )
+    // Block until everything posted so far is published
+    void sync()
     {
-        (*dest) = (float)atof( s );
-        return true;
+        std::unique_lock<std::mutex> lock( m_mutex );
+        m_cond.wait( lock, [this]{ return m_done == m_posted; } );
     }
 
-    return false;
-}
+    // The latest Session, valid until the next pin() from the same thread (reader slot 0)
+    const Session* pin()
+    {
+        return m_sessions.pin( 0 );
+    }
 
-static bool parseYamlStr(const char *yamlStr, const char *path, std::string& dest)
-{
-    int count = 0;
-    const char *s = nullptr;
+    SessionDecodeStats getStats()
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        return m_stats;
+    }
 
-    if( parseYaml(yamlStr, path, &s, &count) )
+private:
+
+    void run()
     {
-        // strip leading quotes
-        if( *s == '"' )
+        std::string yaml;
+        std::unique_lock<std::mutex> lock( m_mutex );
+        while( true )
         {
-            s++;
-            count--;
+            m_cond.wait( lock, [this]{ return m_stop || m_done != m_posted; } );
+            if( m_stop )
+                return;
+
+            yaml.swap( m_pendingYaml );
+            const int sessionNum = m_pendingSessionNum;
+            const long long posted = m_posted;
+            lock.unlock();
+
+            Session* session = new Session( *m_sessions.latest() );
+            ir_decodeSessionStr( yaml.c_str(), sessionNum, *session, false );
+            session->updateNum = posted;
+            m_sessions.publish( session );
+
+            lock.lock();
+            m_stats = ir_getLastDecodeStats();
+            m_done = posted;
+            m_cond.notify_all();
         }
+    }
 
-        dest.assign( s, count );
+    EpochPublisher<Session>     m_sessions;
+    std::thread                 m_thread;
+    std::mutex                  m_mutex;
+    std::condition_variable     m_cond;
+    std::string                 m_pendingYaml;
+    int                         m_pendingSessionNum = 0;
+    long long                   m_posted = 0;
+    long long                   m_done = 0;
+    bool                        m_stop = false;
+    SessionDecodeStats          m_stats;
+};
+
+static SessionDecoder s_sessionDecoder;
+
+SessionDecodeStats ir_getSessionDecodeStats()
+{
+    return s_sessionDecoder.getStats();
+}
 
-        // strip trailing quotes
-        if( !dest.empty() && dest[dest.length()-1]=='"' )
-            dest.pop_back();
+void ir_syncSession()
+{
+    s_sessionDecoder.sync();
+    ir_session = s_sessionDecoder.pin();
+}
 
-        return true;
-    }
+void ir_startAcquisition()
+{
+    // Nothing to read until the first snapshot arrives
+    irsdkClient::setThreadView( nullptr );
+    s_acquisition.addSampleStream( &ir_samples );
+    s_acquisition.start( 16 );
+}
 
-    return false;
+void ir_stopAcquisition()
+{
+    s_acquisition.release( s_snapshot );
+    s_snapshot = nullptr;
+    s_acquisition.stop();
+    irsdkClient::clearThreadView();
 }
 
-ConnectionStatus ir_tick()
+const TelemetryStaleness& ir_getStaleness()
 {
-    irsdkClient& irsdk = irsdkClient::instance();
+    return s_staleness;
+}
 
-    irsdk.waitForData(16);
+irsdkAcquisition::Stats ir_getAcquisitionStats()
+{
+    return s_acquisition.getStats();
+}
 
-    if( !irsdk.isConnected() )
-        return ConnectionStatus::DISCONNECTED;
+void ir_getLineTiming( int* tickCount, long long* lineTime )
+{
+    irsdkClient& irsdk = irsdkClient::instance();
 
-    if( irsdk.wasSessionStrUpdated() )
+    *tickCount = 0;
+    *lineTime = 0;
+    if( s_acquisition.isRunning() )
     {
-        const char* sessionYaml = irsdk.getSessionStr();
-#ifdef _DEBUG
-        //printf("%s\n", sessionYaml);
-        FILE* fp = fopen("sessionYaml.txt","ab");
-        fprintf(fp,"\n\n==== NEW SESSION STRING ======================================\n");
-        fprintf(fp,"%s",sessionYaml);
-        fclose(fp);
-#endif
-        char path[256];
-
-        // Weekend info
-        sprintf( path, "WeekendInfo:SubSessionID:" );
-        parseYamlInt( sessionYaml, path, &ir_session.subsessionId );
-
-        sprintf( path, "WeekendInfo:SeriesID:" );
-        parseYamlInt( sessionYaml, path, &ir_session.seriesId );
-
-        sprintf( path, "WeekendInfo:WeekendOptions:IsFixedSetup:" );
-        parseYamlInt( sessionYaml, path, &ir_session.isFixedSetup );
-
-        // Current session type
-        std::string sessionNameStr;
-        sprintf( path, "SessionInfo:Sessions:SessionNum:{%d}SessionName:", ir_SessionNum.getInt() );
-        parseYamlStr( sessionYaml, path, sessionNameStr );
-        if( sessionNameStr == "PRACTICE" )
-            ir_session.sessionType = SessionType::PRACTICE;
-        if( sessionNameStr == "QUALIFY" )
-            ir_session.sessionType = SessionType::QUALIFY;
-        else if( sessionNameStr == "RACE" )
-            ir_session.sessionType = SessionType::RACE;
-
-        // Driver/car info
-        parseYamlInt( sessionYaml, "DriverInfo:DriverCarIdx:", &ir_session.driverCarIdx );
-        parseYamlFloat( sessionYaml, "DriverInfo:DriverCarFuelMaxLtr:", &ir_session.fuelMaxLtr );
-        parseYamlFloat( sessionYaml, "DriverInfo:DriverCarIdleRPM:", &ir_session.rpmIdle );
-        parseYamlFloat( sessionYaml, "DriverInfo:DriverCarRedLine:", &ir_session.rpmRedline );
-        parseYamlFloat( sessionYaml, "DriverInfo:DriverCarSLFirstRPM:", &ir_session.rpmSLFirst );
-        parseYamlFloat( sessionYaml, "DriverInfo:DriverCarSLShiftRPM:", &ir_session.rpmSLShift );
-        parseYamlFloat( sessionYaml, "DriverInfo:DriverCarSLLastRPM:", &ir_session.rpmSLLast );
-        parseYamlFloat( sessionYaml, "DriverInfo:DriverCarSLBlinkRPM:", &ir_session.rpmSLBlink );
-
-        // Per-Driver info
-        for( int carIdx=0; carIdx<IR_MAX_CARS; ++carIdx )
+        if( s_snapshot && s_snapshot->line )
         {
-            Car& car = ir_session.cars[carIdx];
-
-            car.isSelf = int( carIdx==ir_session.driverCarIdx );
-
-            sprintf( path, "DriverInfo:Drivers:CarIdx:{%d}UserName:", carIdx );
-            if( !parseYamlStr( sessionYaml, path, car.userName ) )
-            {
-                car = Car();
-                continue;
-            }
-
-            // Remove line breaks in user names if we find any (saw this happen once)
-            for( char& c : car.userName )
-                c = (c=='\n'||c=='\r') ? ' ' : c;
-
-            sprintf( path, "DriverInfo:Drivers:CarIdx:{%d}CarNumber:", carIdx );
-            parseYamlStr( sessionYaml, path, car.carNumberStr );
+            *tickCount = s_snapshot->tickCount;
+            *lineTime = s_snapshot->lineTime;
+        }
+    }
+    else if( irsdk.isConnected() )
+    {
+        *tickCount = irsdk.getLineTickCount();
+        *lineTime = irsdk.getLineTime();
+    }
+}
 
-            sprintf( path, "DriverInfo:Drivers:CarIdx:{%d}CarNumberRaw:", carIdx );
-            parseYamlInt( sessionYaml, path, &car.carNumber );
+bool ir_isFileFinished()
+{
+    if( s_acquisition.isRunning() )
+        return s_snapshot && s_snapshot->fileFinished;
+    return irsdkClient::instance().isFileFinished();
+}
 
-            sprintf( path, "DriverInfo:Drivers:CarIdx:{%d}LicString:", carIdx );
-            parseYamlStr( sessionYaml, path, car.licenseStr );
-            car.licenseChar = car.licenseStr.empty() ? 'R' : car.licenseStr[0];
-            const std::string SRstr = car.licenseStr.empty() ? "0" : std::string( car.licenseStr.begin()+1, car.licenseStr.end() );
-            car.licenseSR = (float)atof( SRstr.c_str() );
+// Swap to the latest snapshot from the acquisition thread, waiting a frame's worth for one.
+static void pickUpSnapshot()
+{
+    const long long seenSeq = s_snapshot ? s_snapshot->seq : 0;
+    s_acquisition.waitForNewer( seenSeq, 16 );
 
-            sprintf( path, "DriverInfo:Drivers:CarIdx:{%d}LicColor:", carIdx );
-            parseYamlStr( sessionYaml, path, car.licenseColStr );
-            unsigned licColHex = 0;
-            sscanf(car.licenseColStr.c_str(), "0x%x", &licColHex);
-			car.licenseCol.r = float((licColHex >> 16) & 0xff) / 255.f;
-			car.licenseCol.g = float((licColHex >> 8) & 0xff) / 255.f;
-			car.licenseCol.b = float((licColHex >> 0) & 0xff) / 255.f;
-			car.licenseCol.a = 1;
+    const irsdkSnapshot* snap = s_acquisition.acquire();
+    if( !snap )
+        return;
 
-            sprintf( path, "DriverInfo:Drivers:CarIdx:{%d}IRating:", carIdx );
-            parseYamlInt( sessionYaml, path, &car.irating );
+    if( snap == s_snapshot )
+    {
+        // Nothing new, we already hold this one
+        s_acquisition.release( snap );
+        return;
+    }
 
-            sprintf( path, "DriverInfo:Drivers:CarIdx:{%d}CarIsPaceCar:", carIdx );
-            parseYamlInt( sessionYaml, path, &car.isPaceCar );
+    LARGE_INTEGER now, freq;
+    QueryPerformanceCounter( &now );
+    QueryPerformanceFrequency( &freq );
+    const float ageMs = float( double(now.QuadPart - snap->publishTime) * 1000.0 / freq.QuadPart );
 
-            sprintf( path, "DriverInfo:Drivers:CarIdx:{%d}IsSpectator:", carIdx );
-            parseYamlInt( sessionYaml, path, &car.isSpectator );
+    s_staleness.ticks++;
+    s_staleness.skipped += std::max( 0LL, snap->seq - seenSeq - 1 );
+    s_staleness.lastAgeMs = ageMs;
+    s_staleness.avgAgeMs = s_staleness.ticks == 1 ? ageMs : s_staleness.avgAgeMs * 0.98f + ageMs * 0.02f;
+    s_staleness.maxAgeMs = std::max( s_staleness.maxAgeMs, ageMs );
 
-            sprintf( path, "DriverInfo:Drivers:CarIdx:{%d}CurDriverIncidentCount:", carIdx );
-            parseYamlInt( sessionYaml, path, &car.incidentCount );
+    s_acquisition.release( s_snapshot );
+    s_snapshot = snap;
+    irsdkClient::setThreadView( snap );
+}
 
-            sprintf( path, "DriverInfo:Drivers:CarIdx:{%d}CarClassEstLapTime:", carIdx );
-            parseYamlFloat( sessionYaml, path, &car.carClassEstLapTime );
+// Bring ir_cars up to date with the current telemetry line and ir_session
+static void updateCarTable()
+{
+    CarTable& t = s_cars;
 
-            car.practicePosition = 0;
-            car.qualPosition = 0;
-            car.racePosition = 0;
-        }
+    // What comes from the session string only changes with it
+    if( s_carsSessionUpdate != ir_session->updateNum )
+    {
+        s_carsSessionUpdate = ir_session->updateNum;
 
-        // Qualifying results info
-        for( int pos=0; pos<IR_MAX_CARS; ++pos )
+        t.validMask = 0;
+        for( int carIdx=0; carIdx<IR_MAX_CARS; ++carIdx )
         {
-            sprintf( path, "QualifyResultsInfo:Results:Position:{%d}CarIdx:", pos );
-            int carIdx = -1;
-            if( parseYamlInt( sessionYaml, path, &carIdx ) ) {
-                ir_session.cars[carIdx].qualPosition = pos + 1;
-
-                sprintf( path, "QualifyResultsInfo:Results:Position:{%d}FastestTime:", pos );
-                parseYamlFloat( sessionYaml, path, &ir_session.cars[carIdx].qualTime );
-            }
+            const Car& car = ir_session->cars[carIdx];
+            if( ir_isRacingCar(car) )
+                t.validMask |= 1ull << carIdx;
+            t.classIdx[carIdx] = car.classIdx;
+
+            int pos = car.racePosition;
+            if( pos <= 0 )
+                pos = car.qualPosition;
+            if( pos <= 0 )
+                pos = car.practicePosition;
+            t.sessionPosition[carIdx] = std::max( pos, 0 );
+            t.qualTime[carIdx] = car.qualTime;
         }
+    }
 
-        // Session info (may override qual results from above, but that's ok since hopefully they're the same!)
-        for( int session=0; ; ++session )
-        {
-            sprintf( path, "SessionInfo:Sessions:SessionNum:{%d}SessionName:", session );
-            if( !parseYamlStr( sessionYaml, path, sessionNameStr ) )
-                break;
+    // Every per-car array read in one go, then four cars at a time without branches
+    const auto& carIdxLap          = irv_CarIdxLap.all();
+    const auto& carIdxLapCompleted = irv_CarIdxLapCompleted.all();
+    const auto& carIdxOnPitRoad    = irv_CarIdxOnPitRoad.all();
+    const auto& carIdxPosition     = irv_CarIdxPosition.all();
+    const auto& carIdxTrackSurface = irv_CarIdxTrackSurface.all();
+    const auto& carIdxBestLapTime  = irv_CarIdxBestLapTime.all();
+    const int   sessionState       = irv_SessionState.get();
+    const float now                = (float)irv_SessionTime.get();
+
+    // Track cars in pits. Reset every time we're in the 'warmup' phase (just before starting pace laps),
+    // or when the clock starts over. Session state is checked to work around getting garbage sometimes (?).
+    const bool reset = sessionState == irsdk_StateWarmup || now < t.sessionTime;
+    const bool trackPits = sessionState >= 0;
+    t.sessionTime = now;
+
+    unsigned long long inWorldMask = 0;
+    unsigned long long onPitRoadMask = 0;
+    unsigned long long inPitStallMask = 0;
+
+#ifdef IR_CARTABLE_SSE2
+    const __m128i zero      = _mm_setzero_si128();
+    const __m128i laneBit   = _mm_setr_epi32( 1, 2, 4, 8 );
+    const __m128i keep      = _mm_set1_epi32( reset ? 0 : -1 );
+    const __m128i track     = _mm_set1_epi32( trackPits ? -1 : 0 );
+    const __m128i notInWorld = _mm_set1_epi32( irsdk_NotInWorld );
+    const __m128i inStall   = _mm_set1_epi32( irsdk_InPitStall );
+    const __m128  nowPs     = _mm_set1_ps( now );
+    const __m128  keepPs    = _mm_castsi128_ps( keep );
+
+    // m ? a : b
+    auto sel = []( __m128i m, __m128i a, __m128i b ) { return _mm_or_si128( _mm_and_si128(m, a), _mm_andnot_si128(m, b) ); };
+    auto selPs = []( __m128i m, __m128 a, __m128 b ) { const __m128 mm = _mm_castsi128_ps(m); return _mm_or_ps( _mm_and_ps(mm, a), _mm_andnot_ps(mm, b) ); };
+
+    for( int i=0; i<IR_MAX_CARS; i+=4 )
+    {
+        // Telemetry isn't aligned, the table is
+        const __m128i lap     = _mm_loadu_si128( (const __m128i*)&carIdxLap[i] );
+        const __m128i lapDone = _mm_loadu_si128( (const __m128i*)&carIdxLapCompleted[i] );
+        const __m128i pos     = _mm_loadu_si128( (const __m128i*)&carIdxPosition[i] );
+        const __m128i surface = _mm_loadu_si128( (const __m128i*)&carIdxTrackSurface[i] );
+
+        // Four bools to four lanes of 0/-1
+        int pitBytes;
+        memcpy( &pitBytes, &carIdxOnPitRoad[i], sizeof(pitBytes) );
+        const __m128i pitRoad = _mm_unpacklo_epi16( _mm_unpacklo_epi8(_mm_cvtsi32_si128(pitBytes), zero), zero );
+
+        const __m128i onPit    = _mm_andnot_si128( _mm_cmpeq_epi32(pitRoad, zero), track );
+        const __m128i prevBits = _mm_and_si128( _mm_set1_epi32((int)(t.onPitRoadMask >> i)), laneBit );
+        const __m128i wasOnPit = _mm_and_si128( _mm_cmpeq_epi32(prevBits, laneBit), keep );
+        const __m128i entered  = _mm_andnot_si128( wasOnPit, onPit );
+        const __m128i exited   = _mm_andnot_si128( onPit, wasOnPit );
+
+        _mm_store_si128( (__m128i*)&t.lapCount[i], sel(_mm_cmpgt_epi32(lap, lapDone), lap, lapDone) );
+        _mm_store_si128( (__m128i*)&t.position[i], sel(_mm_cmpgt_epi32(pos, zero), pos, _mm_load_si128((const __m128i*)&t.sessionPosition[i])) );
+
+        const __m128i lastLap = sel( onPit, lap, _mm_and_si128(_mm_load_si128((const __m128i*)&t.lastLapInPits[i]), keep) );
+        _mm_store_si128( (__m128i*)&t.lastLapInPits[i], lastLap );
+        _mm_store_si128( (__m128i*)&t.pitAge[i], _mm_sub_epi32(lap, lastLap) );
+
+        const __m128 entry = selPs( entered, nowPs, _mm_and_ps(_mm_load_ps(&t.pitEntryTime[i]), keepPs) );
+        const __m128 exit  = selPs( exited, nowPs, _mm_and_ps(_mm_load_ps(&t.pitExitTime[i]), keepPs) );
+        const __m128 inPit = selPs( _mm_or_si128(onPit, exited), _mm_sub_ps(nowPs, entry), _mm_and_ps(_mm_load_ps(&t.timeInPits[i]), keepPs) );
+        _mm_store_ps( &t.pitEntryTime[i], entry );
+        _mm_store_ps( &t.pitExitTime[i], exit );
+        _mm_store_ps( &t.timeInPits[i], inPit );
+        _mm_store_ps( &t.stintTime[i], _mm_andnot_ps(_mm_castsi128_ps(onPit), _mm_sub_ps(nowPs, exit)) );
+
+        inWorldMask    |= (unsigned long long)(~_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(surface, notInWorld))) & 0xF) << i;
+        onPitRoadMask  |= (unsigned long long)_mm_movemask_ps( _mm_castsi128_ps(onPit) ) << i;
+        inPitStallMask |= (unsigned long long)_mm_movemask_ps( _mm_castsi128_ps(_mm_cmpeq_epi32(surface, inStall)) ) << i;
+    }
+#else
+    for( int i=0; i<IR_MAX_CARS; ++i )
+    {
+        const int  lap      = carIdxLap[i];
+        const bool onPit    = trackPits && carIdxOnPitRoad[i];
+        const bool wasOnPit = !reset && t.isOnPitRoad(i);
+        const bool entered  = onPit && !wasOnPit;
+        const bool exited   = !onPit && wasOnPit;
+
+        t.lapCount[i]      = std::max( lap, carIdxLapCompleted[i] );
+        t.position[i]      = carIdxPosition[i] > 0 ? carIdxPosition[i] : t.sessionPosition[i];
+        t.lastLapInPits[i] = onPit ? lap : reset ? 0 : t.lastLapInPits[i];
+        t.pitAge[i]        = lap - t.lastLapInPits[i];
+
+        t.pitEntryTime[i]  = entered ? now : reset ? 0 : t.pitEntryTime[i];
+        t.pitExitTime[i]   = exited ? now : reset ? 0 : t.pitExitTime[i];
+        t.timeInPits[i]    = onPit || exited ? now - t.pitEntryTime[i] : reset ? 0 : t.timeInPits[i];
+        t.stintTime[i]     = onPit ? 0 : now - t.pitExitTime[i];
+
+        inWorldMask    |= (unsigned long long)(carIdxTrackSurface[i] != irsdk_NotInWorld) << i;
+        onPitRoadMask  |= (unsigned long long)onPit << i;
+        inPitStallMask |= (unsigned long long)(carIdxTrackSurface[i] == irsdk_InPitStall) << i;
+    }
+#endif
 
-            std::string str;
-            sprintf( path, "SessionInfo:Sessions:SessionNum:{%d}SessionTime:", session );
-            parseYamlStr( sessionYaml, path, str );
-            ir_session.isUnlimitedTime = int( str=="unlimited" );
+    t.inWorldMask = inWorldMask;
+    t.onPitRoadMask = onPitRoadMask;
+    t.inPitStallMask = inPitStallMask;
 
-            sprintf( path, "SessionInfo:Sessions:SessionNum:{%d}SessionLaps:", session );
-            parseYamlStr( sessionYaml, path, str );
-            ir_session.isUnlimitedLaps = int( str=="unlimited" );
+    // Best laps, and who leads and is fastest overall and in each class. Overlays read these
+    // instead of each going over all cars every frame. This is a full pass on every tick,
+    // positions and best laps come from telemetry and any of them may have changed.
+    const bool useQualTime = ir_session->sessionType==SessionType::RACE && sessionState<=irsdk_StateWarmup;
+    const bool useQualTimeIfNone = ir_session->sessionType==SessionType::QUALIFY;
 
-            for( int pos=1; pos<IR_MAX_CARS+1; ++pos )
-            {
-                int carIdx = -1;
-                sprintf( path, "SessionInfo:Sessions:SessionNum:{%d}ResultsPositions:Position:{%d}CarIdx:", session, pos );
-                if( parseYamlInt( sessionYaml, path, &carIdx ) )
-                {
-                    if( sessionNameStr == "PRACTICE" )
-                        ir_session.cars[carIdx].practicePosition = pos;
-                    else if( sessionNameStr == "QUALIFY" )
-                        ir_session.cars[carIdx].qualPosition = pos;
-                    else if( sessionNameStr == "RACE" )
-                        ir_session.cars[carIdx].racePosition = pos;
-                }
-            }
-        }
+    t.leaderIdx = -1;
+    t.fastestIdx = -1;
+    for( int i=0; i<IR_MAX_CLASSES; ++i )
+        t.classLeaderIdx[i] = t.classFastestIdx[i] = -1;
 
-        // SoF
-        double sof = 0;
-        int cnt = 0;
-        for( int i=0; i<IR_MAX_CARS; ++i )
-        {
-            const Car& car = ir_session.cars[i];
+    for( int i=0; i<IR_MAX_CARS; ++i )
+    {
+        float best = carIdxBestLapTime[i];
+        if( useQualTime || (useQualTimeIfNone && best<=0) )
+            best = t.qualTime[i];
+        t.bestLapTime[i] = best;
+
+        if( !t.isValid(i) )
+            continue;
+
+        const int pos = t.position[i];
+        const int cls = t.classIdx[i];
+        if( pos > 0 && (t.leaderIdx < 0 || pos < t.position[t.leaderIdx]) )
+            t.leaderIdx = i;
+        if( best > 0 && (t.fastestIdx < 0 || best < t.bestLapTime[t.fastestIdx]) )
+            t.fastestIdx = i;
+
+        if( cls < 0 )
+            continue;
+        int& clsLeader = t.classLeaderIdx[cls];
+        int& clsFastest = t.classFastestIdx[cls];
+        if( pos > 0 && (clsLeader < 0 || pos < t.position[clsLeader]) )
+            clsLeader = i;
+        if( best > 0 && (clsFastest < 0 || best < t.bestLapTime[clsFastest]) )
+            clsFastest = i;
+    }
+}
 
-            if( car.isPaceCar || car.isSpectator || car.userName.empty() )
-                continue;
+ConnectionStatus ir_tick()
+{
+    irsdkClient& irsdk = irsdkClient::instance();
+
+    bool sessionUpdated;
+    if( s_acquisition.isRunning() )
+    {
+        pickUpSnapshot();
 
-            sof += car.irating;
-            cnt++;
+        // The snapshot says which session string generation it was taken with
+        sessionUpdated = s_snapshot && s_snapshot->line && (s_snapshot->sessionCt != s_parsedSessionCt || s_snapshot->statusID != s_parsedStatusID);
+        if( sessionUpdated )
+        {
+            s_parsedSessionCt = s_snapshot->sessionCt;
+            s_parsedStatusID = s_snapshot->statusID;
         }
-        ir_session.sof = int(sof / cnt);
+    }
+    else
+    {
+        irsdk.waitForData(16);
+        sessionUpdated = irsdk.wasSessionStrUpdated();
+    }
 
-        ir_handleConfigChange();
+    // Latest decoded session, it stays put until the next ir_tick()
+    ir_session = s_sessionDecoder.pin();
 
-    } // if session string updated
+    if( !irsdk.isConnected() )
+        return ConnectionStatus::DISCONNECTED;
 
-    // Track cars in pits. Reset every time we're in the 'warmup' phase (just before starting pace laps).
-    const bool resetPitAge = ir_SessionState.getInt() == irsdk_StateWarmup;
-    for( int carIdx=0; carIdx<IR_MAX_CARS; ++carIdx )
+    // Every line's samples, including those of snapshots we skipped
+    if( !s_acquisition.isRunning() )
+        ir_samples.capture();
+    ir_samples.update();
+
+    if( sessionUpdated )
     {
-        Car& car = ir_session.cars[carIdx];
-        if( resetPitAge )
-            car.lastLapInPits = 0;
-        if( ir_SessionState.getInt() >= 0 /* work around getting garbage sometimes (?) */ && ir_CarIdxOnPitRoad.getBool(carIdx) )
-            car.lastLapInPits = ir_CarIdxLap.getInt(carIdx);
+        // The snapshot's own copy, the live string may already be a newer one
+        const char* sessionYaml = s_acquisition.isRunning() ? s_snapshot->sessionStr : irsdk.getSessionStr();
+#ifdef _DEBUG
+        //printf("%s\n", sessionYaml);
+        FILE* fp = fopen("sessionYaml.txt","ab");
+        fprintf(fp,"\n\n==== NEW SESSION STRING ======================================\n");
+        fprintf(fp,"%s",sessionYaml);
+        fclose(fp);
+#endif
+
+        // Decoded on the session decoder thread, shows up in ir_session in a later ir_tick()
+        s_sessionDecoder.post( sessionYaml, ir_SessionNum.getInt() );
     }
 
+    updateCarTable();
+
     // Check for both ir_IsOnTrack and ir_IsOnTrackCar, because I've seen iRacing report true for ir_IsOnTrack 
     // (for just a short time) even when we're not in the car in a practice session. Checking both does seem
     // to address that.
@@ -566,13 +779,15 @@ ConnectionStatus ir_tick()
 
 void ir_handleConfigChange()
 {
+    irsdkClient::instance().setPartialCopy( g_cfg.getBool("General", "partial_telemetry_copy", false) );
+
     // TODO
     /*std::vector<std::string> buddies = g_cfg.getStringVec("General", "buddies", {});
     std::vector<std::string> flagged = g_cfg.getStringVec( "General", "flagged", {} );
 
     for( int carIdx=0; carIdx<IR_MAX_CARS; ++carIdx )
     {
-        Car& car = ir_session.cars[carIdx];
+        Car& car = ir_session->cars[carIdx];
 
         car.isBuddy = 0;
         for( const std::string& name : buddies ) {
@@ -602,45 +817,39 @@ float ir_estimateLaptime()
     float best = ir_LapBestLapTime.getFloat();
     if( best > 0 )
         return best;
-    return ir_session.cars[ir_session.driverCarIdx].carClassEstLapTime;
+    return ir_session->cars[ir_session->driverCarIdx].carClassEstLapTime;
 }
 
 int ir_getPosition( int carIdx )
 {
-    // Try the different sources we have for position data, in descending order of importance
-    int pos = ir_CarIdxPosition.getInt(carIdx);
-    if( pos > 0 )
-        return pos;
-
-    pos = ir_session.cars[carIdx].racePosition;
-    if( pos > 0 )
-        return pos;
-
-    pos = ir_session.cars[carIdx].qualPosition;
-    if( pos > 0 )
-        return pos;
-
-    pos = ir_session.cars[carIdx].practicePosition;
-    if( pos > 0 )
-        return pos;
+    // Telemetry first, then the session string, see updateCarTable()
+    return s_cars.position[carIdx];
+}
 
-    return 0;
+int ir_getLastLapInPits( int carIdx )
+{
+    return s_cars.lastLapInPits[carIdx];
 }
 
 int ir_getLapDeltaToLeader( int carIdx, int ldrIdx )
 {
-    if( ir_session.sessionType!=SessionType::RACE || ir_isPreStart() || carIdx < 0 || ldrIdx < 0 )
+    if( ir_session->sessionType!=SessionType::RACE || ir_isPreStart() || carIdx < 0 || ldrIdx < 0 )
         return 0;
 
-    const int carLapCount = std::max( ir_CarIdxLap.getInt(carIdx), ir_CarIdxLapCompleted.getInt(carIdx) );
-    const int ldrLapCount = std::max( ir_CarIdxLap.getInt(ldrIdx), ir_CarIdxLapCompleted.getInt(ldrIdx) );
+    const int carLapCount = std::max( irv_CarIdxLap[carIdx], irv_CarIdxLapCompleted[carIdx] );
+    const int ldrLapCount = std::max( irv_CarIdxLap[ldrIdx], irv_CarIdxLapCompleted[ldrIdx] );
 
    // if( carLapCount < 0 )
      //   return ir_CarIdxLapCompleted.getInt(carIdx) - ir_CarIdxLapCompleted.getInt(ldrIdx);
 
-    const float carPctAroundLap = ir_CarIdxLapDistPct.getFloat( carIdx );
-    const float ldrPctAroundLap = ir_CarIdxLapDistPct.getFloat( ldrIdx );
+    const float carPctAroundLap = irv_CarIdxLapDistPct[carIdx];
+    const float ldrPctAroundLap = irv_CarIdxLapDistPct[ldrIdx];
 
+    return ir_computeLapDelta( carLapCount, carPctAroundLap, ldrLapCount, ldrPctAroundLap );
+}
+
+int ir_computeLapDelta( int carLapCount, float carPctAroundLap, int ldrLapCount, float ldrPctAroundLap )
+{
     if( carPctAroundLap < 0 || ldrPctAroundLap < 0 )
         return 0;
 
@@ -654,15 +863,15 @@ int ir_getLapDeltaToLeader( int carIdx, int ldrIdx )
 
 void ir_printVariables()
 {
-    if( !irsdk_isConnected() )
-        return;
+    irsdkClient& irsdk = irsdkClient::instance();
 
-    const irsdk_header* header = irsdk_getHeader();
+    if( !irsdk.isConnected() )
+        return;
 
     printf("IRSDK Variables:\n");
-    for( int i=0; i<header->numVars; ++i )
+    for( int i=0; i<irsdk.getNumVars(); ++i )
     {
-        const irsdk_varHeader* var = irsdk_getVarHeaderEntry(i);
+        const irsdk_varHeader* var = irsdk.getVarHeaderEntry(i);
         std::string type;
         switch( var->type )
         {
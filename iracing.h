@@ -26,11 +26,14 @@ SOFTWARE.
 
 #include "irsdk/irsdk_defines.h"
 #include "irsdk/irsdk_client.h"
+#include "irsdk/irsdk_var.h"
+#include "irsdk/irsdk_samplestream.h"
+#include "irsdk/irsdk_acquisition.h"
 #include "irsdk/yaml_parser.h"
+#include "irsdk/irsdk_yamltree.h"
 #include <string>
 #include "util.h"
-
-#define IR_MAX_CARS 64
+#include "SessionDecode.h"
 
 enum class ConnectionStatus
 {
@@ -41,59 +44,26 @@ enum class ConnectionStatus
 };
 static const char* const ConnectionStatusStr[] = {"UNKNOWN","DISCONNECTED","CONNECTED","DRIVING"};
 
-enum class SessionType
-{
-    UNKNOWN = 0,
-    PRACTICE,
-    QUALIFY,
-    RACE
-};
-static const char* const SessionTypeStr[] = {"UNKNOWN","PRACTICE","QUALIFY","RACE"};
-
-struct Car
-{    
-    std::string     userName;
-    int             carNumber = 0;
-    std::string     carNumberStr;
-    std::string     licenseStr;
-    char            licenseChar = 'R';
-    float           licenseSR = 0;
-    std::string     licenseColStr;
-    float4          licenseCol = float4(0,0,0,1);
-    int             irating = 0;
-    int             isSelf = 0;
-    int             isPaceCar = 0;
-    int             isSpectator = 0;
-    int             isBuddy = 0;
-    int             isFlagged = 0;
-    int             incidentCount = 0;
-    float           carClassEstLapTime = 0;
-    int             practicePosition = 0;
-    int             qualPosition = 0;
-    float           qualTime = 0;
-    int             racePosition = 0;
-    int             lastLapInPits = 0;
-};
-
-struct Session
+// Channels of ir_samples, in the order of SampleChannelVar
+enum class SampleChannel
 {
-    SessionType     sessionType = SessionType::UNKNOWN;
-    Car             cars[IR_MAX_CARS];
-    int             driverCarIdx = -1;
-    int             sof = 0;
-    int             subsessionId = 0;
-    int             seriesId = 0;
-    int             isFixedSetup = 0;
-    int             isUnlimitedTime = 0;
-    int             isUnlimitedLaps = 0;
-    float           fuelMaxLtr = 0;
-    float           rpmIdle = 0;
-    float           rpmRedline = 0;
-    float           rpmSLFirst = 0;
-    float           rpmSLShift = 0;
-    float           rpmSLLast = 0;
-    float           rpmSLBlink = 0;
+    SteeringWheelTorque = 0,
+    LatAccel,
+    LongAccel,
+    VertAccel,
+    VelocityX,
+    VelocityY,
+    VelocityZ,
+    YawRate,
+    PitchRate,
+    RollRate,
+    LFshockVel,
+    RFshockVel,
+    LRshockVel,
+    RRshockVel,
+    COUNT
 };
+static const char* const SampleChannelVar[] = {"SteeringWheelTorque_ST","LatAccel_ST","LongAccel_ST","VertAccel_ST","VelocityX_ST","VelocityY_ST","VelocityZ_ST","YawRate_ST","PitchRate_ST","RollRate_ST","LFSHshockVel_ST","RFSHshockVel_ST","LRSHshockVel_ST","RRSHshockVel_ST"};
 
 extern irsdkCVar ir_SessionTime;    // double[1] Seconds since session start (s)
 extern irsdkCVar ir_SessionTick;    // int[1] Current update number ()
@@ -386,12 +356,108 @@ extern irsdkCVar ir_LFSHshockDefl_ST;    // float[6] LFSH shock deflection at 36
 extern irsdkCVar ir_LFSHshockVel;    // float[1] LFSH shock velocity (m/s)
 extern irsdkCVar ir_LFSHshockVel_ST;    // float[6] LFSH shock velocity at 360 Hz (m/s)
 
-extern Session ir_session;
+// Typed handles for vars read per car per frame, see irsdkVar.
+extern irsdkVar<int,IR_MAX_CARS>   irv_CarIdxLap;
+extern irsdkVar<int,IR_MAX_CARS>   irv_CarIdxLapCompleted;
+extern irsdkVar<float,IR_MAX_CARS> irv_CarIdxLapDistPct;
+extern irsdkVar<int,IR_MAX_CARS>   irv_CarIdxTrackSurface;
+extern irsdkVar<bool,IR_MAX_CARS>  irv_CarIdxOnPitRoad;
+extern irsdkVar<int,IR_MAX_CARS>   irv_CarIdxPosition;
+extern irsdkVar<int,IR_MAX_CARS>   irv_CarIdxClassPosition;
+extern irsdkVar<float,IR_MAX_CARS> irv_CarIdxF2Time;
+extern irsdkVar<float,IR_MAX_CARS> irv_CarIdxLastLapTime;
+extern irsdkVar<float,IR_MAX_CARS> irv_CarIdxBestLapTime;
+extern irsdkVar<int>               irv_SessionState;
+extern irsdkVar<double>            irv_SessionTime;
+
+// The latest decoded session string. Sessions are immutable once published, and ir_tick()
+// swaps in a new one when the session decoder thread has finished with an update.
+// Valid until the next ir_tick().
+extern const Session* ir_session;
+
+// The _ST vars unpacked into individual 360 Hz samples, see irsdkSampleStream.
+// Indexed by (int)SampleChannel, kept up to date by ir_tick().
+extern irsdkSampleStream ir_samples;
 
 // Keep the session data updated.
 // Will block for around 16 milliseconds.
 ConnectionStatus ir_tick();
 
+// Read telemetry on a thread of its own. ir_tick() then picks up the latest
+// snapshot of it instead of reading the sim itself, and all irsdkCVar/irsdkVar
+// reads on the calling thread see that snapshot until the next ir_tick().
+void ir_startAcquisition();
+void ir_stopAcquisition();
+
+// How old the telemetry was by the time ir_tick() picked it up.
+struct TelemetryStaleness
+{
+    long long   ticks = 0;          // ir_tick() calls that picked up a new snapshot
+    long long   skipped = 0;        // snapshots that were replaced before anyone picked them up
+    float       lastAgeMs = 0;
+    float       avgAgeMs = 0;       // moving average over roughly a second
+    float       maxAgeMs = 0;
+};
+const TelemetryStaleness& ir_getStaleness();
+
+// How much of the last session string update ir_tick() had to decode, see SessionDecodeStats.
+SessionDecodeStats ir_getSessionDecodeStats();
+
+// Wait for pending session string updates to be decoded and pick up the result.
+void ir_syncSession();
+
+// Per-car state that per-frame loops go over, kept up to date by ir_tick(). One array per
+// field, indexed by carIdx like the CarIdx* telemetry, so a pass over all cars only
+// touches the fields it needs and not the rest of ir_session->cars[].
+//
+// Pit tracking starts over when the session enters the warmup phase (just before the pace
+// laps) and when SessionTime goes backwards. Times are SessionTime, 0 for "not yet".
+struct CarTable
+{
+    unsigned long long  validMask = 0;                      // bit carIdx for cars that have a driver and aren't the pace car or spectating
+    unsigned long long  inWorldMask = 0;                    // CarIdxTrackSurface isn't irsdk_NotInWorld
+    unsigned long long  onPitRoadMask = 0;                  // between the pit road cones
+    unsigned long long  inPitStallMask = 0;
+    float               sessionTime = 0;                    // of the last update
+    int                 leaderIdx = -1;                     // valid car with the best position
+    int                 fastestIdx = -1;                    // valid car with the best bestLapTime
+    int                 classLeaderIdx[IR_MAX_CLASSES];     // same per class, by index into ir_session->classes
+    int                 classFastestIdx[IR_MAX_CLASSES];
+    alignas(64) int     position[IR_MAX_CARS] = {};         // see ir_getPosition()
+    alignas(64) int     sessionPosition[IR_MAX_CARS] = {};  // from the session string only, race before qual before practice
+    alignas(64) int     lapCount[IR_MAX_CARS] = {};         // max(CarIdxLap, CarIdxLapCompleted)
+    alignas(64) int     lastLapInPits[IR_MAX_CARS] = {};    // see ir_getLastLapInPits()
+    alignas(64) int     pitAge[IR_MAX_CARS] = {};           // laps since lastLapInPits, i.e. stint length in laps
+    alignas(64) float   pitEntryTime[IR_MAX_CARS] = {};     // last time the car entered pit road
+    alignas(64) float   pitExitTime[IR_MAX_CARS] = {};      // ...and left it
+    alignas(64) float   timeInPits[IR_MAX_CARS] = {};       // on pit road so far, or on the last visit once back out
+    alignas(64) float   stintTime[IR_MAX_CARS] = {};        // since pitExitTime, 0 while on pit road
+    alignas(64) float   qualTime[IR_MAX_CARS] = {};
+    alignas(64) float   bestLapTime[IR_MAX_CARS] = {};      // CarIdxBestLapTime, or qualTime before the race start and while qualifying without a lap
+    alignas(64) int     classIdx[IR_MAX_CARS] = {};         // Car::classIdx
+
+    CarTable()
+    {
+        for( int i=0; i<IR_MAX_CLASSES; ++i )
+            classLeaderIdx[i] = classFastestIdx[i] = -1;
+    }
+
+    bool isValid( int carIdx ) const { return (validMask >> carIdx) & 1; }
+    bool isOnPitRoad( int carIdx ) const { return (onPitRoadMask >> carIdx) & 1; }
+};
+extern const CarTable& ir_cars;
+
+// Lap on which the car was last seen on pit road, 0 if it hasn't been since the start.
+int ir_getLastLapInPits( int carIdx );
+
+// Tick count of the line ir_tick() is working on, and when that tick was first seen
+// (QueryPerformanceCounter). lineTime is 0 when there is no line.
+void ir_getLineTiming( int* tickCount, long long* lineTime );
+
+// Whether a replayed file has run out of records, as of the line ir_tick() is working on.
+bool ir_isFileFinished();
+irsdkAcquisition::Stats ir_getAcquisitionStats();
+
 // Let the session data tracking know that the config has changed.
 void ir_handleConfigChange();
 
@@ -402,11 +468,14 @@ bool ir_isPreStart();
 // Estimate time for a full lap.
 float ir_estimateLaptime();
 
-// Get the best known position, from the latest session we can find.
+// Get the best known position, from the latest session we can find, as of the last ir_tick().
 int ir_getPosition( int carIdx );
 
 // Get lap delta to P0 car if available.
 int ir_getLapDeltaToLeader( int carIdx, int ldrIdx );
 
+// Lap delta from raw lap counts and track positions, so it can also run on recorded data.
+int ir_computeLapDelta( int carLapCount, float carPctAroundLap, int ldrLapCount, float ldrPctAroundLap );
+
 // Print all the variables the sim supports.
 void ir_printVariables();
@@ -0,0 +1,258 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <windows.h>
+#include <string.h>
+#include <algorithm>
+#include "irsdk_defines.h"
+#include "irsdk_client.h"
+#include "irsdk_samplestream.h"
+#include "irsdk_acquisition.h"
+
+irsdkAcquisition::irsdkAcquisition()
+	: m_sessionCt(-1)
+	, m_sessionStatusID(-1)
+	, m_latest(-1)
+	, m_publishedSeq(0)
+	, m_stop(false)
+	, m_timeoutMS(16)
+	, m_stats()
+{
+	for(Slot &slot : m_slots)
+	{
+		memset(&slot.snap, 0, sizeof(slot.snap));
+		slot.varStatusID = -1;
+		slot.refs = 0;
+	}
+}
+
+irsdkAcquisition::~irsdkAcquisition()
+{
+	stop();
+}
+
+void irsdkAcquisition::addSampleStream(irsdkSampleStream *stream)
+{
+	if(!isRunning() && std::find(m_sampleStreams.begin(), m_sampleStreams.end(), stream) == m_sampleStreams.end())
+		m_sampleStreams.push_back(stream);
+}
+
+bool irsdkAcquisition::start(int timeoutMS)
+{
+	if(isRunning())
+		return false;
+
+	m_timeoutMS = timeoutMS;
+	m_stop = false;
+	m_thread = std::thread(&irsdkAcquisition::run, this);
+	return true;
+}
+
+void irsdkAcquisition::stop()
+{
+	if(!isRunning())
+		return;
+
+	m_stop = true;
+	m_thread.join();
+	m_waitCond.notify_all();
+}
+
+void irsdkAcquisition::run()
+{
+	irsdkClient &client = irsdkClient::instance();
+	bool wasConnected = false;
+
+	while(!m_stop)
+	{
+		const bool gotData = client.waitForData(m_timeoutMS);
+		const bool connected = client.isConnected();
+
+		if(gotData && connected)
+		{
+			for(irsdkSampleStream *stream : m_sampleStreams)
+				stream->capture();
+		}
+
+		// readers need to see disconnects too, not just new lines
+		if(gotData || connected != wasConnected)
+			publish(gotData && connected);
+		wasConnected = connected;
+	}
+}
+
+void irsdkAcquisition::publish(bool connected)
+{
+	irsdkClient &client = irsdkClient::instance();
+	const int latest = m_latest.load();
+
+	// any slot that isn't the latest and that nobody holds
+	int idx = -1;
+	for(int i=0; i<numSlots && idx<0; i++)
+	{
+		if(i != latest && m_slots[i].refs.load() == 0)
+			idx = i;
+	}
+
+	std::unique_lock<std::mutex> lock(m_statsMutex);
+	if(connected)
+		m_stats.lines++;
+	if(idx < 0)
+	{
+		m_stats.overruns++;
+		return;
+	}
+	lock.unlock();
+
+	LARGE_INTEGER freq, start, end;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&start);
+
+	Slot &slot = m_slots[idx];
+	irsdkSnapshot &snap = slot.snap;
+	const irsdk_header *header = client.getHeader();
+	if(connected && header && client.getLine())
+	{
+		if((int)slot.buf.size() < header->bufLen)
+			slot.buf.resize(header->bufLen);
+		memcpy(slot.buf.data(), client.getLine(), header->bufLen);
+
+		// The var headers only change with the connection, so each slot copies them once
+		// per connection.  Readers bind against these, never against the live table,
+		// which may already describe a different layout than this line.
+		const int numVars = client.getNumVars();
+		if(slot.varStatusID != client.getStatusID() || snap.numVars != numVars)
+		{
+			slot.varBuf.resize((size_t)numVars * sizeof(irsdk_varHeader));
+			irsdk_varHeader *vars = (irsdk_varHeader *)slot.varBuf.data();
+			for(int i=0; i<numVars; i++)
+			{
+				const irsdk_varHeader *vh = client.getVarHeaderEntry(i);
+				if(vh)
+					vars[i] = *vh;
+				else
+					vars[i].clear();
+			}
+			slot.varStatusID = client.getStatusID();
+		}
+
+		snap.line = slot.buf.data();
+		snap.lineLen = header->bufLen;
+		snap.varHeaders = (const irsdk_varHeader *)slot.varBuf.data();
+		snap.numVars = numVars;
+		// The live string can be rewritten by the sim at any time, so readers get a copy
+		// that stays put for as long as they hold the snapshot.  Reading the generation
+		// first means a string that changes in between is copied again next time.
+		const int sessionCt = client.getSessionCt();
+		if(!m_sessionStr || m_sessionCt != sessionCt || m_sessionStatusID != client.getStatusID())
+		{
+			const char *str = client.getSessionStr();
+			m_sessionStr = std::make_shared<const std::string>(str ? str : "");
+			m_sessionCt = sessionCt;
+			m_sessionStatusID = client.getStatusID();
+		}
+		slot.sessionStr = m_sessionStr;
+
+		snap.sessionCt = sessionCt;
+		snap.sessionStr = slot.sessionStr->c_str();
+		snap.tickCount = client.getLineTickCount();
+		snap.lineTime = client.getLineTime();
+	}
+	else
+	{
+		snap.line = NULL;
+		snap.lineLen = 0;
+		snap.varHeaders = NULL;
+		snap.numVars = 0;
+		snap.sessionCt = -1;
+		snap.sessionStr = NULL;
+		snap.tickCount = 0;
+		snap.lineTime = 0;
+		slot.sessionStr.reset();
+	}
+	snap.fileFinished = client.isFileFinished();
+	snap.statusID = client.getStatusID();
+	snap.seq = m_publishedSeq.load() + 1;
+
+	QueryPerformanceCounter(&end);
+	snap.publishTime = end.QuadPart;
+
+	// readers pick this up from here on
+	m_latest.store(idx);
+	m_publishedSeq.store(snap.seq);
+
+	{
+		std::lock_guard<std::mutex> waitLock(m_waitMutex);
+	}
+	m_waitCond.notify_all();
+
+	lock.lock();
+	m_stats.published++;
+	m_stats.maxCopyUs = std::max(m_stats.maxCopyUs, (double)(end.QuadPart - start.QuadPart) * 1000000.0 / freq.QuadPart);
+}
+
+const irsdkSnapshot *irsdkAcquisition::acquire()
+{
+	for(;;)
+	{
+		const int idx = m_latest.load();
+		if(idx < 0)
+			return NULL;
+
+		// Pin it, then make sure it is still the latest.  If it isn't the producer
+		// may have picked it before our pin became visible, so try again.  Both
+		// sides use sequentially consistent accesses to make this work.
+		m_slots[idx].refs.fetch_add(1);
+		if(m_latest.load() == idx)
+			return &m_slots[idx].snap;
+		m_slots[idx].refs.fetch_sub(1);
+	}
+}
+
+void irsdkAcquisition::release(const irsdkSnapshot *snap)
+{
+	if(!snap)
+		return;
+
+	for(Slot &slot : m_slots)
+	{
+		if(&slot.snap == snap)
+		{
+			slot.refs.fetch_sub(1);
+			return;
+		}
+	}
+}
+
+bool irsdkAcquisition::waitForNewer(long long seq, int timeoutMS)
+{
+	std::unique_lock<std::mutex> lock(m_waitMutex);
+	return m_waitCond.wait_for(lock, std::chrono::milliseconds(timeoutMS), [&] { return m_publishedSeq.load() > seq || m_stop.load(); }) && m_publishedSeq.load() > seq;
+}
+
+irsdkAcquisition::Stats irsdkAcquisition::getStats() const
+{
+	std::lock_guard<std::mutex> lock(m_statsMutex);
+	return m_stats;
+}
@@ -0,0 +1,141 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef IRSDK_ACQUISITION_H
+#define IRSDK_ACQUISITION_H
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <memory>
+#include <string>
+
+struct irsdk_varHeader;
+class irsdkSampleStream;
+
+// One line of telemetry as it was when the acquisition thread read it.
+// Immutable while held, see irsdkAcquisition::acquire().
+struct irsdkSnapshot
+{
+	const char *line;		// copy of the line, NULL when not connected
+	int lineLen;
+	const irsdk_varHeader *varHeaders;	// the var headers the line is laid out by
+	int numVars;
+	int statusID;			// irsdkClient::getStatusID() at the time
+	int sessionCt;			// session string generation, irsdkClient::getSessionCt()
+	const char *sessionStr;	// copy of the session string of that generation, NULL when not connected
+	int tickCount;			// irsdkClient::getLineTickCount()
+	long long lineTime;		// irsdkClient::getLineTime(), when the line was first seen
+	bool fileFinished;		// irsdkClient::isFileFinished()
+	long long seq;			// counts published snapshots, starting at 1
+	long long publishTime;	// QueryPerformanceCounter() when published
+};
+
+// Runs irsdkClient::waitForData() on its own thread and hands every new line to the
+// rest of the program as an irsdkSnapshot.
+//
+// Snapshots live in a small set of slots.  The producer only ever writes to a slot
+// that is neither the latest one nor held by a reader, and readers pin a slot with a
+// reference count, so neither side ever waits on the other: a slow reader just skips
+// ahead to whatever is latest, and the producer never blocks on a reader.  This holds
+// as long as fewer than numSlots-1 snapshots are held at once; if every slot is busy
+// the line is dropped and counted in Stats::overruns.
+//
+// Readers usually pair acquire() with irsdkClient::setThreadView() so irsdkCVar and
+// irsdkVar read from the snapshot.  Anything that needs every line rather than the
+// latest one, like the sub-tick samples, is captured on the acquisition thread.
+class irsdkAcquisition
+{
+public:
+	irsdkAcquisition();
+	~irsdkAcquisition();
+
+	// streams to capture() every line into; add them before start()
+	void addSampleStream(irsdkSampleStream *stream);
+
+	bool start(int timeoutMS = 16);
+	void stop();
+	bool isRunning() const { return m_thread.joinable(); }
+
+	// Pin the latest snapshot, NULL if nothing was published yet. Every non NULL
+	// result has to go back through release().
+	const irsdkSnapshot *acquire();
+	void release(const irsdkSnapshot *snap);
+
+	// block until a snapshot newer than seq is published, or the timeout expires
+	bool waitForNewer(long long seq, int timeoutMS);
+
+	long long getLatestSeq() const { return m_publishedSeq.load(); }
+
+	struct Stats
+	{
+		long long lines;		// lines read by waitForData()
+		long long published;	// snapshots published (lines plus connection changes)
+		long long overruns;		// lines dropped because every slot was held
+		double maxCopyUs;		// slowest line copy into a slot
+	};
+	Stats getStats() const;
+
+protected:
+	static const int numSlots = 8;
+
+	struct Slot
+	{
+		irsdkSnapshot snap;
+		std::vector<char> buf;
+		std::vector<char> varBuf;	// copy of the var headers, taken under varStatusID
+		int varStatusID;
+		std::shared_ptr<const std::string> sessionStr;
+		std::atomic<int> refs;
+	};
+
+	void run();
+	void publish(bool connected);
+
+	std::vector<irsdkSampleStream *> m_sampleStreams;
+
+	// The session string is copied once per generation and shared by every slot
+	// published with it.  Only touched by the acquisition thread.
+	std::shared_ptr<const std::string> m_sessionStr;
+	int m_sessionCt;
+	int m_sessionStatusID;
+
+	Slot m_slots[numSlots];
+	std::atomic<int> m_latest;
+	std::atomic<long long> m_publishedSeq;
+
+	std::thread m_thread;
+	std::atomic<bool> m_stop;
+	int m_timeoutMS;
+
+	std::mutex m_waitMutex;
+	std::condition_variable m_waitCond;
+
+	mutable std::mutex m_statsMutex;
+	Stats m_stats;
+};
+
+#endif // IRSDK_ACQUISITION_H
@@ -25,16 +25,26 @@ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
 SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <windows.h>
 #include <stdio.h>
 #include <string.h>
 
 #include <assert.h>
+#include <algorithm>
 #include "irsdk_defines.h"
 #include "yaml_parser.h"
+#include "irsdk_diskclient.h"
 #include "irsdk_client.h"
+#include "irsdk_acquisition.h"
 
 #pragma warning(disable:4996)
 
+// how long to copy full lines after connecting, while we learn which vars are read
+static const int partialCopyLearnSecs = 2;
+
+// ranges closer than this get merged, one memcpy beats two for small gaps
+static const int partialCopyMergeGap = 64;
+
 irsdkClient& irsdkClient::instance()
 {
 	static irsdkClient INSTANCE;
@@ -43,8 +53,51 @@ irsdkClient& irsdkClient::instance()
 
 bool irsdkClient::waitForData(int timeoutMS)
 {
+	if(m_disk)
+	{
+		// hold back the next record until it is due, unless we are running flat out
+		if(m_line && m_playbackSpeed > 0)
+		{
+			LARGE_INTEGER now, freq;
+			QueryPerformanceCounter(&now);
+			QueryPerformanceFrequency(&freq);
+
+			const double secs = (m_disk->getRecordIdx() + 1 - m_playbackStartRecord) / (m_disk->getHeader()->tickRate * m_playbackSpeed);
+			const long long due = m_playbackStartTime + (long long)(secs * freq.QuadPart);
+			const long long waitMS = (due - now.QuadPart) * 1000 / freq.QuadPart;
+
+			if(waitMS > timeoutMS)
+			{
+				Sleep(timeoutMS);
+				return false;
+			}
+			if(waitMS > 0)
+				Sleep((DWORD)waitMS);
+		}
+
+		if(!m_disk->getNextData())
+			return false;
+
+		LARGE_INTEGER now;
+		QueryPerformanceCounter(&now);
+		m_recordTime = now.QuadPart;
+
+		const bool first = m_line == NULL;
+		m_line = m_disk->getRecord();
+		if(first)
+		{
+			// first record, treat it like a new connection
+			m_statusID++;
+			m_lastSessionCt = -1;
+		}
+		return true;
+	}
+
+	// copy only what has been read, once we know what that is
+	const bool partial = m_partialCopy && m_data && !m_rangesDirty && m_learnTicks <= 0;
+
 	// wait for start of session or new data
-	if(irsdk_waitForDataReady(timeoutMS, m_data) && irsdk_getHeader())
+	if(irsdk_waitForDataReadyRanges(timeoutMS, m_data, partial ? m_ranges : NULL, partial ? m_numRanges : 0) && irsdk_getHeader())
 	{
 		// if new connection, or data changed lenght then init
 		if(!m_data || m_nData != irsdk_getHeader()->bufLen)
@@ -60,13 +113,21 @@ bool irsdkClient::waitForData(int timeoutMS)
 			// reset session info str status
 			m_lastSessionCt = -1;
 
+			m_line = m_data;
+
+			resetVarUsage();
+
 			// and try to fill in the data
 			if(irsdk_getNewData(m_data))
+			{
+				countCopy(false);
 				return true;
+			}
 		}
 		else if(m_data)
 		{
 			// else we are allready initialized, and data is ready for processing
+			countCopy(partial);
 			return true;
 		}
 	}
@@ -76,6 +137,7 @@ bool irsdkClient::waitForData(int timeoutMS)
 		if(m_data)
 			delete[] m_data;
 		m_data = NULL;
+		m_line = NULL;
 
 		// reset session info str status
 		m_lastSessionCt = -1;
@@ -84,27 +146,380 @@ bool irsdkClient::waitForData(int timeoutMS)
 	return false;
 }
 
+void irsdkClient::setPartialCopy(bool enable)
+{
+	// the ranges learned so far stay good while the setting doesn't change
+	if(m_partialCopy.exchange(enable) != enable)
+		m_rangesDirty = true;
+}
+
+void irsdkClient::resetCopyStats()
+{
+	const int numRanges = m_copyStats.numRanges;
+	const int rangeBytes = m_copyStats.rangeBytes;
+	m_copyStats = CopyStats();
+	m_copyStats.numRanges = numRanges;
+	m_copyStats.rangeBytes = rangeBytes;
+}
+
+// new connection, forget what was read and start learning again
+void irsdkClient::resetVarUsage()
+{
+	const irsdk_header *header = irsdk_getHeader();
+
+	delete[] m_ranges;
+
+	m_nVarUsed = header ? header->numVars : 0;
+	for(int i=0; i<maxVarUsed; i++)
+		m_varUsed[i].store(0, std::memory_order_relaxed);
+	m_ranges = new irsdk_copyRange[m_nVarUsed];
+	m_numRanges = 0;
+	m_rangesDirty = false;
+	m_learnTicks = header ? partialCopyLearnSecs * header->tickRate : 0;
+	m_copyStats.numRanges = 0;
+	m_copyStats.rangeBytes = 0;
+}
+
+void irsdkClient::countCopy(bool partial)
+{
+	m_copyStats.lines++;
+	m_copyStats.bytesFull += m_nData;
+	m_copyStats.bytesCopied += partial ? m_copyStats.rangeBytes : m_nData;
+
+	// after a full copy, see if it is time to switch to (or refresh) the ranges
+	if(!partial && m_partialCopy)
+	{
+		if(m_learnTicks > 0)
+			m_learnTicks--;
+		if(m_learnTicks <= 0)
+			buildCopyRanges();
+	}
+}
+
+void irsdkClient::buildCopyRanges()
+{
+	// cleared first so a var marked while we build triggers another rebuild
+	m_rangesDirty = false;
+
+	int n = 0;
+	for(int i=0; i<m_nVarUsed; i++)
+	{
+		const irsdk_varHeader *vh = irsdk_getVarHeaderEntry(i);
+		if(!vh || (i < maxVarUsed && !m_varUsed[i].load(std::memory_order_relaxed)))
+			continue;
+
+		int len = irsdk_VarTypeBytes[vh->type] * vh->count;
+		if(vh->offset < 0 || vh->offset >= m_nData)
+			continue;
+		if(vh->offset + len > m_nData)
+			len = m_nData - vh->offset;
+
+		m_ranges[n].offset = vh->offset;
+		m_ranges[n].len = len;
+		n++;
+	}
+
+	std::sort(m_ranges, m_ranges + n, [](const irsdk_copyRange &a, const irsdk_copyRange &b) { return a.offset < b.offset; });
+
+	// coalesce overlapping and nearby ranges
+	int merged = 0;
+	int bytes = 0;
+	for(int i=0; i<n; i++)
+	{
+		if(merged > 0)
+		{
+			irsdk_copyRange &prev = m_ranges[merged-1];
+			const int prevEnd = prev.offset + prev.len;
+			if(m_ranges[i].offset <= prevEnd + partialCopyMergeGap)
+			{
+				const int end = std::max(prevEnd, m_ranges[i].offset + m_ranges[i].len);
+				bytes += end - prevEnd;
+				prev.len = end - prev.offset;
+				continue;
+			}
+		}
+		m_ranges[merged++] = m_ranges[i];
+		bytes += m_ranges[i].len;
+	}
+
+	m_numRanges = merged;
+	m_copyStats.numRanges = merged;
+	m_copyStats.rangeBytes = bytes;
+}
+
 void irsdkClient::shutdown()
 {
+	closeFile();
+
+	delete[] m_varIndex;
+	m_varIndex = NULL;
+	m_varIndexStatusID = -1;
+
 	irsdk_shutdown();
 	if(m_data)
 		delete[] m_data;
 	m_data = NULL;
+	m_line = NULL;
+
+	delete[] m_ranges;
+	m_ranges = NULL;
+	m_nVarUsed = 0;
+	m_numRanges = 0;
 
 	// reset session info str status
 	m_lastSessionCt = -1;
 }
 
+thread_local irsdkClient::ThreadView irsdkClient::s_view = { false, NULL, 0, 0, NULL, 0 };
+
+void irsdkClient::setThreadView(const irsdkSnapshot *snap)
+{
+	s_view.active = true;
+	s_view.line = snap ? snap->line : NULL;
+	s_view.lineLen = snap ? snap->lineLen : 0;
+	s_view.statusID = snap ? snap->statusID : 0;
+	s_view.varHeaders = snap ? snap->varHeaders : NULL;
+	s_view.numVars = snap ? snap->numVars : 0;
+}
+
+void irsdkClient::clearThreadView()
+{
+	s_view = ThreadView();
+}
+
 bool irsdkClient::isConnected()
 {
+	if(s_view.active)
+		return s_view.line != NULL;
+	if(m_disk)
+		return m_line != NULL;
 	return m_data != NULL && irsdk_isConnected();
 }
 
+int irsdkClient::getLineTickCount()
+{
+	if(m_disk)
+		return m_disk->getRecordTick();
+	return irsdk_getLastLineTickCount();
+}
+
+long long irsdkClient::getLineTime()
+{
+	if(m_disk)
+		return m_recordTime;
+	return irsdk_getLastLineTime();
+}
+
+bool irsdkClient::openFile(const char *path)
+{
+	closeFile();
+
+	irsdkDiskClient *disk = new irsdkDiskClient();
+	if(!disk->openFile(path))
+	{
+		delete disk;
+		return false;
+	}
+
+	// drop the live connection, it gets picked up again once the file is closed
+	if(m_data)
+		delete[] m_data;
+	m_data = NULL;
+	m_line = NULL;
+	m_lastSessionCt = -1;
+
+	// records are read in place, there is nothing to copy
+	m_nVarUsed = 0;
+
+	m_disk = disk;
+	restartPlaybackClock();
+	return true;
+}
+
+void irsdkClient::closeFile()
+{
+	if(!m_disk)
+		return;
+
+	delete m_disk;
+	m_disk = NULL;
+	m_line = NULL;
+	m_lastSessionCt = -1;
+}
+
+bool irsdkClient::isFileFinished() const
+{
+	return m_disk && m_disk->getRecordIdx() >= m_disk->getRecordCount();
+}
+
+void irsdkClient::setPlaybackSpeed(double speed)
+{
+	m_playbackSpeed = speed > 0 ? speed : 0;
+	restartPlaybackClock();
+}
+
+bool irsdkClient::seekToTick(int tick)
+{
+	if(!m_disk || !m_disk->seekToTick(tick))
+		return false;
+	restartPlaybackClock();
+	return true;
+}
+
+bool irsdkClient::seekToSessionTime(double sessionTime)
+{
+	if(!m_disk || !m_disk->seekToSessionTime(sessionTime))
+		return false;
+	restartPlaybackClock();
+	return true;
+}
+
+void irsdkClient::restartPlaybackClock()
+{
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+	m_playbackStartTime = now.QuadPart;
+	m_playbackStartRecord = m_disk ? m_disk->getRecordIdx() + 1 : 0;
+}
+
+const irsdk_header *irsdkClient::getHeader()
+{
+	if(m_disk)
+		return m_disk->getHeader();
+	return irsdk_getHeader();
+}
+
+const irsdk_varHeader *irsdkClient::getVarHeaderEntry(int idx)
+{
+	if(s_view.active)
+		return idx >= 0 && idx < s_view.numVars ? &s_view.varHeaders[idx] : NULL;
+	if(m_disk)
+		return m_disk->getVarHeaderEntry(idx);
+	return irsdk_getVarHeaderEntry(idx);
+}
+
+int irsdkClient::getNumVars()
+{
+	if(s_view.active)
+		return s_view.numVars;
+	const irsdk_header *header = getHeader();
+	return header ? header->numVars : 0;
+}
+
+// length of the line vars are read from
+int irsdkClient::getLineLen()
+{
+	if(s_view.active)
+		return s_view.lineLen;
+	if(m_disk)
+		return m_disk->getHeader()->bufLen;
+	return m_nData;
+}
+
+int irsdkClient::getSessionCt()
+{
+	// a file only ever has the one session string
+	if(m_disk)
+		return 1;
+	return irsdk_getSessionInfoStrUpdate();
+}
+
+const char *irsdkClient::sessionStr()
+{
+	if(m_disk)
+		return m_disk->getSessionStr();
+	return irsdk_getSessionInfoStr();
+}
+
+static unsigned hashVarName(const char *name)
+{
+	// FNV-1a
+	unsigned hash = 2166136261u;
+	for(int i=0; i<IRSDK_MAX_STRING && name[i]; i++)
+	{
+		hash ^= (unsigned char)name[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+void irsdkClient::bindVars()
+{
+	LARGE_INTEGER freq, start, end;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&start);
+
+	// build the index, at most half full so probe runs stay short
+	const int numVars = getNumVars();
+
+	unsigned size = 64;
+	while(size < (unsigned)numVars * 2)
+		size <<= 1;
+
+	delete[] m_varIndex;
+	m_varIndex = new int[size];
+	m_varIndexMask = size - 1;
+	for(unsigned i=0; i<size; i++)
+		m_varIndex[i] = -1;
+
+	for(int i=0; i<numVars; i++)
+	{
+		unsigned slot = hashVarName(getVarHeaderEntry(i)->name) & m_varIndexMask;
+		while(m_varIndex[slot] >= 0)
+			slot = (slot + 1) & m_varIndexMask;
+		m_varIndex[slot] = i;
+	}
+	m_varIndexStatusID = getStatusID();
+
+	// and bind everyone to it
+	int numCVars = 0;
+	int numBound = 0;
+	for(irsdkCVar *v = irsdkCVar::s_first; v; v = v->m_next)
+	{
+		v->m_idx = findVar(v->m_name);
+		v->m_statusID = m_varIndexStatusID;
+		numCVars++;
+		if(v->m_idx >= 0)
+			numBound++;
+	}
+
+	QueryPerformanceCounter(&end);
+
+	m_bindStats.numVars = numVars;
+	m_bindStats.numCVars = numCVars;
+	m_bindStats.numBound = numBound;
+	m_bindStats.ms = (double)(end.QuadPart - start.QuadPart) * 1000.0 / freq.QuadPart;
+}
+
+int irsdkClient::findVar(const char *name)
+{
+	if(!name || !m_varIndex)
+		return -1;
+
+	for(unsigned slot = hashVarName(name) & m_varIndexMask; m_varIndex[slot] >= 0; slot = (slot + 1) & m_varIndexMask)
+	{
+		const int idx = m_varIndex[slot];
+		const irsdk_varHeader *vh = getVarHeaderEntry(idx);
+		if(0 == strncmp(name, vh->name, IRSDK_MAX_STRING))
+		{
+			// a var that doesn't fit the line it would be read from stays unbound
+			if(vh->type < 0 || vh->type >= irsdk_ETCount || vh->offset < 0)
+				return -1;
+			const long long end = (long long)vh->offset + (long long)irsdk_VarTypeBytes[vh->type] * vh->count;
+			return end <= getLineLen() ? idx : -1;
+		}
+	}
+	return -1;
+}
+
 int irsdkClient::getVarIdx(const char*name)
 {
 	if(isConnected())
 	{
-		return irsdk_varNameToIndex(name);
+		// first lookup of a connection binds everything, on the thread reading the vars
+		if(m_varIndexStatusID != getStatusID())
+			bindVars();
+		return findVar(name);
 	}
 
 	return -1;
@@ -114,7 +529,7 @@ int /*irsdk_VarType*/ irsdkClient::getVarType(int idx)
 {
 	if(isConnected())
 	{
-		const irsdk_varHeader *vh = irsdk_getVarHeaderEntry(idx);
+		const irsdk_varHeader *vh = getVarHeaderEntry(idx);
 		if(vh)
 		{
 			return vh->type;
@@ -133,7 +548,7 @@ int irsdkClient::getVarCount(int idx)
 {
 	if(isConnected())
 	{
-		const irsdk_varHeader *vh = irsdk_getVarHeaderEntry(idx);
+		const irsdk_varHeader *vh = getVarHeaderEntry(idx);
 		if(vh)
 		{
 			return vh->count;
@@ -152,12 +567,13 @@ bool irsdkClient::getVarBool(int idx, int entry)
 {
 	if(isConnected())
 	{
-		const irsdk_varHeader *vh = irsdk_getVarHeaderEntry(idx);
+		const irsdk_varHeader *vh = getVarHeaderEntry(idx);
 		if(vh)
 		{
 			if(entry >= 0 && entry < vh->count)
 			{
-				const char * data = m_data + vh->offset;
+				markVarUsed(idx);
+				const char * data = getLine() + vh->offset;
 				switch(vh->type)
 				{
 				// 1 byte
@@ -205,12 +621,13 @@ int irsdkClient::getVarInt(int idx, int entry)
 {
 	if(isConnected())
 	{
-		const irsdk_varHeader *vh = irsdk_getVarHeaderEntry(idx);
+		const irsdk_varHeader *vh = getVarHeaderEntry(idx);
 		if(vh)
 		{
 			if(entry >= 0 && entry < vh->count)
 			{
-				const char * data = m_data + vh->offset;
+				markVarUsed(idx);
+				const char * data = getLine() + vh->offset;
 				switch(vh->type)
 				{
 				// 1 byte
@@ -255,12 +672,13 @@ float irsdkClient::getVarFloat(int idx, int entry)
 {
 	if(isConnected())
 	{
-		const irsdk_varHeader *vh = irsdk_getVarHeaderEntry(idx);
+		const irsdk_varHeader *vh = getVarHeaderEntry(idx);
 		if(vh)
 		{
 			if(entry >= 0 && entry < vh->count)
 			{
-				const char * data = m_data + vh->offset;
+				markVarUsed(idx);
+				const char * data = getLine() + vh->offset;
 				switch(vh->type)
 				{
 				// 1 byte
@@ -305,12 +723,13 @@ double irsdkClient::getVarDouble(int idx, int entry)
 {
 	if(isConnected())
 	{
-		const irsdk_varHeader *vh = irsdk_getVarHeaderEntry(idx);
+		const irsdk_varHeader *vh = getVarHeaderEntry(idx);
 		if(vh)
 		{
 			if(entry >= 0 && entry < vh->count)
 			{
-				const char * data = m_data + vh->offset;
+				markVarUsed(idx);
+				const char * data = getLine() + vh->offset;
 				switch(vh->type)
 				{
 				// 1 byte
@@ -361,7 +780,7 @@ int irsdkClient::getSessionStrVal(const char *path, char *val, int valLen)
 
 		const char *tVal = NULL;
 		int tValLen = 0;
-		if(parseYaml(irsdk_getSessionInfoStr(), path, &tVal, &tValLen))
+		if(parseYaml(sessionStr(), path, &tVal, &tValLen))
 		{
 			// dont overflow out buffer
 			int len = tValLen;
@@ -389,7 +808,7 @@ const char* irsdkClient::getSessionStr()
 	if(isConnected())
 	{
 		m_lastSessionCt = getSessionCt(); 
-		return irsdk_getSessionInfoStr(); 
+		return sessionStr(); 
 	}
 
 	return NULL;
@@ -398,17 +817,43 @@ const char* irsdkClient::getSessionStr()
 
 //----------------------------------
 
+irsdkCVar *irsdkCVar::s_first = NULL;
+
 irsdkCVar::irsdkCVar()
 	: m_idx(-1)
 	, m_statusID(-1)
 {
 	m_name[0] = '\0';
+	link();
 }
 
 irsdkCVar::irsdkCVar(const char *name)
+	: m_idx(-1)
+	, m_statusID(-1)
 {
 	m_name[0] = '\0';
 	setVarName(name);
+	link();
+}
+
+irsdkCVar::~irsdkCVar()
+{
+	if(m_prev)
+		m_prev->m_next = m_next;
+	else
+		s_first = m_next;
+	if(m_next)
+		m_next->m_prev = m_prev;
+}
+
+// s_first is zero initialized before any constructor runs, so this is safe for globals
+void irsdkCVar::link()
+{
+	m_prev = NULL;
+	m_next = s_first;
+	if(s_first)
+		s_first->m_prev = this;
+	s_first = this;
 }
 
 void irsdkCVar::setVarName(const char *name)
@@ -28,6 +28,14 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef IRSDKCLIENT_H
 #define IRSDKCLIENT_H
 
+#include <atomic>
+
+struct irsdk_header;
+struct irsdk_varHeader;
+struct irsdk_copyRange;
+struct irsdkSnapshot;
+class irsdkDiskClient;
+
 // A C++ wrapper around the irsdk calls that takes care of the details of maintaining a connection.
 // reads out the data into a cache so you don't have to worry about timming
 class irsdkClient
@@ -41,7 +49,78 @@ public:
 	bool waitForData(int timeoutMS = 16);
 
 	bool isConnected();
-	int getStatusID() { return m_statusID; }
+	int getStatusID() { return s_view.active ? s_view.statusID : m_statusID.load(); }
+
+	// the line vars are read from, NULL when not connected
+	const char *getLine() const { return s_view.active ? s_view.line : m_line; }
+
+	// When waitForData() runs on its own thread (see irsdkAcquisition) other threads
+	// read vars from a snapshot of a line instead.  This sets the snapshot for the
+	// calling thread; its status ID and var headers are used in place of the live
+	// ones, and a NULL snapshot or line reads as not connected.  Var binding then
+	// also happens on the reading thread, so only one thread should read through
+	// irsdkCVars.
+	static void setThreadView(const irsdkSnapshot *snap);
+	static void clearThreadView();
+
+	// tick count of the current line, and the QueryPerformanceCounter() value from
+	// when it was first seen (for a file, the record's SessionTick and when the
+	// record was read)
+	int getLineTickCount();
+	long long getLineTime();
+
+	// tell the partial copy that a var is read directly from getLine()
+	void useVar(int idx) { if(idx >= 0) markVarUsed(idx); }
+
+	// Replay a telemetry (.ibt) file instead of the live sim.  Records are served
+	// straight out of the mapped file, paced by the playback speed.
+	bool openFile(const char *path);
+	void closeFile();
+	bool isFileOpen() const { return m_disk != NULL; }
+	bool isFileFinished() const;
+
+	// 1 = real time, N = N times real time, 0 = as fast as possible
+	void setPlaybackSpeed(double speed);
+	double getPlaybackSpeed() const { return m_playbackSpeed; }
+
+	// the next waitForData() returns the first record at or after the tick/time
+	bool seekToTick(int tick);
+	bool seekToSessionTime(double sessionTime);
+
+	// headers of whatever we are reading from, live or file, or the thread
+	// view's var headers when one is set
+	const irsdk_header *getHeader();
+	const irsdk_varHeader *getVarHeaderEntry(int idx);
+	int getNumVars();
+
+	// Only copy the parts of each live line that hold vars we actually read.
+	// Everything is copied for the first couple of seconds of a connection while
+	// we learn what is used, and for one more tick whenever a var is read for the
+	// first time (that first read may see a value from the last full copy).
+	void setPartialCopy(bool enable);
+	bool getPartialCopy() const { return m_partialCopy; }
+
+	struct CopyStats
+	{
+		long long lines;		// lines copied out of the sim
+		long long bytesCopied;	// bytes actually copied
+		long long bytesFull;	// bytes a full copy of every line would have taken
+		int numRanges;			// current number of coalesced ranges
+		int rangeBytes;			// bytes per line in those ranges
+	};
+	const CopyStats &getCopyStats() const { return m_copyStats; }
+	void resetCopyStats();
+
+	// On the first var lookup of every connection all irsdkCVars are bound in one pass
+	// against a hash index of the var headers, instead of each doing a linear search.
+	struct BindStats
+	{
+		int numVars;		// vars the sim (or file) provides
+		int numCVars;		// irsdkCVars in the program
+		int numBound;		// irsdkCVars that found their var
+		double ms;			// time to build the index and bind
+	};
+	const BindStats &getBindStats() const { return m_bindStats; }
 
 	int getVarIdx(const char*name);
 
@@ -71,7 +150,7 @@ public:
 	//---
 
 	// value that increments with each update to string
-	int getSessionCt() { return irsdk_getSessionInfoStrUpdate(); }
+	int getSessionCt();
 
 	// has string changed since we last read any values from it
 	bool wasSessionStrUpdated() { return m_lastSessionCt != getSessionCt(); } 
@@ -88,19 +167,93 @@ protected:
 	irsdkClient()
 		: m_data(NULL)
 		, m_nData(0)
+		, m_line(NULL)
 		, m_statusID(0)
 		, m_lastSessionCt(-1)
+		, m_disk(NULL)
+		, m_playbackSpeed(1.0)
+		, m_playbackStartTime(0)
+		, m_playbackStartRecord(0)
+		, m_recordTime(0)
+		, m_partialCopy(false)
+		, m_nVarUsed(0)
+		, m_ranges(NULL)
+		, m_numRanges(0)
+		, m_rangesDirty(false)
+		, m_learnTicks(0)
+		, m_copyStats()
+		, m_varIndex(NULL)
+		, m_varIndexMask(0)
+		, m_varIndexStatusID(-1)
+		, m_bindStats()
 	{ }
 
 	~irsdkClient() { shutdown(); }
 
 	void shutdown();
+	void restartPlaybackClock();
+	const char *sessionStr();
+
+	void bindVars();
+	int findVar(const char *name);
+	int getLineLen();
+
+	void resetVarUsage();
+	void buildCopyRanges();
+	void countCopy(bool partial);
+	void markVarUsed(int idx)
+	{
+		// may be called from a reading thread while waitForData() runs on another
+		if(idx < maxVarUsed && !m_varUsed[idx].load(std::memory_order_relaxed))
+		{
+			m_varUsed[idx].store(1, std::memory_order_relaxed);
+			m_rangesDirty = true;
+		}
+	}
+
+	struct ThreadView
+	{
+		bool active;
+		const char *line;
+		int lineLen;
+		int statusID;
+		const irsdk_varHeader *varHeaders;
+		int numVars;
+	};
+	static thread_local ThreadView s_view;
 
 	char *m_data;
 	int m_nData;
-	int m_statusID;
 
-	int m_lastSessionCt;
+	// the line we read vars from, m_data when live or a record in the mapped file
+	const char *m_line;
+
+	std::atomic<int> m_statusID;
+
+	std::atomic<int> m_lastSessionCt;
+
+	irsdkDiskClient *m_disk;
+	double m_playbackSpeed;
+	long long m_playbackStartTime;
+	int m_playbackStartRecord;
+	long long m_recordTime;
+
+	std::atomic<bool> m_partialCopy;	// set from the main thread, read where waitForData() runs
+	// per var, has it ever been read; vars past maxVarUsed are always copied
+	static const int maxVarUsed = 2048;
+	std::atomic<unsigned char> m_varUsed[maxVarUsed];
+	int m_nVarUsed;
+	irsdk_copyRange *m_ranges;
+	int m_numRanges;
+	std::atomic<bool> m_rangesDirty;	// a var was read for the first time, ranges need a rebuild
+	int m_learnTicks;			// full copies left before we start copying ranges
+	CopyStats m_copyStats;
+
+	// open addressed name hash -> var index, valid for m_varIndexStatusID
+	int *m_varIndex;
+	unsigned m_varIndexMask;
+	int m_varIndexStatusID;
+	BindStats m_bindStats;
 
 	static irsdkClient *m_instance;
 };
@@ -113,6 +266,11 @@ class irsdkCVar
 public:
 	irsdkCVar();
 	irsdkCVar(const char *name);
+	~irsdkCVar();
+
+	// instances are linked into a list so they can be bound all at once
+	irsdkCVar(const irsdkCVar &) = delete;
+	irsdkCVar &operator=(const irsdkCVar &) = delete;
 
 	void setVarName(const char *name);
 
@@ -128,12 +286,20 @@ public:
 	double getDouble(int entry = 0);
 
 protected:
+	friend class irsdkClient;
+
 	bool checkIdx();
+	void link();
 
 	static const int max_string = 32; //IRSDK_MAX_STRING
 	char m_name[max_string];
 	int m_idx;
 	int m_statusID;
+
+	// every live irsdkCVar, see irsdkClient::bindVars()
+	static irsdkCVar *s_first;
+	irsdkCVar *m_prev;
+	irsdkCVar *m_next;
 };
 
 #endif // IRSDKCLIENT_H
@@ -0,0 +1,340 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "irsdk_defines.h"
+#include "irsdk_diskclient.h"
+#include "irsdk_columns.h"
+
+#pragma warning(disable:4996)
+
+// columns start on a cache line
+static const int columnAlign = 64;
+
+// vars the lap and session index is built from
+static const char *indexVars[] = { "Lap", "SessionNum", "SessionFlags", "OnPitRoad" };
+
+// .ibtc layout: this header, the var headers, the column offsets (one long long per
+// var), the session string, then the column data at dataOffset
+struct irsdkColumnsFileHeader
+{
+	char magic[4];
+	int ver;
+	int tickRate;
+	int recordCount;
+	int numVars;
+	int sessionStrLen;
+	long long dataOffset;
+	long long dataLen;
+};
+
+static const char columnsMagic[4] = { 'I', 'B', 'T', 'C' };
+static const int columnsVer = 2;
+
+// End of a column of recordCount records starting at offset.  Fails if the var header
+// is bad or the column would not fit in memory; the product is of two ints and a type
+// size, so it is checked by division rather than computed and tested afterwards.
+static bool columnEnd(size_t offset, const irsdk_varHeader &vh, int recordCount, size_t *end)
+{
+	if(vh.type < 0 || vh.type >= irsdk_ETCount || vh.count <= 0 || recordCount < 0)
+		return false;
+
+	const size_t maxSize = (size_t)PTRDIFF_MAX;
+	const size_t recordBytes = (size_t)irsdk_VarTypeBytes[vh.type] * (size_t)vh.count;
+	if(recordCount > 0 && recordBytes > maxSize / (size_t)recordCount)
+		return false;
+
+	const size_t bytes = recordBytes * (size_t)recordCount;
+	if(offset > maxSize - bytes)
+		return false;
+
+	*end = offset + bytes;
+	return true;
+}
+
+void irsdkColumns::clear()
+{
+	m_recordCount = 0;
+	m_tickRate = 0;
+	m_sessionStr.clear();
+	m_vars.clear();
+	m_offsets.clear();
+	m_data.clear();
+	m_laps.clear();
+	m_sessions.clear();
+}
+
+int irsdkColumns::getVarIdx(const char *name) const
+{
+	if(name)
+	{
+		for(int i=0; i<(int)m_vars.size(); i++)
+		{
+			if(0 == strncmp(name, m_vars[i].name, IRSDK_MAX_STRING))
+				return i;
+		}
+	}
+
+	return -1;
+}
+
+const irsdk_varHeader *irsdkColumns::getVarHeader(int idx) const
+{
+	if(idx >= 0 && idx < (int)m_vars.size())
+		return &m_vars[idx];
+	return NULL;
+}
+
+const char *irsdkColumns::getColumn(int idx) const
+{
+	if(idx >= 0 && idx < (int)m_vars.size())
+		return m_data.data() + m_offsets[idx];
+	return NULL;
+}
+
+const char *irsdkColumns::getColumn(const char *name, irsdk_VarType type) const
+{
+	const int idx = getVarIdx(name);
+	if(idx >= 0 && m_vars[idx].type == type)
+		return getColumn(idx);
+	return NULL;
+}
+
+bool irsdkColumns::addColumn(const irsdk_varHeader &vh)
+{
+	size_t offset = 0;
+	if(!m_vars.empty())
+	{
+		size_t prevEnd = 0;
+		if(!columnEnd(m_offsets.back(), m_vars.back(), m_recordCount, &prevEnd) || prevEnd > (size_t)PTRDIFF_MAX - columnAlign)
+			return false;
+		offset = (prevEnd + columnAlign - 1) / columnAlign * columnAlign;
+	}
+
+	size_t end = 0;
+	if(!columnEnd(offset, vh, m_recordCount, &end))
+		return false;
+
+	m_vars.push_back(vh);
+	m_offsets.push_back(offset);
+	return true;
+}
+
+bool irsdkColumns::transcode(const irsdkDiskClient &disk, const char *const *varNames, int numVarNames)
+{
+	clear();
+
+	const irsdk_header *header = disk.getHeader();
+	if(!header)
+		return false;
+
+	m_recordCount = disk.getRecordCount();
+	m_tickRate = header->tickRate;
+	m_sessionStr = disk.getSessionStr();
+
+	// pick the vars, keeping the file's order so the gather below walks each line forwards
+	std::vector<int> srcIdx;
+	for(int i=0; i<header->numVars; i++)
+	{
+		const irsdk_varHeader *vh = disk.getVarHeaderEntry(i);
+		bool keep = !varNames;
+		for(int j=0; !keep && j<numVarNames; j++)
+			keep = 0 == strncmp(varNames[j], vh->name, IRSDK_MAX_STRING);
+		for(int j=0; !keep && j<(int)(sizeof(indexVars)/sizeof(indexVars[0])); j++)
+			keep = 0 == strncmp(indexVars[j], vh->name, IRSDK_MAX_STRING);
+
+		if(keep)
+		{
+			if(!addColumn(*vh))
+			{
+				printf("irsdkColumns: file is too large to transcode (%s)\n", vh->name);
+				clear();
+				return false;
+			}
+			srcIdx.push_back(i);
+		}
+	}
+
+	if(!m_vars.empty())
+	{
+		size_t dataLen = 0;
+		columnEnd(m_offsets.back(), m_vars.back(), m_recordCount, &dataLen);
+		if(dataLen > m_data.max_size())
+		{
+			printf("irsdkColumns: file is too large to transcode\n");
+			clear();
+			return false;
+		}
+		m_data.resize(dataLen);
+	}
+
+	// Gather one record at a time.  Each line is read exactly once, and the writes
+	// stream sequentially through every column.
+	for(int r=0; r<m_recordCount; r++)
+	{
+		const char *line = disk.getRecord(r);
+		for(int i=0; i<(int)m_vars.size(); i++)
+		{
+			const irsdk_varHeader &col = m_vars[i];
+			const size_t bytes = (size_t)irsdk_VarTypeBytes[col.type] * col.count;
+			memcpy(m_data.data() + m_offsets[i] + (size_t)r * bytes, line + col.offset, bytes);
+		}
+	}
+
+	buildIndex();
+	return true;
+}
+
+bool irsdkColumns::save(const char *path) const
+{
+	FILE *fp = fopen(path, "wb");
+	if(!fp)
+	{
+		printf("irsdkColumns: could not write %s\n", path);
+		return false;
+	}
+
+	irsdkColumnsFileHeader fh = {};
+	memcpy(fh.magic, columnsMagic, sizeof(fh.magic));
+	fh.ver = columnsVer;
+	fh.tickRate = m_tickRate;
+	fh.recordCount = m_recordCount;
+	fh.numVars = (int)m_vars.size();
+	fh.sessionStrLen = (int)m_sessionStr.length();
+	fh.dataLen = (long long)m_data.size();
+
+	std::vector<long long> offsets(m_offsets.begin(), m_offsets.end());
+
+	const long long metaLen = sizeof(fh) + m_vars.size() * (sizeof(irsdk_varHeader) + sizeof(long long)) + m_sessionStr.length();
+	fh.dataOffset = (metaLen + columnAlign - 1) / columnAlign * columnAlign;
+
+	static const char pad[columnAlign] = {};
+
+	bool ok = fwrite(&fh, sizeof(fh), 1, fp) == 1;
+	ok = ok && (m_vars.empty() || fwrite(m_vars.data(), sizeof(irsdk_varHeader), m_vars.size(), fp) == m_vars.size());
+	ok = ok && (offsets.empty() || fwrite(offsets.data(), sizeof(long long), offsets.size(), fp) == offsets.size());
+	ok = ok && fwrite(m_sessionStr.data(), 1, m_sessionStr.length(), fp) == m_sessionStr.length();
+	ok = ok && fwrite(pad, 1, (size_t)(fh.dataOffset - metaLen), fp) == (size_t)(fh.dataOffset - metaLen);
+	ok = ok && fwrite(m_data.data(), 1, m_data.size(), fp) == m_data.size();
+
+	fclose(fp);
+
+	if(!ok)
+		printf("irsdkColumns: error writing %s\n", path);
+	return ok;
+}
+
+bool irsdkColumns::load(const char *path)
+{
+	clear();
+
+	FILE *fp = fopen(path, "rb");
+	if(!fp)
+	{
+		printf("irsdkColumns: could not open %s\n", path);
+		return false;
+	}
+
+	irsdkColumnsFileHeader fh = {};
+	bool ok = fread(&fh, sizeof(fh), 1, fp) == 1 && 0 == memcmp(fh.magic, columnsMagic, sizeof(fh.magic)) && fh.ver == columnsVer;
+	ok = ok && fh.numVars >= 0 && fh.sessionStrLen >= 0 && fh.recordCount >= 0 && fh.dataLen >= 0;
+	ok = ok && (unsigned long long)fh.dataLen <= (unsigned long long)PTRDIFF_MAX;
+
+	std::vector<long long> offsets;
+	if(ok)
+	{
+		m_tickRate = fh.tickRate;
+		m_recordCount = fh.recordCount;
+		m_vars.resize(fh.numVars);
+		offsets.resize(fh.numVars);
+		m_sessionStr.resize(fh.sessionStrLen);
+		m_data.resize((size_t)fh.dataLen);
+
+		ok = (m_vars.empty() || fread(m_vars.data(), sizeof(irsdk_varHeader), m_vars.size(), fp) == m_vars.size());
+		ok = ok && (offsets.empty() || fread(offsets.data(), sizeof(long long), offsets.size(), fp) == offsets.size());
+		ok = ok && (m_sessionStr.empty() || fread(&m_sessionStr[0], 1, m_sessionStr.length(), fp) == m_sessionStr.length());
+		ok = ok && 0 == _fseeki64(fp, fh.dataOffset, SEEK_SET);
+		ok = ok && fread(m_data.data(), 1, m_data.size(), fp) == m_data.size();
+	}
+
+	// make sure every column fits in the data we read
+	for(int i=0; ok && i<(int)m_vars.size(); i++)
+	{
+		size_t end = 0;
+		ok = offsets[i] >= 0 && offsets[i] <= fh.dataLen &&
+			columnEnd((size_t)offsets[i], m_vars[i], m_recordCount, &end) && end <= (size_t)fh.dataLen;
+		if(ok)
+			m_offsets.push_back((size_t)offsets[i]);
+	}
+
+	fclose(fp);
+
+	if(!ok)
+	{
+		printf("irsdkColumns: %s is not a valid column file\n", path);
+		clear();
+		return false;
+	}
+
+	buildIndex();
+	return true;
+}
+
+void irsdkColumns::buildIndex()
+{
+	m_laps.clear();
+	m_sessions.clear();
+
+	const int *lap = getColumn<int>("Lap", irsdk_int);
+	const int *sessionNum = getColumn<int>("SessionNum", irsdk_int);
+	const int *sessionFlags = getColumn<int>("SessionFlags", irsdk_bitField);
+	const bool *onPitRoad = getColumn<bool>("OnPitRoad", irsdk_bool);
+	if(!lap || !sessionNum || m_recordCount <= 0)
+		return;
+
+	for(int r=0; r<m_recordCount; r++)
+	{
+		if(m_sessions.empty() || m_sessions.back().sessionNum != sessionNum[r])
+		{
+			irsdkSessionIndex s = { sessionNum[r], r, r };
+			m_sessions.push_back(s);
+		}
+		m_sessions.back().endRecord = r+1;
+
+		if(m_laps.empty() || m_laps.back().lap != lap[r] || m_laps.back().sessionNum != sessionNum[r])
+		{
+			irsdkLapIndex l = { lap[r], sessionNum[r], r, r, 0, false };
+			m_laps.push_back(l);
+		}
+
+		irsdkLapIndex &cur = m_laps.back();
+		cur.endRecord = r+1;
+		if(sessionFlags)
+			cur.sessionFlags |= sessionFlags[r];
+		if(onPitRoad)
+			cur.onPitRoad = cur.onPitRoad || onPitRoad[r];
+	}
+}
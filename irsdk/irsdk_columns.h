@@ -0,0 +1,108 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef IRSDK_COLUMNS_H
+#define IRSDK_COLUMNS_H
+
+#include <string>
+#include <vector>
+#include "irsdk_defines.h"
+
+class irsdkDiskClient;
+
+// one lap of the player's car, [firstRecord, endRecord)
+struct irsdkLapIndex
+{
+	int lap;			// value of Lap for the whole range
+	int sessionNum;
+	int firstRecord;
+	int endRecord;
+	int sessionFlags;	// SessionFlags or'ed over the lap
+	bool onPitRoad;		// on pit road at any point in the lap
+};
+
+// one session of the file, [firstRecord, endRecord)
+struct irsdkSessionIndex
+{
+	int sessionNum;
+	int firstRecord;
+	int endRecord;
+};
+
+// A telemetry file transposed into one contiguous column per variable.
+//
+// Row-major .ibt records make every query touch every byte of every line.  Here each
+// var's values for all records sit next to each other (entry e of record r at
+// [r*count + e]), so a query that needs a handful of vars over an hour long stint
+// only streams those columns.  A lap and session index is built alongside, from the
+// Lap/SessionNum/SessionFlags/OnPitRoad columns, which are always transcoded.
+//
+// Columns can be written to and read back from a .ibtc file.
+class irsdkColumns
+{
+public:
+	// transpose the file, keeping only the named vars (all of them if varNames is NULL)
+	bool transcode(const irsdkDiskClient &disk, const char *const *varNames = NULL, int numVarNames = 0);
+
+	bool save(const char *path) const;
+	bool load(const char *path);
+	void clear();
+
+	int getRecordCount() const { return m_recordCount; }
+	int getTickRate() const { return m_tickRate; }
+	const std::string &getSessionStr() const { return m_sessionStr; }
+
+	int getNumVars() const { return (int)m_vars.size(); }
+	int getVarIdx(const char *name) const;
+
+	// the var's header as it was in the source file; its offset is not the column's
+	const irsdk_varHeader *getVarHeader(int idx) const;
+
+	// raw column, getVarHeader(idx)->count values per record
+	const char *getColumn(int idx) const;
+
+	// typed column, NULL if the var is missing or is not of the given type
+	const char *getColumn(const char *name, irsdk_VarType type) const;
+	template<typename T> const T *getColumn(const char *name, irsdk_VarType type) const { return (const T *)getColumn(name, type); }
+
+	const std::vector<irsdkLapIndex> &getLaps() const { return m_laps; }
+	const std::vector<irsdkSessionIndex> &getSessions() const { return m_sessions; }
+
+protected:
+	bool addColumn(const irsdk_varHeader &vh);
+	void buildIndex();
+
+	int m_recordCount = 0;
+	int m_tickRate = 0;
+	std::string m_sessionStr;
+
+	std::vector<irsdk_varHeader> m_vars;
+	std::vector<size_t> m_offsets;	// start of each column in m_data
+	std::vector<char> m_data;
+
+	std::vector<irsdkLapIndex> m_laps;
+	std::vector<irsdkSessionIndex> m_sessions;
+};
+
+#endif // IRSDK_COLUMNS_H
@@ -81,11 +81,21 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 // Constant Definitions
 
+#ifdef _WIN32
 #include <tchar.h>
 
 static const _TCHAR IRSDK_DATAVALIDEVENTNAME[] = _T("Local\\IRSDKDataValidEvent");
 static const _TCHAR IRSDK_MEMMAPFILENAME[]     = _T("Local\\IRSDKMemMapFileName");
 static const _TCHAR IRSDK_BROADCASTMSGNAME[]   = _T("IRSDK_BROADCASTMSG");
+#else
+#include <string.h>
+
+// Not part of the sim, for running iRon's sim stand-in (irsdk_sim_posix.cpp) and
+// reader on Linux.  Both are POSIX shared memory objects, the data valid "event"
+// holds a single futex word that is bumped and woken for every line.
+static const char IRSDK_DATAVALIDEVENTNAME[] = "/IRSDKDataValidEvent";
+static const char IRSDK_MEMMAPFILENAME[]     = "/IRSDKMemMapFileName";
+#endif
 
 static const int IRSDK_MAX_BUFS = 4;
 static const int IRSDK_MAX_STRING = 32;
@@ -375,6 +385,22 @@ struct irsdk_diskSubHeader
 	int sessionRecordCount;
 };
 
+// counters kept by irsdk_getNewData(), see irsdk_getReadStats()
+struct irsdk_readStats
+{
+	int reads;			// lines copied out successfully
+	int tornReads;		// copies discarded because the sim rewrote the buffer while we read it
+	int fallbackReads;	// lines served from a buffer other than the first one we tried
+	int failedReads;	// new data was available, but no buffer could be copied consistently
+};
+
+// part of a line to copy, see irsdk_getNewDataRanges()
+struct irsdk_copyRange
+{
+	int offset;
+	int len;
+};
+
 //----
 // Client function definitions
 
@@ -383,8 +409,22 @@ void irsdk_shutdown();
 
 bool irsdk_getNewData(char *data);
 bool irsdk_waitForDataReady(int timeOut, char *data);
+
+// same as above, but only copy the given parts of the line into data,
+// leaving the rest as it was.  Ranges must lie within bufLen.
+bool irsdk_getNewDataRanges(char *data, const irsdk_copyRange *ranges, int numRanges);
+bool irsdk_waitForDataReadyRanges(int timeOut, char *data, const irsdk_copyRange *ranges, int numRanges);
 bool irsdk_isConnected();
 
+const irsdk_readStats *irsdk_getReadStats();
+void irsdk_resetReadStats();
+
+// tick count of the last line irsdk_getNewData() copied out, and the
+// QueryPerformanceCounter() value from when that tick was first seen
+// (CLOCK_MONOTONIC nanoseconds on Linux)
+int irsdk_getLastLineTickCount();
+long long irsdk_getLastLineTime();
+
 const irsdk_header *irsdk_getHeader();
 const char *irsdk_getData(int index);
 const char *irsdk_getSessionInfoStr();
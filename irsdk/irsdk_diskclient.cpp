@@ -0,0 +1,245 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <windows.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "irsdk_defines.h"
+#include "irsdk_diskclient.h"
+
+#pragma warning(disable:4996)
+
+// how far we walk from the computed record before falling back to a binary search
+static const int maxSeekWalk = 64;
+
+// Index of the first record whose key (SessionTick or SessionTime, which only go
+// up within a file) is at or after target, or count if there is none.  The guess
+// is usually exact or a few records off, so walk from it first.  A long pause in
+// the recording leaves it too far out for that, then binary search the file.
+template<typename T, typename KeyAt>
+static int findFirstRecord(int count, double guess, T target, KeyAt keyAt)
+{
+	int idx = !(guess > 0.0) ? 0 : (guess >= count ? count-1 : (int)guess);
+
+	for(int i=0; i<maxSeekWalk && idx > 0 && keyAt(idx-1) >= target; i++)
+		idx--;
+	for(int i=0; i<maxSeekWalk && idx < count && keyAt(idx) < target; i++)
+		idx++;
+
+	if((idx == count || keyAt(idx) >= target) && (idx == 0 || keyAt(idx-1) < target))
+		return idx;
+
+	int lo = 0;
+	int hi = count;
+	while(lo < hi)
+	{
+		const int mid = lo + (hi - lo) / 2;
+		if(keyAt(mid) < target)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+bool irsdkDiskClient::openFile(const char *path)
+{
+	closeFile();
+
+	m_hFile = CreateFile(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(m_hFile == INVALID_HANDLE_VALUE)
+	{
+		m_hFile = NULL;
+		printf("irsdkDiskClient: could not open %s\n", path);
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if(!GetFileSizeEx(m_hFile, &size) || size.QuadPart < (LONGLONG)(sizeof(irsdk_header) + sizeof(irsdk_diskSubHeader)))
+	{
+		printf("irsdkDiskClient: %s is too small to be a telemetry file\n", path);
+		closeFile();
+		return false;
+	}
+	m_fileSize = size.QuadPart;
+
+	m_hMemMapFile = CreateFileMapping(m_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if(m_hMemMapFile)
+		m_base = (const char *)MapViewOfFile(m_hMemMapFile, FILE_MAP_READ, 0, 0, 0);
+	if(!m_base)
+	{
+		printf("irsdkDiskClient: could not map %s\n", path);
+		closeFile();
+		return false;
+	}
+
+	m_header = (const irsdk_header *)m_base;
+	m_subHeader = (const irsdk_diskSubHeader *)(m_base + sizeof(irsdk_header));
+
+	const irsdk_header *h = m_header;
+	const long long varHeaderEnd = (long long)h->varHeaderOffset + (long long)h->numVars * sizeof(irsdk_varHeader);
+	const long long sessionEnd = (long long)h->sessionInfoOffset + h->sessionInfoLen;
+	if(h->ver != IRSDK_VER || h->numVars <= 0 || h->bufLen <= 0 || h->tickRate <= 0 ||
+	   h->varHeaderOffset < 0 || varHeaderEnd > m_fileSize ||
+	   h->sessionInfoOffset < 0 || h->sessionInfoLen < 0 || sessionEnd > m_fileSize ||
+	   h->varBuf[0].bufOffset <= 0 || h->varBuf[0].bufOffset > m_fileSize)
+	{
+		printf("irsdkDiskClient: %s has an invalid header\n", path);
+		closeFile();
+		return false;
+	}
+
+	// trust the file size over the record count, in case the file was truncated
+	const long long available = (m_fileSize - h->varBuf[0].bufOffset) / h->bufLen;
+	m_recordCount = m_subHeader->sessionRecordCount;
+	if(m_recordCount <= 0 || m_recordCount > available)
+		m_recordCount = (int)available;
+	m_recordIdx = -1;
+
+	// the string may or may not include the terminator, so stop at the first null
+	const char *session = m_base + h->sessionInfoOffset;
+	m_sessionStr.assign(session, strnlen(session, h->sessionInfoLen));
+
+	const int tickIdx = getVarIdx("SessionTick");
+	const int timeIdx = getVarIdx("SessionTime");
+	m_sessionTickOffset = tickIdx >= 0 && getVarHeaderEntry(tickIdx)->type == irsdk_int ? getVarHeaderEntry(tickIdx)->offset : -1;
+	m_sessionTimeOffset = timeIdx >= 0 && getVarHeaderEntry(timeIdx)->type == irsdk_double ? getVarHeaderEntry(timeIdx)->offset : -1;
+
+	return true;
+}
+
+void irsdkDiskClient::closeFile()
+{
+	if(m_base)
+		UnmapViewOfFile(m_base);
+	if(m_hMemMapFile)
+		CloseHandle(m_hMemMapFile);
+	if(m_hFile)
+		CloseHandle(m_hFile);
+
+	m_base = NULL;
+	m_hMemMapFile = NULL;
+	m_hFile = NULL;
+	m_fileSize = 0;
+	m_header = NULL;
+	m_subHeader = NULL;
+	m_sessionStr.clear();
+	m_recordCount = 0;
+	m_recordIdx = -1;
+	m_sessionTickOffset = -1;
+	m_sessionTimeOffset = -1;
+}
+
+const irsdk_varHeader *irsdkDiskClient::getVarHeaderEntry(int index) const
+{
+	if(m_header && index >= 0 && index < m_header->numVars)
+		return &((const irsdk_varHeader *)(m_base + m_header->varHeaderOffset))[index];
+	return NULL;
+}
+
+int irsdkDiskClient::getVarIdx(const char *name) const
+{
+	if(m_header && name)
+	{
+		for(int index=0; index<m_header->numVars; index++)
+		{
+			const irsdk_varHeader *pVar = getVarHeaderEntry(index);
+			if(0 == strncmp(name, pVar->name, IRSDK_MAX_STRING))
+				return index;
+		}
+	}
+
+	return -1;
+}
+
+const char *irsdkDiskClient::getRecord(int idx) const
+{
+	if(m_header && idx >= 0 && idx < m_recordCount)
+		return m_base + m_header->varBuf[0].bufOffset + (long long)idx * m_header->bufLen;
+	return NULL;
+}
+
+bool irsdkDiskClient::getNextData()
+{
+	if(m_recordIdx + 1 >= m_recordCount)
+	{
+		m_recordIdx = m_recordCount;
+		return false;
+	}
+
+	m_recordIdx++;
+	return true;
+}
+
+bool irsdkDiskClient::seekToRecord(int idx)
+{
+	if(idx < 0 || idx >= m_recordCount)
+		return false;
+
+	m_recordIdx = idx - 1;
+	return true;
+}
+
+int irsdkDiskClient::getRecordTick() const
+{
+	if(m_sessionTickOffset < 0 || !getRecord())
+		return m_recordIdx;
+	return recordTick(m_recordIdx);
+}
+
+int irsdkDiskClient::recordTick(int idx) const
+{
+	return *(const int *)(getRecord(idx) + m_sessionTickOffset);
+}
+
+double irsdkDiskClient::recordSessionTime(int idx) const
+{
+	return *(const double *)(getRecord(idx) + m_sessionTimeOffset);
+}
+
+bool irsdkDiskClient::seekToTick(int tick)
+{
+	if(m_sessionTickOffset < 0 || m_recordCount <= 0)
+		return false;
+
+	// SessionTick counts at the sim's rate, which is always 60 Hz, while records
+	// are written at the header's tick rate
+	const double recordsPerTick = m_header->tickRate / 60.0;
+	const double guess = floor(((double)tick - recordTick(0)) * recordsPerTick);
+
+	const int idx = findFirstRecord(m_recordCount, guess, tick, [this](int i) { return recordTick(i); });
+	return seekToRecord(idx);
+}
+
+bool irsdkDiskClient::seekToSessionTime(double sessionTime)
+{
+	if(m_sessionTimeOffset < 0 || m_recordCount <= 0)
+		return false;
+
+	const double guess = ceil((sessionTime - recordSessionTime(0)) * m_header->tickRate);
+
+	const int idx = findFirstRecord(m_recordCount, guess, sessionTime, [this](int i) { return recordSessionTime(i); });
+	return seekToRecord(idx);
+}
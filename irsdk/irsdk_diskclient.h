@@ -0,0 +1,100 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef IRSDK_DISKCLIENT_H
+#define IRSDK_DISKCLIENT_H
+
+#include <string>
+
+struct irsdk_header;
+struct irsdk_diskSubHeader;
+struct irsdk_varHeader;
+
+// Read-only view of a telemetry (.ibt) file.
+//
+// The file is memory mapped, so records are handed out as pointers straight into
+// the mapping, in the same layout as a live line buffer.  Only the session string
+// is copied out, since the yaml parser wants it null terminated.
+class irsdkDiskClient
+{
+public:
+	irsdkDiskClient() {}
+	~irsdkDiskClient() { closeFile(); }
+
+	bool openFile(const char *path);
+	void closeFile();
+	bool isFileOpen() const { return m_base != NULL; }
+
+	const irsdk_header *getHeader() const { return m_header; }
+	const irsdk_diskSubHeader *getDiskSubHeader() const { return m_subHeader; }
+	const irsdk_varHeader *getVarHeaderEntry(int index) const;
+	const char *getSessionStr() const { return m_sessionStr.c_str(); }
+
+	// Note: this is a linear search, so cache the results
+	int getVarIdx(const char *name) const;
+
+	int getRecordCount() const { return m_recordCount; }
+	int getRecordIdx() const { return m_recordIdx; }
+
+	// the record at the current position, or NULL before the first getNextData()
+	const char *getRecord() const { return getRecord(m_recordIdx); }
+	const char *getRecord(int idx) const;
+
+	// SessionTick of the current record, like the live line tick count.  Files
+	// without a SessionTick var fall back to the record index.
+	int getRecordTick() const;
+
+	// step to the next record, false once we are past the end of the file
+	bool getNextData();
+
+	// Position so the next getNextData() returns the given record.  Seeking by tick
+	// or session time goes to the first record at or after it, false if the file
+	// ends before that.  The record is computed from the record rate and corrected
+	// by a short walk, or a binary search if the recording paused for longer (e.g.
+	// while the car was in the garage).
+	bool seekToRecord(int idx);
+	bool seekToTick(int tick);
+	bool seekToSessionTime(double sessionTime);
+
+protected:
+	int recordTick(int idx) const;
+	double recordSessionTime(int idx) const;
+
+	void *m_hFile = NULL;
+	void *m_hMemMapFile = NULL;
+	const char *m_base = NULL;
+	long long m_fileSize = 0;
+
+	const irsdk_header *m_header = NULL;
+	const irsdk_diskSubHeader *m_subHeader = NULL;
+	std::string m_sessionStr;
+
+	int m_recordCount = 0;
+	int m_recordIdx = -1;
+
+	int m_sessionTickOffset = -1;
+	int m_sessionTimeOffset = -1;
+};
+
+#endif // IRSDK_DISKCLIENT_H
@@ -0,0 +1,257 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <string.h>
+#include <assert.h>
+#include <algorithm>
+#include "irsdk_defines.h"
+#include "irsdk_client.h"
+#include "irsdk_samplestream.h"
+
+irsdkSampleStream::irsdkSampleStream(int capacity)
+{
+	m_capacity = 64;
+	while(m_capacity < capacity)
+		m_capacity <<= 1;
+	m_mask = m_capacity - 1;
+
+	m_ticks.resize(m_capacity);
+	m_times.resize(m_capacity);
+}
+
+irsdkSampleStream::irsdkSampleStream(const char *const *varNames, int numVarNames, int capacity)
+	: irsdkSampleStream(capacity)
+{
+	for(int i=0; i<numVarNames; i++)
+		addChannel(varNames[i]);
+}
+
+int irsdkSampleStream::addChannel(const char *varName)
+{
+	assert(m_end == 0 && m_queueHead.load() == 0);
+	assert((int)m_channels.size() < maxChannels);
+
+	Channel ch;
+	ch.name = varName;
+	m_channels.push_back(ch);
+	m_values.resize(m_channels.size() * m_capacity);
+
+	m_queueStride = (int)m_channels.size() * maxSamplesPerTick;
+	m_queueValues.resize((size_t)queueLines * m_queueStride);
+	return (int)m_channels.size() - 1;
+}
+
+void irsdkSampleStream::reset()
+{
+	m_end = 0;
+	m_lastTick = -1;
+	m_missedTicks = 0;
+}
+
+void irsdkSampleStream::resolve()
+{
+	irsdkClient &client = irsdkClient::instance();
+
+	m_captureStatusID = client.getStatusID();
+	m_captureSamplesPerTick = 0;
+	m_captureValidMask = 0;
+
+	const irsdk_header *header = client.getHeader();
+	m_captureTickRate = (header && header->tickRate > 0) ? header->tickRate : 60;
+
+	int idx = client.getVarIdx("SessionTick");
+	const irsdk_varHeader *vh = client.getVarHeaderEntry(idx);
+	m_sessionTickOffset = (vh && vh->type == irsdk_int) ? vh->offset : -1;
+	client.useVar(idx);
+
+	idx = client.getVarIdx("SessionTime");
+	vh = client.getVarHeaderEntry(idx);
+	m_sessionTimeOffset = (vh && vh->type == irsdk_double) ? vh->offset : -1;
+	client.useVar(idx);
+
+	// all channels have to agree on the number of sub-tick samples
+	for(int c=0; c<(int)m_channels.size(); c++)
+	{
+		Channel &ch = m_channels[c];
+		ch.offset = -1;
+
+		idx = client.getVarIdx(ch.name.c_str());
+		vh = client.getVarHeaderEntry(idx);
+		if(!vh || vh->type != irsdk_float || vh->count > maxSamplesPerTick)
+			continue;
+		if(m_captureSamplesPerTick && vh->count != m_captureSamplesPerTick)
+			continue;
+
+		m_captureSamplesPerTick = vh->count;
+		m_captureValidMask |= 1ull << c;
+		ch.offset = vh->offset;
+		client.useVar(idx);
+	}
+
+	if(!m_captureSamplesPerTick)
+		m_captureSamplesPerTick = 1;
+}
+
+void irsdkSampleStream::capture()
+{
+	irsdkClient &client = irsdkClient::instance();
+	const char *line = client.getLine();
+	if(!line)
+		return;
+
+	if(m_captureStatusID != client.getStatusID())
+		resolve();
+
+	if(m_sessionTickOffset < 0)
+		return;
+
+	const long long head = m_queueHead.load(std::memory_order_relaxed);
+	if(head - m_queueTail.load(std::memory_order_acquire) >= queueLines)
+	{
+		m_queueOverruns.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	const int slot = (int)(head % queueLines);
+	QueuedLine &q = m_queue[slot];
+	q.statusID = m_captureStatusID;
+	q.tick = *(const int *)(line + m_sessionTickOffset);
+	q.tickRate = m_captureTickRate;
+	q.samplesPerTick = m_captureSamplesPerTick;
+	q.time = m_sessionTimeOffset >= 0 ? *(const double *)(line + m_sessionTimeOffset) : (double)q.tick / q.tickRate;
+	q.validMask = m_captureValidMask;
+
+	float *dst = m_queueValues.data() + (size_t)slot * m_queueStride;
+	for(const Channel &ch : m_channels)
+	{
+		if(ch.offset >= 0)
+			memcpy(dst, line + ch.offset, q.samplesPerTick * sizeof(float));
+		else
+			memset(dst, 0, q.samplesPerTick * sizeof(float));
+		dst += q.samplesPerTick;
+	}
+
+	// update() picks the line up from here on
+	m_queueHead.store(head + 1, std::memory_order_release);
+}
+
+void irsdkSampleStream::update()
+{
+	const long long head = m_queueHead.load(std::memory_order_acquire);
+	long long tail = m_queueTail.load(std::memory_order_relaxed);
+	for(; tail < head; tail++)
+	{
+		const int slot = (int)(tail % queueLines);
+		append(m_queue[slot], m_queueValues.data() + (size_t)slot * m_queueStride);
+		m_queueTail.store(tail + 1, std::memory_order_release);
+	}
+}
+
+void irsdkSampleStream::append(const QueuedLine &q, const float *values)
+{
+	if(m_statusID != q.statusID)
+	{
+		m_statusID = q.statusID;
+		m_samplesPerTick = q.samplesPerTick;
+		m_validMask = q.validMask;
+		reset();
+	}
+
+	const int tick = q.tick;
+	if(tick == m_lastTick)
+		return;
+
+	// going backwards means a new session or a replay seek, start over
+	if(tick < m_lastTick)
+		reset();
+	else if(m_lastTick >= 0)
+		m_missedTicks += tick - m_lastTick - 1;
+	m_lastTick = tick;
+
+	const int n = m_samplesPerTick;
+	const double dt = 1.0 / ((double)q.tickRate * n);
+
+	for(int i=0; i<n; i++)
+	{
+		const long long slot = (m_end + i) & m_mask;
+		m_ticks[slot] = tick;
+		m_times[slot] = q.time - (n - 1 - i) * dt;
+	}
+
+	for(int c=0; c<(int)m_channels.size(); c++)
+	{
+		float *column = &m_values[c * m_capacity];
+		const float *src = values + c * n;
+		for(int i=0; i<n; i++)
+			column[(m_end + i) & m_mask] = src[i];
+	}
+
+	m_end += n;
+}
+
+long long irsdkSampleStream::findTick(int sessionTick) const
+{
+	long long lo = getOldest();
+	long long hi = m_end;
+	if(lo == hi || sessionTick < getTick(lo) || sessionTick > getTick(hi - 1))
+		return -1;
+
+	// ticks only go up within the ring
+	while(lo < hi)
+	{
+		const long long mid = lo + (hi - lo) / 2;
+		if(getTick(mid) < sessionTick)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return (lo < m_end && getTick(lo) == sessionTick) ? lo : -1;
+}
+
+int irsdkSampleStream::read(int ch, long long seq, int n, float *values, double *times) const
+{
+	if(seq < getOldest())
+	{
+		n -= (int)(getOldest() - seq);
+		seq = getOldest();
+	}
+	if(seq + n > m_end)
+		n = (int)(m_end - seq);
+	if(n <= 0)
+		return 0;
+
+	// at most two runs, split where the ring wraps
+	const float *column = &m_values[ch * m_capacity];
+	int done = 0;
+	while(done < n)
+	{
+		const long long slot = (seq + done) & m_mask;
+		const int run = (int)std::min<long long>(n - done, m_capacity - slot);
+		memcpy(values + done, column + slot, run * sizeof(float));
+		if(times)
+			memcpy(times + done, &m_times[slot], run * sizeof(double));
+		done += run;
+	}
+	return n;
+}
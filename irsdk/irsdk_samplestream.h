@@ -0,0 +1,152 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef IRSDK_SAMPLESTREAM_H
+#define IRSDK_SAMPLESTREAM_H
+
+#include <atomic>
+#include <vector>
+#include <string>
+
+// Unpacks the _ST vars (float[6], six 360 Hz samples per 60 Hz line) into a ring of
+// individual samples.
+//
+// The ring is a structure of arrays: one float per channel per sample, plus the
+// SessionTick and session time of every sample, so a graph or an analysis pass over
+// one signal only touches that signal's values.  Samples are addressed by a sequence
+// number that counts up from the first sample of the connection; anything older than
+// getOldest() has been overwritten.
+//
+// The sub-tick samples of a line are assumed to be evenly spread over the tick leading
+// up to it, the last one being at the line's SessionTime.
+//
+// Lines go in through capture(), on whichever thread runs waitForData(), and come out
+// of a small single producer/single consumer queue in update() on the reading thread.
+// The reader can fall behind by a few lines without losing any samples, which it
+// would if it only looked at the newest line it happens to pick up.
+class irsdkSampleStream
+{
+public:
+	// capacity is rounded up to a power of two
+	explicit irsdkSampleStream(int capacity = 4096);
+	irsdkSampleStream(const char *const *varNames, int numVarNames, int capacity = 4096);
+
+	// channels can only be added before the first capture()
+	int addChannel(const char *varName);
+	int getNumChannels() const { return (int)m_channels.size(); }
+	const char *getChannelName(int ch) const { return m_channels[ch].name.c_str(); }
+
+	// whether the connected sim (or file) provides this channel, it reads as zero otherwise
+	bool isChannelValid(int ch) const { return (m_validMask >> ch) & 1; }
+
+	// queue the samples of the client's current line; call once per waitForData(), on
+	// the thread that called it
+	void capture();
+
+	// append everything captured since the last update() to the ring
+	void update();
+	void reset();
+
+	// sequence numbers of the samples currently held, [getOldest(), getEnd())
+	long long getOldest() const { return m_end > (long long)m_capacity ? m_end - m_capacity : 0; }
+	long long getEnd() const { return m_end; }
+
+	// samples per tick of the current connection, typically 6
+	int getSamplesPerTick() const { return m_samplesPerTick; }
+
+	// first sample of the given SessionTick, or -1 if it isn't (or is no longer) held
+	long long findTick(int sessionTick) const;
+
+	float getValue(int ch, long long seq) const { return m_values[ch * m_capacity + (seq & m_mask)]; }
+	int getTick(long long seq) const { return m_ticks[seq & m_mask]; }
+	double getTime(long long seq) const { return m_times[seq & m_mask]; }
+
+	// copy the samples [seq, seq + n) of one channel, clamped to what is held, and return
+	// how many were copied; times may be NULL
+	int read(int ch, long long seq, int n, float *values, double *times = NULL) const;
+
+	// ticks that were skipped (dropped lines), leaving a hole in the stream
+	int getMissedTicks() const { return m_missedTicks; }
+
+	// lines capture() could not queue because update() fell more than a second behind
+	long long getQueueOverruns() const { return m_queueOverruns.load(); }
+
+protected:
+	static const int maxChannels = 64;
+	static const int maxSamplesPerTick = 16;
+	static const int queueLines = 64;
+
+	struct Channel
+	{
+		std::string name;
+		int offset = -1;	// in the line, -1 if not available
+	};
+
+	// one captured line, with its samples at m_queueValues[slot * m_queueStride]
+	struct QueuedLine
+	{
+		int statusID;
+		int tick;
+		int tickRate;
+		int samplesPerTick;
+		double time;
+		unsigned long long validMask;
+	};
+
+	void resolve();
+	void append(const QueuedLine &q, const float *values);
+
+	std::vector<Channel> m_channels;
+
+	// capture() side
+	int m_captureStatusID = -1;
+	int m_captureSamplesPerTick = 0;
+	int m_captureTickRate = 60;
+	unsigned long long m_captureValidMask = 0;
+	int m_sessionTickOffset = -1;
+	int m_sessionTimeOffset = -1;
+
+	// the queue between the two
+	QueuedLine m_queue[queueLines];
+	std::vector<float> m_queueValues;
+	int m_queueStride = 0;
+	std::atomic<long long> m_queueHead{ 0 };
+	std::atomic<long long> m_queueTail{ 0 };
+	std::atomic<long long> m_queueOverruns{ 0 };
+
+	int m_capacity;
+	long long m_mask;
+	std::vector<float> m_values;	// channel major, m_capacity per channel
+	std::vector<int> m_ticks;
+	std::vector<double> m_times;
+	long long m_end = 0;
+
+	int m_statusID = -1;
+	int m_samplesPerTick = 0;
+	unsigned long long m_validMask = 0;
+	int m_lastTick = -1;
+	int m_missedTicks = 0;
+};
+
+#endif // IRSDK_SAMPLESTREAM_H
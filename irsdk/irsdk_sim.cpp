@@ -0,0 +1,710 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include "irsdk_defines.h"
+#include "irsdk_sim.h"
+
+namespace
+{
+	struct simVar
+	{
+		const char *name;
+		int type;
+		int count;
+		const char *desc;
+		const char *unit;
+	};
+
+	// the subset of the sim's vars that iRon actually reads, in the sim's naming
+	enum simVarId
+	{
+		V_SessionTime,
+		V_SessionTick,
+		V_SessionNum,
+		V_SessionState,
+		V_SessionFlags,
+		V_SessionTimeRemain,
+		V_SessionLapsRemainEx,
+		V_SessionLapsTotal,
+		V_SessionTimeOfDay,
+		V_PaceMode,
+		V_DisplayUnits,
+		V_IsOnTrack,
+		V_IsOnTrackCar,
+		V_OnPitRoad,
+		V_PitsOpen,
+		V_PlayerCarIdx,
+		V_PlayerCarMyIncidentCount,
+		V_FuelLevel,
+		V_Throttle,
+		V_Brake,
+		V_Clutch,
+		V_Speed,
+		V_RPM,
+		V_Gear,
+		V_Lap,
+		V_LapBestLapTime,
+		V_TrackTemp,
+		V_TrackTempCrew,
+		V_AirTemp,
+		V_CarIdxLap,
+		V_CarIdxLapCompleted,
+		V_CarIdxLapDistPct,
+		V_CarIdxTrackSurface,
+		V_CarIdxOnPitRoad,
+		V_CarIdxPosition,
+		V_CarIdxClassPosition,
+		V_CarIdxClass,
+		V_CarIdxF2Time,
+		V_CarIdxBestLapTime,
+		V_CarIdxLastLapTime,
+		V_LatAccel_ST,
+		V_LongAccel_ST,
+		V_VelocityX_ST,
+		V_SteeringWheelTorque_ST,
+		V_LFSHshockVel_ST,
+		V_RFSHshockVel_ST,
+		V_LRSHshockVel_ST,
+		V_RRSHshockVel_ST,
+		V_Count
+	};
+
+	const simVar simVars[V_Count] =
+	{
+		{ "SessionTime", irsdk_double, 1, "Seconds since session start", "s" },
+		{ "SessionTick", irsdk_int, 1, "Current update number", "" },
+		{ "SessionNum", irsdk_int, 1, "Session number", "" },
+		{ "SessionState", irsdk_int, 1, "Session state", "irsdk_SessionState" },
+		{ "SessionFlags", irsdk_bitField, 1, "Session flags", "irsdk_Flags" },
+		{ "SessionTimeRemain", irsdk_double, 1, "Seconds left till session ends", "s" },
+		{ "SessionLapsRemainEx", irsdk_int, 1, "New improved laps left till session ends", "" },
+		{ "SessionLapsTotal", irsdk_int, 1, "Total number of laps in session", "" },
+		{ "SessionTimeOfDay", irsdk_float, 1, "Time of day in seconds", "s" },
+		{ "PaceMode", irsdk_int, 1, "Are we pacing or not", "irsdk_PaceMode" },
+		{ "DisplayUnits", irsdk_int, 1, "Default units for the user interface 0 = english 1 = metric", "" },
+		{ "IsOnTrack", irsdk_bool, 1, "1=Car on track physics running with player in car", "" },
+		{ "IsOnTrackCar", irsdk_bool, 1, "1=Car on track physics running", "" },
+		{ "OnPitRoad", irsdk_bool, 1, "Is the player car on pit road between the cones", "" },
+		{ "PitsOpen", irsdk_bool, 1, "True if pit stop is allowed for the current player", "" },
+		{ "PlayerCarIdx", irsdk_int, 1, "Players carIdx", "" },
+		{ "PlayerCarMyIncidentCount", irsdk_int, 1, "Players own incident count for this session", "" },
+		{ "FuelLevel", irsdk_float, 1, "Liters of fuel remaining", "l" },
+		{ "Throttle", irsdk_float, 1, "0=off throttle to 1=full throttle", "%" },
+		{ "Brake", irsdk_float, 1, "0=brake released to 1=max pedal force", "%" },
+		{ "Clutch", irsdk_float, 1, "0=disengaged to 1=fully engaged", "%" },
+		{ "Speed", irsdk_float, 1, "GPS vehicle speed", "m/s" },
+		{ "RPM", irsdk_float, 1, "Engine rpm", "revs/min" },
+		{ "Gear", irsdk_int, 1, "-1=reverse  0=neutral  1..n=current gear", "" },
+		{ "Lap", irsdk_int, 1, "Laps started count", "" },
+		{ "LapBestLapTime", irsdk_float, 1, "Players best lap time", "s" },
+		{ "TrackTemp", irsdk_float, 1, "Deprecated  set to TrackTempCrew", "C" },
+		{ "TrackTempCrew", irsdk_float, 1, "Temperature of track measured by crew around track", "C" },
+		{ "AirTemp", irsdk_float, 1, "Temperature of air at start/finish line", "C" },
+		{ "CarIdxLap", irsdk_int, IRSDK_SIM_MAX_CARS, "Laps started by car index", "" },
+		{ "CarIdxLapCompleted", irsdk_int, IRSDK_SIM_MAX_CARS, "Laps completed by car index", "" },
+		{ "CarIdxLapDistPct", irsdk_float, IRSDK_SIM_MAX_CARS, "Percentage distance around lap by car index", "%" },
+		{ "CarIdxTrackSurface", irsdk_int, IRSDK_SIM_MAX_CARS, "Track surface type by car index", "irsdk_TrkLoc" },
+		{ "CarIdxOnPitRoad", irsdk_bool, IRSDK_SIM_MAX_CARS, "On pit road between the cones by car index", "" },
+		{ "CarIdxPosition", irsdk_int, IRSDK_SIM_MAX_CARS, "Cars position in race by car index", "" },
+		{ "CarIdxClassPosition", irsdk_int, IRSDK_SIM_MAX_CARS, "Cars class position in race by car index", "" },
+		{ "CarIdxClass", irsdk_int, IRSDK_SIM_MAX_CARS, "Cars class id by car index", "" },
+		{ "CarIdxF2Time", irsdk_float, IRSDK_SIM_MAX_CARS, "Race time behind leader or fastest lap time otherwise", "s" },
+		{ "CarIdxBestLapTime", irsdk_float, IRSDK_SIM_MAX_CARS, "Cars best lap time", "s" },
+		{ "CarIdxLastLapTime", irsdk_float, IRSDK_SIM_MAX_CARS, "Cars last lap time", "s" },
+		{ "LatAccel_ST", irsdk_float, 6, "Lateral acceleration (including gravity) at 360 Hz", "m/s^2" },
+		{ "LongAccel_ST", irsdk_float, 6, "Longitudinal acceleration (including gravity) at 360 Hz", "m/s^2" },
+		{ "VelocityX_ST", irsdk_float, 6, "X velocity", "m/s at 360 Hz" },
+		{ "SteeringWheelTorque_ST", irsdk_float, 6, "Output torque on steering shaft at 360 Hz", "N*m" },
+		{ "LFSHshockVel_ST", irsdk_float, 6, "LFSH shock velocity at 360 Hz", "m/s" },
+		{ "RFSHshockVel_ST", irsdk_float, 6, "RFSH shock velocity at 360 Hz", "m/s" },
+		{ "LRSHshockVel_ST", irsdk_float, 6, "LRSH shock velocity at 360 Hz", "m/s" },
+		{ "RRSHshockVel_ST", irsdk_float, 6, "RRSH shock velocity at 360 Hz", "m/s" },
+	};
+
+	const int paceCarIdx = 0;
+	const int playerCarIdx = 1;
+	const double fuelMaxLtr = 110.0;
+	const double fuelPerLap = 2.6;
+	const double raceLength = 3600.0;
+
+	void appendf(std::string &s, const char *fmt, ...)
+	{
+		char buf[512];
+		va_list args;
+		va_start(args, fmt);
+		vsnprintf(buf, sizeof(buf), fmt, args);
+		va_end(args);
+		s += buf;
+	}
+
+	// Simple car model: every car laps at a constant pace (slower cars further back, slower
+	// classes slower still) and dives into the pits every dozen laps or so.
+	struct carState
+	{
+		int lap = 0;			// laps started
+		int lapCompleted = 0;
+		float lapDistPct = 0;
+		bool onPitRoad = false;
+		double dist = 0;		// total distance in laps, used to order the field
+		float lastLapTime = 0;
+		float bestLapTime = 0;
+	};
+
+	int carClass(const irsdkSimConfig &cfg, int carIdx)
+	{
+		if(carIdx == paceCarIdx)
+			return 11;
+		return 100 + (carIdx - 1) % std::max(1, cfg.numClasses);
+	}
+
+	double carLapTime(const irsdkSimConfig &cfg, int carIdx)
+	{
+		return 90.0 + carIdx * 0.11 + (carClass(cfg, carIdx) - 100) * 6.0;
+	}
+
+	carState computeCar(const irsdkSimConfig &cfg, int carIdx, double sessionTime)
+	{
+		carState c;
+		if(carIdx == paceCarIdx || carIdx > cfg.numCars)
+			return c;
+
+		const double lapTime = carLapTime(cfg, carIdx);
+		c.dist = std::max(0.0, sessionTime / lapTime - carIdx * 0.004);
+		c.lapCompleted = (int)c.dist;
+		c.lap = c.lapCompleted + 1;
+		c.lapDistPct = (float)(c.dist - c.lapCompleted);
+
+		const int pitEvery = 12 + carIdx % 7;
+		c.onPitRoad = c.lapCompleted > 0 && ((c.lap % pitEvery == 0 && c.lapDistPct > 0.94f) || (c.lap % pitEvery == 1 && c.lapDistPct < 0.06f));
+
+		if(c.lapCompleted > 0)
+		{
+			c.lastLapTime = (float)(lapTime + 0.25 * sin(c.lapCompleted * 1.7 + carIdx));
+			c.bestLapTime = (float)(lapTime - (c.lapCompleted > 1 ? 0.25 : 0.0));
+		}
+		return c;
+	}
+
+	// order of carIdx by distance covered, leader first
+	int sortField(const irsdkSimConfig &cfg, const carState *cars, int *order)
+	{
+		int n = 0;
+		for(int i=1; i<=cfg.numCars && i<IRSDK_SIM_MAX_CARS; i++)
+			order[n++] = i;
+		std::sort(order, order+n, [cars](int a, int b) { return cars[a].dist > cars[b].dist; });
+		return n;
+	}
+}
+
+std::string irsdkSim::buildSessionStr(const irsdkSimConfig &cfg, double sessionTime)
+{
+	static const char *sessionNames[] = { "PRACTICE", "QUALIFY", "RACE" };
+	static const char *sessionTypes[] = { "Practice", "Lone Qualify", "Race" };
+	static const char *licenses[] = { "R", "D", "C", "B", "A", "P" };
+	static const char *licColors[] = { "0xfc0706", "0xff8c00", "0xfeec04", "0x00c702", "0x0153db", "0x000000" };
+
+	carState cars[IRSDK_SIM_MAX_CARS];
+	for(int i=0; i<IRSDK_SIM_MAX_CARS; i++)
+		cars[i] = computeCar(cfg, i, sessionTime);
+
+	int order[IRSDK_SIM_MAX_CARS];
+	const int numOrdered = sortField(cfg, cars, order);
+
+	std::string s;
+	s.reserve(64 * 1024);
+
+	s += "---\n";
+	s += "WeekendInfo:\n";
+	s += " TrackName: simtrack\n";
+	s += " TrackID: 1\n";
+	s += " TrackLength: 4.02 km\n";
+	s += " TrackDisplayName: Sim Raceway\n";
+	s += " TrackCity: Nowhere\n";
+	s += " TrackNumTurns: 14\n";
+	s += " SeriesID: 228\n";
+	s += " SeasonID: 3861\n";
+	s += " SessionID: 197865432\n";
+	s += " SubSessionID: 51234567\n";
+	s += " LeagueID: 0\n";
+	appendf(s, " TeamRacing: %d\n", cfg.teamEvent ? 1 : 0);
+	appendf(s, " NumCarClasses: %d\n", std::max(1, cfg.numClasses));
+	s += " WeekendOptions:\n";
+	appendf(s, "  NumStarters: %d\n", cfg.numCars);
+	s += "  StartingGrid: 2x2 inline pole on left\n";
+	s += "  QualifyScoring: best lap\n";
+	s += "  IsFixedSetup: 1\n";
+	s += "  TimeOfDay: 2:00 pm\n";
+	s += "\n";
+
+	s += "SessionInfo:\n";
+	s += " Sessions:\n";
+	for(int session=0; session<3; session++)
+	{
+		appendf(s, " - SessionNum: %d\n", session);
+		if(session == 2)
+		{
+			s += "   SessionLaps: unlimited\n";
+			appendf(s, "   SessionTime: %.4f sec\n", raceLength);
+		}
+		else
+		{
+			s += "   SessionLaps: unlimited\n";
+			s += "   SessionTime: 1200.0000 sec\n";
+		}
+		s += "   SessionNumLapsToAvg: 0\n";
+		appendf(s, "   SessionType: %s\n", sessionTypes[session]);
+		s += "   SessionTrackRubberState: moderate usage\n";
+		appendf(s, "   SessionName: %s\n", sessionNames[session]);
+
+		// only sessions we've been through (or are in) have results
+		if(session > cfg.sessionNum || numOrdered == 0 || (session == cfg.sessionNum && sessionTime < 1.0))
+		{
+			s += "   ResultsPositions:\n";
+			continue;
+		}
+
+		s += "   ResultsPositions:\n";
+		int classPos[8] = {};
+		for(int pos=0; pos<numOrdered; pos++)
+		{
+			const int carIdx = order[pos];
+			const carState &c = cars[carIdx];
+			const int cls = (carClass(cfg, carIdx) - 100) & 7;
+			appendf(s, "   - Position: %d\n", pos + 1);
+			appendf(s, "     ClassPosition: %d\n", classPos[cls]++);
+			appendf(s, "     CarIdx: %d\n", carIdx);
+			appendf(s, "     Lap: %d\n", c.lapCompleted);
+			appendf(s, "     Time: %.4f\n", session == 2 ? (cars[order[0]].dist - c.dist) * carLapTime(cfg, carIdx) : c.bestLapTime);
+			appendf(s, "     FastestLap: %d\n", c.lapCompleted > 1 ? 2 : c.lapCompleted);
+			appendf(s, "     FastestTime: %.4f\n", c.bestLapTime > 0 ? c.bestLapTime : -1.0f);
+			appendf(s, "     LastTime: %.4f\n", c.lastLapTime > 0 ? c.lastLapTime : -1.0f);
+			appendf(s, "     LapsLed: %d\n", pos == 0 ? c.lapCompleted : 0);
+			appendf(s, "     LapsComplete: %d\n", c.lapCompleted);
+			s += "     JokerLapsComplete: 0\n";
+			s += "     LapsDriven: 0.000\n";
+			appendf(s, "     Incidents: %d\n", (carIdx * 7 + c.lapCompleted) % 9);
+			s += "     ReasonOutId: 0\n";
+			s += "     ReasonOutStr: Running\n";
+		}
+		s += "   ResultsFastestLap:\n";
+		appendf(s, "   - CarIdx: %d\n", order[0]);
+		s += "     FastestLap: 2\n";
+		appendf(s, "     FastestTime: %.4f\n", cars[order[0]].bestLapTime);
+		s += "   ResultsAverageLapTime: -1.0000\n";
+		s += "   ResultsNumCautionFlags: 0\n";
+		s += "   ResultsNumCautionLaps: 0\n";
+		s += "   ResultsNumLeadChanges: 0\n";
+		s += "   ResultsLapsComplete: -1\n";
+		s += "   ResultsOfficial: 0\n";
+	}
+	s += "\n";
+
+	if(cfg.sessionNum >= 2 && numOrdered > 0)
+	{
+		// grid order is by pace, which is just the car index in our model
+		s += "QualifyResultsInfo:\n";
+		s += " Results:\n";
+		for(int pos=0; pos<numOrdered; pos++)
+		{
+			const int carIdx = pos + 1;
+			appendf(s, " - Position: %d\n", pos);
+			appendf(s, "   ClassPosition: %d\n", pos / std::max(1, cfg.numClasses));
+			appendf(s, "   CarIdx: %d\n", carIdx);
+			s += "   FastestLap: 2\n";
+			appendf(s, "   FastestTime: %.4f\n", carLapTime(cfg, carIdx) - 0.4);
+		}
+		s += "\n";
+	}
+
+	s += "DriverInfo:\n";
+	appendf(s, " DriverCarIdx: %d\n", playerCarIdx);
+	s += " DriverUserID: 100001\n";
+	s += " PaceCarIdx: 0\n";
+	s += " DriverHeadPosX: -0.042\n";
+	s += " DriverCarIdleRPM: 900.000\n";
+	s += " DriverCarRedLine: 7300.000\n";
+	s += " DriverCarEngCylinderCount: 8\n";
+	appendf(s, " DriverCarFuelMaxLtr: %.3f\n", fuelMaxLtr);
+	s += " DriverCarMaxFuelPct: 1.000\n";
+	s += " DriverCarGearNumForward: 6\n";
+	s += " DriverCarSLFirstRPM: 5800.000\n";
+	s += " DriverCarSLShiftRPM: 6900.000\n";
+	s += " DriverCarSLLastRPM: 7100.000\n";
+	s += " DriverCarSLBlinkRPM: 7200.000\n";
+	s += " DriverCarVersion: 2022.08.29.01\n";
+	s += " DriverPitTrkPct: 0.934215\n";
+	s += " DriverCarEstLapTime: 89.6000\n";
+	s += " DriverSetupName: baseline.sto\n";
+	s += " DriverSetupIsModified: 0\n";
+	s += " DriverSetupLoadTypeName: fixed\n";
+	s += " DriverSetupPassedTech: 1\n";
+	s += " DriverIncidentCount: 0\n";
+	s += " Drivers:\n";
+	for(int carIdx=0; carIdx<=cfg.numCars && carIdx<IRSDK_SIM_MAX_CARS; carIdx++)
+	{
+		const bool isPaceCar = carIdx == paceCarIdx;
+		const int cls = carClass(cfg, carIdx);
+		const int lic = isPaceCar ? 0 : 1 + carIdx % 5;
+
+		appendf(s, " - CarIdx: %d\n", carIdx);
+		if(isPaceCar)
+			s += "   UserName: Pace Car\n";
+		else
+			appendf(s, "   UserName: Sim Driver %d\n", carIdx);
+		s += "   AbbrevName: \n";
+		s += "   Initials: \n";
+		appendf(s, "   UserID: %d\n", isPaceCar ? -1 : 100000 + carIdx);
+		appendf(s, "   TeamID: %d\n", cfg.teamEvent && !isPaceCar ? 200000 + carIdx : 0);
+		if(cfg.teamEvent && !isPaceCar)
+			appendf(s, "   TeamName: Sim Racing Team %d\n", carIdx);
+		else if(isPaceCar)
+			s += "   TeamName: Pace Car\n";
+		else
+			appendf(s, "   TeamName: Sim Driver %d\n", carIdx);
+		appendf(s, "   CarNumber: \"%d\"\n", carIdx);
+		appendf(s, "   CarNumberRaw: %d\n", carIdx);
+		appendf(s, "   CarPath: %s\n", isPaceCar ? "safety pcporsche911cup" : "simcar");
+		appendf(s, "   CarClassID: %d\n", cls);
+		appendf(s, "   CarID: %d\n", isPaceCar ? 1 : 500 + cls);
+		appendf(s, "   CarIsPaceCar: %d\n", isPaceCar ? 1 : 0);
+		s += "   CarIsAI: 0\n";
+		appendf(s, "   CarScreenName: %s\n", isPaceCar ? "safety pcporsche911cup" : "Sim Car");
+		appendf(s, "   CarScreenNameShort: %s\n", isPaceCar ? "safety pcporsche911cup" : "Sim Car");
+		appendf(s, "   CarClassShortName: %s%d\n", isPaceCar ? "Pace" : "Class", cls - 100);
+		s += "   CarClassRelSpeed: 0\n";
+		s += "   CarClassLicenseLevel: 0\n";
+		s += "   CarClassMaxFuelPct: 1.000 %\n";
+		s += "   CarClassWeightPenalty: 0.000 kg\n";
+		s += "   CarClassPowerAdjust: 0.000 %\n";
+		s += "   CarClassDryTireSetLimit: 0 %\n";
+		s += "   CarClassColor: 0xffffff\n";
+		appendf(s, "   CarClassEstLapTime: %.4f\n", isPaceCar ? 120.0 : carLapTime(cfg, carIdx) - 0.5);
+		appendf(s, "   IRating: %d\n", isPaceCar ? 0 : 1350 + (carIdx * 397) % 3700);
+		appendf(s, "   LicLevel: %d\n", lic * 4);
+		appendf(s, "   LicSubLevel: %d\n", isPaceCar ? 1 : 100 + (carIdx * 53) % 399);
+		appendf(s, "   LicString: %s %d.%02d\n", licenses[lic], isPaceCar ? 0 : 1 + (carIdx * 53) % 399 / 100, (carIdx * 53) % 100);
+		appendf(s, "   LicColor: %s\n", licColors[lic]);
+		s += "   IsSpectator: 0\n";
+		s += "   CarDesignStr: 1,ffffff,000000,000000\n";
+		s += "   HelmetDesignStr: 1,ffffff,000000,000000\n";
+		s += "   SuitDesignStr: 1,ffffff,000000,000000\n";
+		s += "   CarNumberDesignStr: 0,0,ffffff,777777,000000\n";
+		s += "   CarSponsor_1: 0\n";
+		s += "   CarSponsor_2: 0\n";
+		s += "   ClubName: Sim Club\n";
+		s += "   DivisionName: Division 1\n";
+		appendf(s, "   CurDriverIncidentCount: %d\n", isPaceCar ? 0 : (carIdx * 7 + cars[carIdx].lapCompleted) % 9);
+		appendf(s, "   TeamIncidentCount: %d\n", isPaceCar ? 0 : (carIdx * 7 + cars[carIdx].lapCompleted) % 9);
+	}
+	s += "\n";
+
+	s += "SplitTimeInfo:\n";
+	s += " Sectors:\n";
+	s += " - SectorNum: 0\n";
+	s += "   SectorStartPct: 0.000000\n";
+	s += " - SectorNum: 1\n";
+	s += "   SectorStartPct: 0.333333\n";
+	s += " - SectorNum: 2\n";
+	s += "   SectorStartPct: 0.666667\n";
+	s += "\n";
+	s += "...\n";
+
+	return s;
+}
+
+bool irsdkSim::start(const irsdkSimConfig &cfg)
+{
+	stop();
+
+	m_cfg = cfg;
+	m_cfg.tickRate = std::max(1, m_cfg.tickRate);
+	m_cfg.numCars = std::min(std::max(0, m_cfg.numCars), IRSDK_SIM_MAX_CARS-1);
+	m_cfg.numBuf = std::min(std::max(1, m_cfg.numBuf), IRSDK_MAX_BUFS);
+	m_cfg.numVars = std::max((int)V_Count, m_cfg.numVars);
+	m_cfg.numClasses = std::max(1, m_cfg.numClasses);
+
+	// line layout, 16 byte aligned like the sim's
+	m_varOffsets = new int[m_cfg.numVars];
+	int bufLen = 0;
+	for(int i=0; i<m_cfg.numVars; i++)
+	{
+		const int type = i < V_Count ? simVars[i].type : irsdk_float;
+		const int count = i < V_Count ? simVars[i].count : 1;
+		const int bytes = irsdk_VarTypeBytes[type];
+		bufLen = (bufLen + bytes - 1) / bytes * bytes;
+		m_varOffsets[i] = bufLen;
+		bufLen += bytes * count;
+	}
+	bufLen = (bufLen + 15) & ~15;
+
+	// memory layout: header, var headers, session string, line buffers
+	m_sessionInfoMax = 512 * 1024;
+	const int varHeaderOffset = 144;
+	const int sessionInfoOffset = varHeaderOffset + m_cfg.numVars * (int)sizeof(irsdk_varHeader);
+	const int bufOffset = (sessionInfoOffset + m_sessionInfoMax + 15) & ~15;
+	const int memSize = bufOffset + bufLen * m_cfg.numBuf;
+
+	m_memSize = memSize;
+	if(!openSharedMem(memSize))
+	{
+		stop();
+		return false;
+	}
+
+	memset(m_sharedMem, 0, memSize);
+	m_header = (irsdk_header *)m_sharedMem;
+	m_header->ver = IRSDK_VER;
+	m_header->tickRate = m_cfg.tickRate;
+	m_header->sessionInfoOffset = sessionInfoOffset;
+	m_header->numVars = m_cfg.numVars;
+	m_header->varHeaderOffset = varHeaderOffset;
+	m_header->numBuf = m_cfg.numBuf;
+	m_header->bufLen = bufLen;
+	for(int i=0; i<m_cfg.numBuf; i++)
+	{
+		m_header->varBuf[i].tickCount = 0;
+		m_header->varBuf[i].bufOffset = bufOffset + i * bufLen;
+	}
+
+	layoutVars();
+	writeSessionStr(0.0);
+
+	for(int i=0; i<historyLen; i++)
+	{
+		m_publishTick[i] = -1;
+		m_publishTime[i] = 0;
+	}
+	m_tickCount = 0;
+
+	m_running = true;
+	m_thread = std::thread(&irsdkSim::run, this);
+	return true;
+}
+
+void irsdkSim::stop()
+{
+	m_running = false;
+	if(m_thread.joinable())
+		m_thread.join();
+
+	if(m_header)
+		m_header->status = 0;
+
+	closeSharedMem();
+
+	delete[] m_varOffsets;
+
+	m_varOffsets = nullptr;
+	m_sharedMem = nullptr;
+	m_header = nullptr;
+	m_memSize = 0;
+}
+
+long long irsdkSim::getPublishTime(int tick) const
+{
+	const int slot = tick & (historyLen-1);
+	const long long t = m_publishTime[slot];
+	return m_publishTick[slot] == tick ? t : 0;
+}
+
+void irsdkSim::layoutVars()
+{
+	irsdk_varHeader *vh = (irsdk_varHeader *)(m_sharedMem + m_header->varHeaderOffset);
+	for(int i=0; i<m_cfg.numVars; i++)
+	{
+		vh[i].clear();
+		vh[i].offset = m_varOffsets[i];
+		if(i < V_Count)
+		{
+			vh[i].type = simVars[i].type;
+			vh[i].count = simVars[i].count;
+			snprintf(vh[i].name, IRSDK_MAX_STRING, "%s", simVars[i].name);
+			snprintf(vh[i].desc, IRSDK_MAX_DESC, "%s", simVars[i].desc);
+			snprintf(vh[i].unit, IRSDK_MAX_STRING, "%s", simVars[i].unit);
+		}
+		else
+		{
+			vh[i].type = irsdk_float;
+			vh[i].count = 1;
+			snprintf(vh[i].name, IRSDK_MAX_STRING, "SimPad%04d", i - V_Count);
+			snprintf(vh[i].desc, IRSDK_MAX_DESC, "Padding var");
+		}
+	}
+}
+
+void irsdkSim::writeSessionStr(double sessionTime)
+{
+	const std::string s = buildSessionStr(m_cfg, sessionTime);
+	const int len = std::min((int)s.length(), m_sessionInfoMax-1);
+
+	char *dst = m_sharedMem + m_header->sessionInfoOffset;
+	memcpy(dst, s.c_str(), len);
+	dst[len] = '\0';
+
+	m_header->sessionInfoLen = len;
+	m_header->sessionInfoUpdate++;
+}
+
+void irsdkSim::writeLine(char *line, int tick)
+{
+	const double t = (double)tick / m_cfg.tickRate;
+
+	#define SIMVAR(type_, id_) ((type_ *)(line + m_varOffsets[id_]))
+
+	carState cars[IRSDK_SIM_MAX_CARS];
+	for(int i=0; i<IRSDK_SIM_MAX_CARS; i++)
+		cars[i] = computeCar(m_cfg, i, t);
+
+	int order[IRSDK_SIM_MAX_CARS];
+	const int numOrdered = sortField(m_cfg, cars, order);
+
+	const int racing = m_cfg.sessionNum == 2;
+	const carState &me = cars[playerCarIdx];
+
+	*SIMVAR(double, V_SessionTime) = t;
+	*SIMVAR(int, V_SessionTick) = tick;
+	*SIMVAR(int, V_SessionNum) = m_cfg.sessionNum;
+	*SIMVAR(int, V_SessionState) = irsdk_StateRacing;
+	*SIMVAR(int, V_SessionFlags) = irsdk_green;
+	*SIMVAR(double, V_SessionTimeRemain) = std::max(0.0, raceLength - t);
+	*SIMVAR(int, V_SessionLapsRemainEx) = IRSDK_UNLIMITED_LAPS;
+	*SIMVAR(int, V_SessionLapsTotal) = IRSDK_UNLIMITED_LAPS;
+	*SIMVAR(float, V_SessionTimeOfDay) = (float)(14 * 3600 + t);
+	*SIMVAR(int, V_PaceMode) = irsdk_PaceModeNotPacing;
+	*SIMVAR(int, V_DisplayUnits) = 1;
+	*SIMVAR(bool, V_IsOnTrack) = true;
+	*SIMVAR(bool, V_IsOnTrackCar) = true;
+	*SIMVAR(bool, V_OnPitRoad) = me.onPitRoad;
+	*SIMVAR(bool, V_PitsOpen) = true;
+	*SIMVAR(int, V_PlayerCarIdx) = playerCarIdx;
+	*SIMVAR(int, V_PlayerCarMyIncidentCount) = me.lapCompleted / 10;
+	*SIMVAR(float, V_FuelLevel) = (float)(fuelMaxLtr - fmod(me.dist * fuelPerLap, fuelMaxLtr - 5.0));
+
+	const float corner = (float)sin(me.lapDistPct * 6.283185 * 7.0);
+	*SIMVAR(float, V_Throttle) = corner > 0 ? 1.0f : 1.0f + corner;
+	*SIMVAR(float, V_Brake) = corner < -0.5f ? -corner : 0.0f;
+	*SIMVAR(float, V_Clutch) = 1.0f;
+	*SIMVAR(float, V_Speed) = 40.0f + 20.0f * corner;
+	*SIMVAR(float, V_RPM) = 5500.0f + 1500.0f * corner;
+	*SIMVAR(int, V_Gear) = 3 + (int)(2.0f * corner);
+	*SIMVAR(int, V_Lap) = me.lap;
+	*SIMVAR(float, V_LapBestLapTime) = me.bestLapTime;
+	*SIMVAR(float, V_TrackTemp) = 38.5f;
+	*SIMVAR(float, V_TrackTempCrew) = 38.5f;
+	*SIMVAR(float, V_AirTemp) = 24.0f;
+
+	int classPos[8] = {};
+	for(int pos=0; pos<IRSDK_SIM_MAX_CARS; pos++)
+	{
+		SIMVAR(int, V_CarIdxPosition)[pos] = 0;
+		SIMVAR(int, V_CarIdxClassPosition)[pos] = 0;
+	}
+	for(int pos=0; pos<numOrdered; pos++)
+	{
+		const int carIdx = order[pos];
+		SIMVAR(int, V_CarIdxPosition)[carIdx] = racing ? pos + 1 : 0;
+		SIMVAR(int, V_CarIdxClassPosition)[carIdx] = racing ? ++classPos[(carClass(m_cfg, carIdx) - 100) & 7] : 0;
+	}
+
+	for(int carIdx=0; carIdx<IRSDK_SIM_MAX_CARS; carIdx++)
+	{
+		const carState &c = cars[carIdx];
+		const bool inWorld = carIdx != paceCarIdx && carIdx <= m_cfg.numCars;
+		const int leader = numOrdered ? order[0] : 0;
+
+		SIMVAR(int, V_CarIdxLap)[carIdx] = inWorld ? c.lap : -1;
+		SIMVAR(int, V_CarIdxLapCompleted)[carIdx] = inWorld ? c.lapCompleted : -1;
+		SIMVAR(float, V_CarIdxLapDistPct)[carIdx] = inWorld ? c.lapDistPct : -1.0f;
+		SIMVAR(int, V_CarIdxTrackSurface)[carIdx] = !inWorld ? irsdk_NotInWorld : (c.onPitRoad ? irsdk_AproachingPits : irsdk_OnTrack);
+		SIMVAR(bool, V_CarIdxOnPitRoad)[carIdx] = c.onPitRoad;
+		SIMVAR(int, V_CarIdxClass)[carIdx] = inWorld ? carClass(m_cfg, carIdx) : 0;
+		SIMVAR(float, V_CarIdxF2Time)[carIdx] = inWorld ? (float)((cars[leader].dist - c.dist) * carLapTime(m_cfg, carIdx)) : 0.0f;
+		SIMVAR(float, V_CarIdxBestLapTime)[carIdx] = inWorld ? c.bestLapTime : -1.0f;
+		SIMVAR(float, V_CarIdxLastLapTime)[carIdx] = inWorld ? c.lastLapTime : -1.0f;
+	}
+
+	// six 360 Hz sub-samples per line, oldest first
+	for(int i=0; i<6; i++)
+	{
+		const double st = t - (5 - i) / 360.0;
+		SIMVAR(float, V_LatAccel_ST)[i] = (float)(9.81 * 1.8 * sin(st * 0.9));
+		SIMVAR(float, V_LongAccel_ST)[i] = (float)(9.81 * 1.2 * cos(st * 1.3));
+		SIMVAR(float, V_VelocityX_ST)[i] = (float)(45.0 + 15.0 * sin(st * 0.7));
+		SIMVAR(float, V_SteeringWheelTorque_ST)[i] = (float)(12.0 * sin(st * 2.1) + 0.6 * sin(st * 311.0));
+		SIMVAR(float, V_LFSHshockVel_ST)[i] = (float)(0.05 * sin(st * 97.0));
+		SIMVAR(float, V_RFSHshockVel_ST)[i] = (float)(0.05 * sin(st * 101.0));
+		SIMVAR(float, V_LRSHshockVel_ST)[i] = (float)(0.04 * sin(st * 89.0));
+		SIMVAR(float, V_RRSHshockVel_ST)[i] = (float)(0.04 * sin(st * 83.0));
+	}
+
+	for(int i=V_Count; i<m_cfg.numVars; i++)
+		*SIMVAR(float, i) = (float)(tick + i);
+
+	#undef SIMVAR
+}
+
+void irsdkSim::run()
+{
+	const long long freq = clockFreq();
+	const long long start = clockNow();
+
+	beginTiming();
+
+	m_header->status = irsdk_stConnected;
+
+	const int updateTicks = m_cfg.sessionUpdateSecs * m_cfg.tickRate;
+
+	for(int tick=1; m_running; tick++)
+	{
+		// absolute schedule, so we don't drift when a tick runs late
+		waitUntil(start + (long long)tick * freq / m_cfg.tickRate);
+
+		if(updateTicks > 0 && tick % updateTicks == 0)
+			writeSessionStr((double)tick / m_cfg.tickRate);
+
+		// Write into the oldest buffer.  Its tick count is invalidated first, so a reader
+		// that overlaps the write always sees the count move and throws the copy away.
+		irsdk_varBuf &vb = m_header->varBuf[tick % m_cfg.numBuf];
+		*(volatile int *)&vb.tickCount = -1;
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		writeLine(m_sharedMem + vb.bufOffset, tick);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		*(volatile int *)&vb.tickCount = tick;
+
+		const int slot = tick & (historyLen-1);
+		m_publishTick[slot] = -1;
+		m_publishTime[slot] = clockNow();
+		m_publishTick[slot] = tick;
+		m_tickCount = tick;
+
+		signalDataValid();
+	}
+
+	endTiming();
+}
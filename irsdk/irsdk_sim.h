@@ -0,0 +1,126 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef IRSDK_SIM_H
+#define IRSDK_SIM_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+struct irsdk_header;
+
+// Stand-in for the sim's side of the live telemetry interface.
+//
+// Lays out an irsdk_header, a var header table, the session info string and
+// rotating line buffers in the same named memory mapped file the sim uses, and
+// signals the data valid event on every tick.  This lets irsdk_startup(),
+// irsdk_waitForDataReady(), irsdkClient and ir_tick() run (and be measured)
+// without iRacing.  Car movement is a simple deterministic model, good enough
+// to drive positions, laps, pit stops and session info updates.
+//
+// Only one producer can own the shared memory, so don't start this while the
+// real sim is running.
+//
+// The layout, tick schedule and car model don't depend on the platform.  Creating
+// the shared memory, signalling readers and the clock are the few members listed
+// under "platform side" below, implemented in irsdk_sim_win32.cpp for Windows and
+// in irsdk_sim_posix.cpp for Linux (shm_open() and mmap(), a futex for the event,
+// clock_gettime()).
+
+static const int IRSDK_SIM_MAX_CARS = 64;
+
+struct irsdkSimConfig
+{
+	int tickRate = 60;			// ticks per second, the sim uses 60 (or 360 when logging at full rate)
+	int numCars = 20;			// cars entered, not counting the pace car (< IRSDK_SIM_MAX_CARS)
+	int numVars = 0;			// total vars to publish, padded with dummy floats beyond the built-in set
+	int numBuf = 3;				// line buffers to rotate through (<= IRSDK_MAX_BUFS)
+	int numClasses = 1;			// car classes in the field
+	bool teamEvent = false;		// give every car its own team name
+	int sessionNum = 2;			// active session, 0 = practice, 1 = qualify, 2 = race
+	int sessionUpdateSecs = 5;	// republish the session string this often, 0 to never update it
+};
+
+class irsdkSim
+{
+public:
+	irsdkSim() {}
+	~irsdkSim() { stop(); }
+
+	// create the shared memory and event, and start publishing on a background thread
+	bool start(const irsdkSimConfig &cfg);
+	void stop();
+	bool isRunning() const { return m_running; }
+
+	// ticks published so far
+	int getTickCount() const { return m_tickCount; }
+
+	// clockNow() value at which the tick was published, or 0 if it rotated out
+	// of the (short) history already
+	long long getPublishTime(int tick) const;
+
+	// The clock publish times are taken with, in clockFreq() counts per second.
+	// Same as the reader's line times: QueryPerformanceCounter() on Windows,
+	// CLOCK_MONOTONIC nanoseconds on Linux.
+	static long long clockNow();
+	static long long clockFreq();
+
+	// the session info string for the config at the given session time
+	static std::string buildSessionStr(const irsdkSimConfig &cfg, double sessionTime);
+
+protected:
+	void run();
+	void layoutVars();
+	void writeLine(char *line, int tick);
+	void writeSessionStr(double sessionTime);
+
+	// platform side
+	bool openSharedMem(int memSize);		// create and map the named shared memory into m_sharedMem, and the data valid event
+	void closeSharedMem();					// undo openSharedMem(), also after it failed half way
+	void signalDataValid();					// wake readers waiting for a new line
+	static void waitUntil(long long time);	// return once clockNow() reaches time, sleeping while there is time to spare
+	static void beginTiming();				// raise the timer resolution while publishing, if the platform needs it
+	static void endTiming();
+
+	static const int historyLen = 1024;
+
+	irsdkSimConfig m_cfg;
+
+	void *m_hMemMapFile = nullptr;		// platform handles
+	void *m_hDataValidEvent = nullptr;
+	int m_memSize = 0;
+	char *m_sharedMem = nullptr;
+	irsdk_header *m_header = nullptr;
+	int m_sessionInfoMax = 0;
+	int *m_varOffsets = nullptr;
+
+	std::thread m_thread;
+	std::atomic<bool> m_running = { false };
+	std::atomic<int> m_tickCount = { 0 };
+	std::atomic<int> m_publishTick[historyLen] = {};
+	std::atomic<long long> m_publishTime[historyLen] = {};
+};
+
+#endif // IRSDK_SIM_H
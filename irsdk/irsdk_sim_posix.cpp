@@ -0,0 +1,140 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "irsdk_defines.h"
+#include "irsdk_sim.h"
+
+// Linux side of irsdkSim, for measuring the reader on machines without the sim.
+// The line buffers live in a POSIX shared memory object, and the data valid event
+// is a second one holding a futex word: every line bumps it and wakes everyone
+// waiting on it, which is what irsdk_waitForDataReady() does there.  The clock is
+// CLOCK_MONOTONIC in nanoseconds, the same one the reader stamps lines with.
+
+static void *createShared(const char *name, size_t size)
+{
+	const int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+	if(fd < 0)
+		return NULL;
+
+	void *mem = ftruncate(fd, size) == 0 ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+	close(fd);
+	if(mem == MAP_FAILED)
+	{
+		shm_unlink(name);
+		return NULL;
+	}
+	return mem;
+}
+
+bool irsdkSim::openSharedMem(int memSize)
+{
+	m_sharedMem = (char *)createShared(IRSDK_MEMMAPFILENAME, memSize);
+	if(!m_sharedMem)
+	{
+		if(errno == EEXIST)
+			printf("irsdkSim: %s already exists, is another producer running? (remove /dev/shm%s if not)\n", IRSDK_MEMMAPFILENAME, IRSDK_MEMMAPFILENAME);
+		else
+			printf("irsdkSim: could not create shared memory\n");
+		return false;
+	}
+	m_hMemMapFile = m_sharedMem;
+
+	m_hDataValidEvent = createShared(IRSDK_DATAVALIDEVENTNAME, sizeof(unsigned int));
+	if(!m_hDataValidEvent)
+	{
+		printf("irsdkSim: could not create data valid event\n");
+		return false;
+	}
+	return true;
+}
+
+void irsdkSim::closeSharedMem()
+{
+	// unlinked right away, readers that still have them mapped keep their view
+	if(m_hMemMapFile)
+	{
+		munmap(m_hMemMapFile, m_memSize);
+		shm_unlink(IRSDK_MEMMAPFILENAME);
+	}
+	if(m_hDataValidEvent)
+	{
+		munmap(m_hDataValidEvent, sizeof(unsigned int));
+		shm_unlink(IRSDK_DATAVALIDEVENTNAME);
+	}
+
+	m_sharedMem = nullptr;
+	m_hMemMapFile = nullptr;
+	m_hDataValidEvent = nullptr;
+}
+
+void irsdkSim::signalDataValid()
+{
+	unsigned int *word = (unsigned int *)m_hDataValidEvent;
+	__atomic_fetch_add(word, 1, __ATOMIC_SEQ_CST);
+	syscall(SYS_futex, word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+long long irsdkSim::clockNow()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+long long irsdkSim::clockFreq()
+{
+	return 1000000000LL;
+}
+
+void irsdkSim::waitUntil(long long time)
+{
+	// sleep to within a millisecond of it, the rest is spun off like on Windows
+	const long long wake = time - 1000000LL;
+	if(wake > clockNow())
+	{
+		const struct timespec until = { (time_t)(wake / 1000000000LL), (long)(wake % 1000000000LL) };
+		while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL) == EINTR)
+			;
+	}
+	while(clockNow() < time)
+		sched_yield();
+}
+
+void irsdkSim::beginTiming()
+{
+}
+
+void irsdkSim::endTiming()
+{
+}
@@ -0,0 +1,112 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <windows.h>
+#include <stdio.h>
+#include "irsdk_defines.h"
+#include "irsdk_sim.h"
+
+// for timeBeginPeriod()
+#pragma comment(lib, "Winmm")
+
+// Windows side of irsdkSim: the same named file mapping and auto reset event
+// the sim creates, and QueryPerformanceCounter() as the clock so publish times
+// compare directly with the reader's.
+
+bool irsdkSim::openSharedMem(int memSize)
+{
+	m_hMemMapFile = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, memSize, IRSDK_MEMMAPFILENAME);
+	if(!m_hMemMapFile || GetLastError() == ERROR_ALREADY_EXISTS)
+	{
+		printf("irsdkSim: could not create shared memory (is the sim running?)\n");
+		return false;
+	}
+
+	m_sharedMem = (char *)MapViewOfFile(m_hMemMapFile, FILE_MAP_ALL_ACCESS, 0, 0, memSize);
+	m_hDataValidEvent = CreateEvent(NULL, FALSE, FALSE, IRSDK_DATAVALIDEVENTNAME);
+	if(!m_sharedMem || !m_hDataValidEvent)
+	{
+		printf("irsdkSim: could not map shared memory or create event\n");
+		return false;
+	}
+	return true;
+}
+
+void irsdkSim::closeSharedMem()
+{
+	if(m_sharedMem)
+		UnmapViewOfFile(m_sharedMem);
+	if(m_hMemMapFile)
+		CloseHandle(m_hMemMapFile);
+	if(m_hDataValidEvent)
+		CloseHandle(m_hDataValidEvent);
+
+	m_sharedMem = nullptr;
+	m_hMemMapFile = nullptr;
+	m_hDataValidEvent = nullptr;
+}
+
+void irsdkSim::signalDataValid()
+{
+	SetEvent(m_hDataValidEvent);
+}
+
+long long irsdkSim::clockNow()
+{
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+	return now.QuadPart;
+}
+
+long long irsdkSim::clockFreq()
+{
+	LARGE_INTEGER freq;
+	QueryPerformanceFrequency(&freq);
+	return freq.QuadPart;
+}
+
+void irsdkSim::waitUntil(long long time)
+{
+	const long long freq = clockFreq();
+	for(;;)
+	{
+		const long long remaining = time - clockNow();
+		if(remaining <= 0)
+			break;
+		if(remaining * 1000 > freq * 2)
+			Sleep(1);
+		else
+			YieldProcessor();
+	}
+}
+
+void irsdkSim::beginTiming()
+{
+	timeBeginPeriod(1);
+}
+
+void irsdkSim::endTiming()
+{
+	timeEndPeriod(1);
+}
@@ -0,0 +1,93 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <string.h>
+#include "irsdk_stringarena.h"
+
+void irsdkStringArena::clear()
+{
+	m_buf[0] = '\0';
+	for(irsdkStrId &slot : m_slots)
+		slot = irsdkStrId();
+	m_used = 1;
+	m_count = 0;
+	m_misses = 0;
+}
+
+unsigned irsdkStringArena::hash(const char *s, int len)
+{
+	unsigned h = 2166136261u;
+	for(int i = 0; i < len; i++)
+	{
+		h ^= (unsigned char)s[i];
+		h *= 16777619u;
+	}
+	return h;
+}
+
+irsdkStrId irsdkStringArena::intern(const char *s, int len)
+{
+	irsdkStrId id;
+	if(!s || len <= 0)
+		return id;
+
+	unsigned slot = hash(s, len) & (NumSlots-1);
+	for(; !m_slots[slot].empty(); slot = (slot+1) & (NumSlots-1))
+	{
+		const irsdkStrId &other = m_slots[slot];
+		if(other.len == len && !memcmp(m_buf + other.off, s, len))
+			return other;
+	}
+
+	if(m_used + len + 1 > Capacity || m_count >= NumSlots/4*3)
+	{
+		m_misses++;
+		return id;
+	}
+
+	id.off = (unsigned short)m_used;
+	id.len = (unsigned short)len;
+	memcpy(m_buf + m_used, s, len);
+	m_buf[m_used + len] = '\0';
+	m_used += len + 1;
+
+	m_slots[slot] = id;
+	m_count++;
+	return id;
+}
+
+irsdkStrId irsdkStringArena::find(std::string_view s) const
+{
+	if(s.empty())
+		return irsdkStrId();
+
+	const int len = (int)s.size();
+	for(unsigned slot = hash(s.data(), len) & (NumSlots-1); !m_slots[slot].empty(); slot = (slot+1) & (NumSlots-1))
+	{
+		const irsdkStrId &other = m_slots[slot];
+		if(other.len == len && !memcmp(m_buf + other.off, s.data(), len))
+			return other;
+	}
+	return irsdkStrId();
+}
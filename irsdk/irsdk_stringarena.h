@@ -0,0 +1,87 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef IRSDK_STRINGARENA_H
+#define IRSDK_STRINGARENA_H
+
+#include <string_view>
+
+// Where a string lives in an irsdkStringArena.  The arena keeps every text only once,
+// so within one arena equal ids mean equal strings and the other way around.
+struct irsdkStrId
+{
+	unsigned short	off = 0;
+	unsigned short	len = 0;
+
+	bool empty() const { return len == 0; }
+	int size() const { return len; }
+
+	bool operator==(irsdkStrId o) const { return off == o.off && len == o.len; }
+	bool operator!=(irsdkStrId o) const { return !(*this == o); }
+};
+
+// A fixed block of interned, nul terminated strings, meant to be a member of the struct
+// whose text it holds.  That struct then stays a flat copy: copying it copies the strings
+// along, the ids stay valid, and nothing gets allocated.
+//
+// Strings are never freed one by one.  To drop the ones nothing refers to anymore,
+// intern what is still in use into a cleared arena and copy that over.  When the arena
+// is full, intern() hands out the empty string and counts the miss.
+class irsdkStringArena
+{
+public:
+	enum
+	{
+		Capacity = 16384,	// bytes, including a nul per string
+		NumSlots = 1024,	// hash slots, at most 3/4 of them get used
+	};
+
+	irsdkStringArena() { clear(); }
+
+	void clear();
+
+	irsdkStrId intern(const char *s, int len);
+	irsdkStrId intern(std::string_view s) { return intern(s.data(), (int)s.size()); }
+
+	// id of a string already in the arena, or the empty id
+	irsdkStrId find(std::string_view s) const;
+
+	std::string_view view(irsdkStrId id) const { return std::string_view(m_buf + id.off, id.len); }
+	const char *c_str(irsdkStrId id) const { return m_buf + id.off; }
+
+	int getUsed() const { return m_used; }
+	int getCount() const { return m_count; }
+	int getMisses() const { return m_misses; }
+
+private:
+	static unsigned hash(const char *s, int len);
+
+	char		m_buf[Capacity];		// starts with the empty string at 0
+	irsdkStrId	m_slots[NumSlots];		// empty id for a free slot
+	int			m_used;
+	int			m_count;
+	int			m_misses;
+};
+
+#endif // IRSDK_STRINGARENA_H
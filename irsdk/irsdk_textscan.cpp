@@ -0,0 +1,272 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <atomic>
+#include <stdint.h>
+#include "irsdk_textscan.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define IRSDK_SCAN_X86
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+	#endif
+#endif
+
+// MSVC lets any function use the AVX2 intrinsics, gcc and clang need to be told
+#if defined(IRSDK_SCAN_X86) && defined(__GNUC__)
+	#define IRSDK_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+	#define IRSDK_TARGET_AVX2
+#endif
+
+// The vector index builders read whole aligned blocks, so they look at bytes on either
+// side of the string: up to 63 before data and up to 63 after the terminator.  That is
+// safe because an aligned block never straddles a page boundary, and the cpu only
+// faults on whole pages; a block holding at least one byte of the string is readable
+// in full.  The bytes outside the string are masked off and never show up in a result.
+// Address sanitizers don't know this and would report the reads, so they're exempt.
+#if defined(__SANITIZE_ADDRESS__) && defined(__GNUC__)
+	#define IRSDK_NO_ASAN __attribute__((no_sanitize_address))
+#elif defined(__SANITIZE_ADDRESS__) && defined(_MSC_VER)
+	#define IRSDK_NO_ASAN __declspec(no_sanitize_address)
+#elif defined(__has_feature)
+	#if __has_feature(address_sanitizer)
+		#define IRSDK_NO_ASAN __attribute__((no_sanitize_address))
+	#endif
+#endif
+#ifndef IRSDK_NO_ASAN
+	#define IRSDK_NO_ASAN
+#endif
+
+#ifdef IRSDK_SCAN_X86
+
+//----
+// index building, 64 bytes per block, one 16 or 32 byte load at a time.
+// Returns the offset of the terminator from base.
+
+IRSDK_NO_ASAN
+static size_t indexSSE2(const char *base, const char *data, std::vector<irsdkTextIndex::Block> &blocks)
+{
+	const __m128i nl = _mm_set1_epi8('\n');
+	const __m128i cr = _mm_set1_epi8('\r');
+	const __m128i colon = _mm_set1_epi8(':');
+	const __m128i sp = _mm_set1_epi8(' ');
+	const __m128i z = _mm_setzero_si128();
+
+	unsigned long long live = ~0ull << (data - base);
+	for(const char *blk = base; ; blk += 64)
+	{
+		irsdkTextIndex::Block b = { 0, 0, 0 };
+		unsigned long long zero = 0;
+		for(int i = 0; i < 4; i++)
+		{
+			const __m128i v = _mm_load_si128((const __m128i *)(blk + i * 16));
+			const __m128i zv = _mm_cmpeq_epi8(v, z);
+			const __m128i ev = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, nl), _mm_cmpeq_epi8(v, cr)), zv);
+			b.eol |= (unsigned long long)(unsigned)_mm_movemask_epi8(ev) << (i * 16);
+			b.keyEnd |= (unsigned long long)(unsigned)_mm_movemask_epi8(_mm_or_si128(ev, _mm_cmpeq_epi8(v, colon))) << (i * 16);
+			b.space |= (unsigned long long)(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, sp)) << (i * 16);
+			zero |= (unsigned long long)(unsigned)_mm_movemask_epi8(zv) << (i * 16);
+		}
+		blocks.push_back(b);
+		if(zero & live)
+			return (size_t)(blk - base) + irsdkTextIndex::lowestBit(zero & live);
+		live = ~0ull;
+	}
+}
+
+IRSDK_TARGET_AVX2 IRSDK_NO_ASAN
+static size_t indexAVX2(const char *base, const char *data, std::vector<irsdkTextIndex::Block> &blocks)
+{
+	const __m256i nl = _mm256_set1_epi8('\n');
+	const __m256i cr = _mm256_set1_epi8('\r');
+	const __m256i colon = _mm256_set1_epi8(':');
+	const __m256i sp = _mm256_set1_epi8(' ');
+	const __m256i z = _mm256_setzero_si256();
+
+	unsigned long long live = ~0ull << (data - base);
+	for(const char *blk = base; ; blk += 64)
+	{
+		irsdkTextIndex::Block b = { 0, 0, 0 };
+		unsigned long long zero = 0;
+		for(int i = 0; i < 2; i++)
+		{
+			const __m256i v = _mm256_load_si256((const __m256i *)(blk + i * 32));
+			const __m256i zv = _mm256_cmpeq_epi8(v, z);
+			const __m256i ev = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, nl), _mm256_cmpeq_epi8(v, cr)), zv);
+			b.eol |= (unsigned long long)(unsigned)_mm256_movemask_epi8(ev) << (i * 32);
+			b.keyEnd |= (unsigned long long)(unsigned)_mm256_movemask_epi8(_mm256_or_si256(ev, _mm256_cmpeq_epi8(v, colon))) << (i * 32);
+			b.space |= (unsigned long long)(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, sp)) << (i * 32);
+			zero |= (unsigned long long)(unsigned)_mm256_movemask_epi8(zv) << (i * 32);
+		}
+		blocks.push_back(b);
+		if(zero & live)
+			return (size_t)(blk - base) + irsdkTextIndex::lowestBit(zero & live);
+		live = ~0ull;
+	}
+}
+
+#endif //IRSDK_SCAN_X86
+
+// only looks at the bytes from data up to the terminator, the rest stay 0
+static size_t indexScalar(const char *base, const char *data, std::vector<irsdkTextIndex::Block> &blocks)
+{
+	const char *p = data;
+	for(const char *blk = base; ; blk += 64)
+	{
+		irsdkTextIndex::Block b = { 0, 0, 0 };
+		for(; p < blk + 64; p++)
+		{
+			const unsigned long long bit = 1ull << (p - blk);
+			const char c = *p;
+			if(c == '\n' || c == '\r' || c == '\0')
+				b.eol |= bit;
+			if(c == '\n' || c == '\r' || c == '\0' || c == ':')
+				b.keyEnd |= bit;
+			if(c == ' ')
+				b.space |= bit;
+			if(c == '\0')
+				break;
+		}
+		blocks.push_back(b);
+		if(p < blk + 64)
+			return (size_t)(p - base);
+	}
+}
+
+//----
+// dispatch
+
+typedef size_t (*IndexFunc)(const char *base, const char *data, std::vector<irsdkTextIndex::Block> &blocks);
+
+static const IndexFunc s_indexFuncs[irsdk_ScanLevelCount] =
+{
+	indexScalar,
+#ifdef IRSDK_SCAN_X86
+	indexSSE2,
+	indexAVX2,
+#else
+	indexScalar,
+	indexScalar,
+#endif
+};
+
+static std::atomic<int> s_scanLevel(-1);
+
+static irsdk_ScanLevel detectScanLevel()
+{
+#if defined(IRSDK_SCAN_X86) && defined(_MSC_VER)
+	// AVX2 needs both the cpu and the OS (saving the ymm registers) on board
+	int info[4];
+	__cpuid(info, 0);
+	if(info[0] >= 7)
+	{
+		__cpuid(info, 1);
+		const bool osxsave = (info[2] & (1 << 27)) != 0;
+		const bool avx = (info[2] & (1 << 28)) != 0;
+		__cpuidex(info, 7, 0);
+		const bool avx2 = (info[1] & (1 << 5)) != 0;
+		if(osxsave && avx && avx2 && (_xgetbv(0) & 6) == 6)
+			return irsdk_ScanAVX2;
+	}
+	return irsdk_ScanSSE2;
+#elif defined(IRSDK_SCAN_X86)
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") ? irsdk_ScanAVX2 : irsdk_ScanSSE2;
+#else
+	return irsdk_ScanScalar;
+#endif
+}
+
+irsdk_ScanLevel irsdk_getBestScanLevel()
+{
+	static const irsdk_ScanLevel best = detectScanLevel();
+	return best;
+}
+
+irsdk_ScanLevel irsdk_getScanLevel()
+{
+	int level = s_scanLevel.load(std::memory_order_relaxed);
+	if(level < 0)
+	{
+		level = irsdk_getBestScanLevel();
+		s_scanLevel.store(level, std::memory_order_relaxed);
+	}
+	return (irsdk_ScanLevel)level;
+}
+
+void irsdk_setScanLevel(irsdk_ScanLevel level)
+{
+	if(level < irsdk_ScanScalar)
+		level = irsdk_ScanScalar;
+	if(level > irsdk_getBestScanLevel())
+		level = irsdk_getBestScanLevel();
+	s_scanLevel.store(level, std::memory_order_relaxed);
+}
+
+const char *irsdk_getScanLevelStr(irsdk_ScanLevel level)
+{
+	switch(level)
+	{
+	case irsdk_ScanScalar: return "scalar";
+	case irsdk_ScanSSE2: return "SSE2";
+	case irsdk_ScanAVX2: return "AVX2";
+	default: return "unknown";
+	}
+}
+
+void irsdkTextIndex::build(const char *data)
+{
+	m_blocks.clear();
+	m_numLines = 0;
+	m_base = (const char *)((uintptr_t)data & ~(uintptr_t)63);
+
+	const size_t first = (size_t)(data - m_base);
+	const size_t end = s_indexFuncs[irsdk_getScanLevel()](m_base, data, m_blocks);
+	m_end = m_base + end;
+
+	// A line starts at anything but a line break that follows one, or the start of
+	// the data.  Bits outside of [data, terminator) don't count.
+	const size_t numBlocks = m_blocks.size();
+	unsigned long long carry = 1ull << first;
+	for(size_t b = 0; b < numBlocks; b++)
+	{
+		const unsigned long long eol = m_blocks[b].eol;
+		unsigned long long starts = ~eol & ((eol << 1) | carry);
+		carry = eol >> 63;
+		if(b == 0)
+			starts &= ~0ull << first;
+		if(b == numBlocks - 1)
+			starts &= (1ull << (end & 63)) - 1;
+
+		// at most every other byte starts a line
+		if((size_t)m_numLines + 32 > m_lines.size())
+			m_lines.resize(m_lines.size() * 2 + 1024);
+		const char **line = &m_lines[m_numLines];
+		for(; starts; starts &= starts - 1)
+			*line++ = m_base + (b << 6) + lowestBit(starts);
+		m_numLines = (int)(line - m_lines.data());
+	}
+}
@@ -0,0 +1,141 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef IRSDK_TEXTSCAN_H
+#define IRSDK_TEXTSCAN_H
+
+#include <stddef.h>
+#include <vector>
+#ifdef _MSC_VER
+	#include <intrin.h>
+#endif
+
+// Block-at-a-time indexing of the session string, for irsdkYamlTree.
+//
+// The index is built 16 (SSE2) or 32 (AVX2) bytes at a time, picked at runtime from
+// what the cpu supports.  Loads are aligned, so they stay on the pages holding the
+// string itself; see irsdk_textscan.cpp.  All levels build the same index as the
+// scalar one.
+
+enum irsdk_ScanLevel
+{
+	irsdk_ScanScalar = 0,
+	irsdk_ScanSSE2,
+	irsdk_ScanAVX2,
+	irsdk_ScanLevelCount
+};
+
+// best level this cpu supports
+irsdk_ScanLevel irsdk_getBestScanLevel();
+
+// level in use, the best supported unless overridden for testing or benchmarking;
+// a level the cpu can't do is lowered to the best one it can
+irsdk_ScanLevel irsdk_getScanLevel();
+void irsdk_setScanLevel(irsdk_ScanLevel level);
+const char *irsdk_getScanLevelStr(irsdk_ScanLevel level);
+
+// Bitmaps of where the line breaks, ':'s and ' 's of a string are, one bit per byte,
+// built in a single pass.  Finding the end of a key, a value or the indentation is
+// then a bit scan over a 64 byte word instead of a loop over the bytes, which pays
+// off for short tokens, where a separate vector scan per token doesn't.
+//
+// The start of every line is collected in the same pass, so a parser can take the
+// lines one after the other without first finding where the previous one ended.
+//
+// The terminating '\0' counts as a line break.  Queries take pointers into the string
+// given to build(), and are only valid up to its terminator.
+class irsdkTextIndex
+{
+public:
+	irsdkTextIndex() : m_base(0), m_end(0), m_numLines(0) {}
+
+	// index data, up to its terminating '\0'
+	void build(const char *data);
+	void clear() { m_base = m_end = 0; m_blocks.clear(); m_numLines = 0; }
+
+	// lines that aren't empty, in order; runs of '\n' and '\r' count as one line break
+	int getNumLines() const { return m_numLines; }
+	const char *getLine(int idx) const { return m_lines[idx]; }
+
+	// the terminating '\0'
+	const char *getEnd() const { return m_end; }
+
+	// first line break, first ':' or line break, and first character that isn't a ' ',
+	// at or after p
+	const char *lineEnd(const char *p) const { return m_base + nextSet(&Block::eol, (size_t)(p - m_base)); }
+	const char *keyEnd(const char *p) const { return m_base + nextSet(&Block::keyEnd, (size_t)(p - m_base)); }
+	const char *skipSpaces(const char *p) const { return m_base + nextClear(&Block::space, (size_t)(p - m_base)); }
+
+	// index of the lowest set bit, m must not be 0
+	static int lowestBit(unsigned long long m)
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		unsigned long idx;
+		_BitScanForward64(&idx, m);
+		return (int)idx;
+#elif defined(_MSC_VER)
+		unsigned long idx;
+		if(_BitScanForward(&idx, (unsigned long)m))
+			return (int)idx;
+		_BitScanForward(&idx, (unsigned long)(m >> 32));
+		return (int)idx + 32;
+#else
+		return __builtin_ctzll(m);
+#endif
+	}
+
+	struct Block
+	{
+		unsigned long long eol;		// '\n', '\r' or '\0'
+		unsigned long long keyEnd;	// eol or ':'
+		unsigned long long space;	// ' '
+	};
+
+private:
+	size_t nextSet(unsigned long long Block::*mask, size_t pos) const
+	{
+		size_t b = pos >> 6;
+		unsigned long long m = m_blocks[b].*mask & (~0ull << (pos & 63));
+		while(!m)
+			m = m_blocks[++b].*mask;
+		return (b << 6) + lowestBit(m);
+	}
+
+	size_t nextClear(unsigned long long Block::*mask, size_t pos) const
+	{
+		size_t b = pos >> 6;
+		unsigned long long m = ~(m_blocks[b].*mask) & (~0ull << (pos & 63));
+		while(!m)
+			m = ~(m_blocks[++b].*mask);
+		return (b << 6) + lowestBit(m);
+	}
+
+	const char					*m_base;	// data rounded down to 64 bytes, bit 0 of the first block
+	const char					*m_end;
+	std::vector<Block>			m_blocks;
+	std::vector<const char *>	m_lines;	// the first m_numLines are in use
+	int							m_numLines;
+};
+
+#endif //IRSDK_TEXTSCAN_H
@@ -35,8 +35,19 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #	define _WIN32_WINNT		MIN_WIN_VER 
 #endif
 
+#ifdef _WIN32
 #include <windows.h>
+#else
+#include <atomic>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
 #include <stdio.h>
+#include <string.h>
 #include <time.h>
 #include <limits.h>
 
@@ -46,15 +57,45 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "irsdk_defines.h"
 
+#ifdef _WIN32
 // for timeBeginPeriod()
 #pragma comment(lib, "Winmm")
 // for RegisterWindowMessage() and SendMessage()
 #pragma comment(lib, "User32")
+#else
+// Linux stand-ins for the few Win32 calls below, so the reader can be run against
+// irsdkSim there.  Shared memory is mapped with shm_open(), the data valid event
+// is a futex word in a shared memory object of its own (see irsdk_defines.h).
+#define MemoryBarrier() std::atomic_thread_fence(std::memory_order_seq_cst)
+#define Sleep(ms) usleep((ms) * 1000)
+#define MAKELONG(a, b) ((int)(((unsigned int)(a) & 0xffff) | (((unsigned int)(b) & 0xffff) << 16)))
+
+static const char *mapShared(const char *name, size_t *size)
+{
+	const int fd = shm_open(name, O_RDONLY, 0);
+	if(fd < 0)
+		return NULL;
+
+	struct stat st;
+	void *mem = fstat(fd, &st) == 0 && st.st_size > 0 ? mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+	close(fd);
+	if(mem == MAP_FAILED)
+		return NULL;
+
+	*size = st.st_size;
+	return (const char *)mem;
+}
+#endif
 
 // Local memory
 
+#ifdef _WIN32
 static HANDLE hDataValidEvent = NULL;
 static HANDLE hMemMapFile = NULL;
+#else
+static const volatile unsigned int *pDataValid = NULL;
+static size_t sharedMemSize = 0;
+#endif
 
 static const char *pSharedMem = NULL;
 static const irsdk_header *pHeader = NULL;
@@ -65,8 +106,65 @@ static bool isInitialized = false;
 static const double timeout = 30.0; // timeout after 30 seconds with no communication
 static time_t lastValidTime = 0;
 
+static irsdk_readStats readStats = {};
+
+// tick count of the last line handed out, and when we first saw that tick
+static int lastLineTickCount = 0;
+static long long lastLineTime = 0;
+
+// for timing when lines were first seen
+static long long readClock()
+{
+#ifdef _WIN32
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+	return now.QuadPart;
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000000000LL + now.tv_nsec;
+#endif
+}
+
 // Function Implementations
 
+#ifndef _WIN32
+bool irsdk_startup()
+{
+	if(!pSharedMem)
+	{
+		pSharedMem = mapShared(IRSDK_MEMMAPFILENAME, &sharedMemSize);
+		pHeader = (const irsdk_header *)pSharedMem;
+		lastTickCount = INT_MAX;
+	}
+
+	if(pSharedMem && !pDataValid)
+	{
+		size_t size = 0;
+		pDataValid = (const volatile unsigned int *)mapShared(IRSDK_DATAVALIDEVENTNAME, &size);
+		lastTickCount = INT_MAX;
+	}
+
+	isInitialized = pSharedMem && pDataValid;
+	return isInitialized;
+}
+
+void irsdk_shutdown()
+{
+	if(pDataValid)
+		munmap((void *)pDataValid, sizeof(unsigned int));
+	if(pSharedMem)
+		munmap((void *)pSharedMem, sharedMemSize);
+
+	pDataValid = NULL;
+	pSharedMem = NULL;
+	pHeader = NULL;
+	sharedMemSize = 0;
+
+	isInitialized = false;
+	lastTickCount = INT_MAX;
+}
+#else
 bool irsdk_startup()
 {
 	if(!hMemMapFile)
@@ -126,8 +224,63 @@ void irsdk_shutdown()
 	isInitialized = false;
 	lastTickCount = INT_MAX;
 }
+#endif
+
+// Read a buffer's tick count straight out of shared memory.  The sim rewrites
+// these behind our back, so keep the compiler from caching or reordering the load.
+static int readTickCount(int index)
+{
+	const int tickCount = *(volatile const int *)&pHeader->varBuf[index].tickCount;
+	MemoryBarrier();
+	return tickCount;
+}
+
+// Index of the newest buffer that is newer than minTickCount, skipping any
+// buffer that already tore at its current tick count during this read.
+static int findNewestBuf(int minTickCount, const int *tornTickCount)
+{
+	int newest = -1;
+	int newestTickCount = minTickCount;
+	for(int i=0; i<pHeader->numBuf && i<IRSDK_MAX_BUFS; i++)
+	{
+		const int tickCount = readTickCount(i);
+		if(tickCount > newestTickCount && tickCount != tornTickCount[i])
+		{
+			newest = i;
+			newestTickCount = tickCount;
+		}
+	}
+	return newest;
+}
+
+// Seqlock style copy, the line is only good if the buffer's tick count
+// did not move while we were copying it out.  With ranges only those
+// parts of the line are copied, the rest of data is left alone.
+static bool copyBuf(int index, char *data, const irsdk_copyRange *ranges, int numRanges, int *tickCount)
+{
+	const char *src = pSharedMem + pHeader->varBuf[index].bufOffset;
+
+	const int before = readTickCount(index);
+	if(ranges)
+	{
+		for(int i=0; i<numRanges; i++)
+			memcpy(data + ranges[i].offset, src + ranges[i].offset, ranges[i].len);
+	}
+	else
+		memcpy(data, src, pHeader->bufLen);
+	MemoryBarrier();
+	const int after = readTickCount(index);
+
+	*tickCount = before;
+	return before == after;
+}
 
 bool irsdk_getNewData(char *data)
+{
+	return irsdk_getNewDataRanges(data, NULL, 0);
+}
+
+bool irsdk_getNewDataRanges(char *data, const irsdk_copyRange *ranges, int numRanges)
 {
 	if(isInitialized || irsdk_startup())
 	{
@@ -150,22 +303,41 @@ bool irsdk_getNewData(char *data)
 		// if newer than last recieved, than report new data
 		if(lastTickCount < pHeader->varBuf[latest].tickCount)
 		{
+			const long long observed = readClock();
+
 			// if asked to retrieve the data
 			if(data)
 			{
-				// try twice to get the data out
-				for(int count = 0; count < 2; count++)
+				// Start with the newest buffer.  If the sim rotates it out from under us, fall back
+				// to whatever is now the newest consistent buffer rather than dropping the tick.
+				int tornTickCount[IRSDK_MAX_BUFS];
+				for(int i=0; i<IRSDK_MAX_BUFS; i++)
+					tornTickCount[i] = INT_MIN;
+				for(int attempt = 0; attempt <= IRSDK_MAX_BUFS; attempt++)
 				{
-					int curTickCount =  pHeader->varBuf[latest].tickCount;
-					memcpy(data, pSharedMem + pHeader->varBuf[latest].bufOffset, pHeader->bufLen);
-					if(curTickCount ==  pHeader->varBuf[latest].tickCount)
+					const int index = findNewestBuf(lastTickCount, tornTickCount);
+					if(index < 0)
+						break;
+
+					int curTickCount = 0;
+					if(copyBuf(index, data, ranges, numRanges, &curTickCount))
 					{
+						readStats.reads++;
+						if(attempt > 0)
+							readStats.fallbackReads++;
+
 						lastTickCount = curTickCount;
 						lastValidTime = time(NULL);
+						lastLineTickCount = curTickCount;
+						lastLineTime = observed;
 						return true;
 					}
+
+					readStats.tornReads++;
+					tornTickCount[index] = curTickCount;
 				}
-				// if here, the data changed out from under us.
+				// if here, every candidate changed out from under us.
+				readStats.failedReads++;
 				return false;
 			}
 			else
@@ -187,8 +359,32 @@ bool irsdk_getNewData(char *data)
 	return false;
 }
 
+const irsdk_readStats *irsdk_getReadStats()
+{
+	return &readStats;
+}
+
+void irsdk_resetReadStats()
+{
+	memset(&readStats, 0, sizeof(readStats));
+}
+
+int irsdk_getLastLineTickCount()
+{
+	return lastLineTickCount;
+}
+
+long long irsdk_getLastLineTime()
+{
+	return lastLineTime;
+}
 
 bool irsdk_waitForDataReady(int timeOut, char *data)
+{
+	return irsdk_waitForDataReadyRanges(timeOut, data, NULL, 0);
+}
+
+bool irsdk_waitForDataReadyRanges(int timeOut, char *data, const irsdk_copyRange *ranges, int numRanges)
 {
 #ifdef _MSC_VER
 	_ASSERTE(timeOut >= 0);
@@ -196,15 +392,25 @@ bool irsdk_waitForDataReady(int timeOut, char *data)
 
 	if(isInitialized || irsdk_startup())
 	{
+#ifndef _WIN32
+		// taken before the check, so a line published in between cuts the wait short
+		const unsigned int seen = *pDataValid;
+#endif
+
 		// just to be sure, check before we sleep
-		if(irsdk_getNewData(data))
+		if(irsdk_getNewDataRanges(data, ranges, numRanges))
 			return true;
 
 		// sleep till signaled
+#ifdef _WIN32
 		WaitForSingleObject(hDataValidEvent, timeOut);
+#else
+		const struct timespec wait = { timeOut / 1000, (timeOut % 1000) * 1000000L };
+		syscall(SYS_futex, pDataValid, FUTEX_WAIT, seen, &wait, NULL, 0);
+#endif
 
 		// we woke up, so check for data
-		if(irsdk_getNewData(data))
+		if(irsdk_getNewDataRanges(data, ranges, numRanges))
 			return true;
 		else
 			return false;
@@ -331,9 +537,14 @@ int irsdk_varNameToOffset(const char *name)
 
 unsigned int irsdk_getBroadcastMsgID()
 {
+#ifdef _WIN32
 	static unsigned int msgId = RegisterWindowMessage(IRSDK_BROADCASTMSGNAME); 
 
 	return msgId;
+#else
+	// nothing to send remote control messages to
+	return 0;
+#endif
 }
 
 void irsdk_broadcastMsg(irsdk_BroadcastMsg msg, int var1, int var2, int var3)
@@ -353,10 +564,17 @@ void irsdk_broadcastMsg(irsdk_BroadcastMsg msg, int var1, int var2)
 {
 	static unsigned int msgId = irsdk_getBroadcastMsgID();
 
+#ifdef _WIN32
 	if(msgId && msg >= 0 && msg < irsdk_BroadcastLast)
 	{
 		SendNotifyMessage(HWND_BROADCAST, msgId, MAKELONG(msg, var1), var2);
 	}
+#else
+	(void)msgId;
+	(void)msg;
+	(void)var1;
+	(void)var2;
+#endif
 }
 
 int irsdk_padCarNum(int num, int zero)
@@ -0,0 +1,113 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef IRSDK_VAR_H
+#define IRSDK_VAR_H
+
+#include <assert.h>
+#include "irsdk_defines.h"
+#include "irsdk_client.h"
+
+// irsdk_VarType matching a C++ type
+template<typename T> struct irsdkVarType;
+template<> struct irsdkVarType<char>	{ static bool matches(int t) { return t == irsdk_char; } };
+template<> struct irsdkVarType<bool>	{ static bool matches(int t) { return t == irsdk_bool; } };
+template<> struct irsdkVarType<int>		{ static bool matches(int t) { return t == irsdk_int || t == irsdk_bitField; } };
+template<> struct irsdkVarType<float>	{ static bool matches(int t) { return t == irsdk_float; } };
+template<> struct irsdkVarType<double>	{ static bool matches(int t) { return t == irsdk_double; } };
+
+// Typed alternative to irsdkCVar for vars read in hot loops.
+//
+// The var's offset is looked up once per connection (irsdkClient::getStatusID()) and
+// every read after that is a plain load from the client's current line, without
+// irsdkCVar's connection check or irsdkClient's per-read type switch.  T must be the
+// var's own type (int also covers bitfields) and the var must have at least N entries,
+// otherwise the handle stays invalid and reads return zero.
+//
+// all() hands out the N entries as one contiguous array, e.g. all 64 CarIdx values,
+// so per-car loops can work on them directly.
+template<typename T, int N = 1>
+class irsdkVar
+{
+public:
+	explicit irsdkVar(const char *name)
+		: m_name(name)
+	{ }
+
+	bool isValid() { return line() != NULL; }
+
+	T get(int entry = 0)
+	{
+		assert(entry >= 0 && entry < N);
+		const char *l = line();
+		return l ? ((const T *)l)[entry] : T();
+	}
+
+	T operator[](int entry) { return get(entry); }
+
+	// all N entries, or zeros if the var isn't available
+	const T (&all())[N]
+	{
+		static const T zeros[N] = {};
+		const char *l = line();
+		return l ? *(const T (*)[N])l : zeros;
+	}
+
+	const char *getName() const { return m_name; }
+
+protected:
+	// the current line offset to this var, or NULL
+	const char *line()
+	{
+		irsdkClient &client = irsdkClient::instance();
+		const char *data = client.getLine();
+		if(!data)
+			return NULL;
+
+		if(m_statusID != client.getStatusID())
+			resolve(client);
+
+		return m_offset >= 0 ? data + m_offset : NULL;
+	}
+
+	void resolve(irsdkClient &client)
+	{
+		m_statusID = client.getStatusID();
+		m_offset = -1;
+
+		const int idx = client.getVarIdx(m_name);
+		const irsdk_varHeader *vh = client.getVarHeaderEntry(idx);
+		if(vh && irsdkVarType<T>::matches(vh->type) && vh->count >= N)
+		{
+			m_offset = vh->offset;
+			client.useVar(idx);
+		}
+	}
+
+	const char *m_name;
+	int m_statusID = -1;
+	int m_offset = -1;
+};
+
+#endif // IRSDK_VAR_H
@@ -0,0 +1,200 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef IRSDK_YAMLSCHEMA_H
+#define IRSDK_YAMLSCHEMA_H
+
+#include <string.h>
+#include <string>
+#include <string_view>
+#include <charconv>
+#include "irsdk_yamltree.h"
+#include "irsdk_stringarena.h"
+
+// Value conversions for the session string.  Like atoi()/atof(), leading blanks are
+// skipped, junk reads as 0, and only the leading number counts ("4.02 km" is 4.02).
+// No copies, no locale.
+inline int irsdk_yamlToInt(const char *s, int len)
+{
+	const char *end = s + len;
+	while(s < end && (*s == ' ' || *s == '\t'))
+		s++;
+	if(s < end && *s == '+')
+		s++;
+	int v = 0;
+	if(std::from_chars(s, end, v).ec != std::errc())
+		return 0;
+	return v;
+}
+
+inline float irsdk_yamlToFloat(const char *s, int len)
+{
+	const char *end = s + len;
+	while(s < end && (*s == ' ' || *s == '\t'))
+		s++;
+	if(s < end && *s == '+')
+		s++;
+	float v = 0;
+	if(std::from_chars(s, end, v).ec != std::errc())
+		return 0;
+	return v;
+}
+
+// value with its surrounding quotes, if any, taken off
+inline std::string_view irsdk_yamlToStr(const char *s, int len)
+{
+	if(len > 0 && *s == '"')
+	{
+		s++;
+		len--;
+	}
+	if(len > 0 && s[len-1] == '"')
+		len--;
+	return std::string_view(s, len);
+}
+
+// One key of a YAML block and the member of T it goes into.  Text members are
+// interned into the arena given to decode(), without one they come out empty.
+template<typename T>
+struct irsdkYamlField
+{
+	enum Type { Int, Float, Str, Text };
+
+	constexpr irsdkYamlField() : key(), type(Int), i(nullptr), f(nullptr), s(nullptr), t(nullptr) {}
+	constexpr irsdkYamlField(std::string_view k, int T::*m) : key(k), type(Int), i(m), f(nullptr), s(nullptr), t(nullptr) {}
+	constexpr irsdkYamlField(std::string_view k, float T::*m) : key(k), type(Float), i(nullptr), f(m), s(nullptr), t(nullptr) {}
+	constexpr irsdkYamlField(std::string_view k, std::string T::*m) : key(k), type(Str), i(nullptr), f(nullptr), s(m), t(nullptr) {}
+	constexpr irsdkYamlField(std::string_view k, irsdkStrId T::*m) : key(k), type(Text), i(nullptr), f(nullptr), s(nullptr), t(m) {}
+
+	void set(T &dest, const char *val, int len, irsdkStringArena *arena) const
+	{
+		switch(type)
+		{
+		case Int: dest.*i = irsdk_yamlToInt(val, len); break;
+		case Float: dest.*f = irsdk_yamlToFloat(val, len); break;
+		case Str: { const std::string_view v = irsdk_yamlToStr(val, len); (dest.*s).assign(v.data(), v.size()); break; }
+		case Text: dest.*t = arena ? arena->intern(irsdk_yamlToStr(val, len)) : irsdkStrId(); break;
+		}
+	}
+
+	std::string_view	key;	// without the ':'
+	Type				type;
+	int T::*			i;
+	float T::*			f;
+	std::string T::*	s;
+	irsdkStrId T::*		t;
+};
+
+// The keys of a YAML block mapped onto the members of T, built at compile time:
+//
+//	static constexpr auto CarSchema = irsdk_makeYamlSchema<Car>({
+//		{ "UserName", &Car::userName },
+//		{ "IRating", &Car::irating },
+//	});
+//
+// decode() then fills every mapped member in a single pass over the block's children,
+// finding each key in a small hash table, so its cost doesn't grow with the number of
+// fields mapped.  Keys that aren't mapped are skipped, and of a key that shows up more
+// than once the first one counts, same as with irsdkYamlTree::getVal().
+template<typename T, int N>
+struct irsdkYamlSchema
+{
+	static_assert(N > 0 && N <= 64, "decode() reports the fields found in a 64 bit mask");
+
+	static constexpr int NumSlots = N <= 4 ? 8 : N <= 8 ? 16 : N <= 16 ? 32 : N <= 32 ? 64 : 128;
+
+	irsdkYamlField<T>	fields[N];
+	signed char			slots[NumSlots] = {};	// index of the field + 1, 0 for an empty slot
+
+	static constexpr unsigned hashKey(const char *s, size_t len)
+	{
+		unsigned h = 2166136261u;
+		for(size_t i = 0; i < len; i++)
+		{
+			h ^= (unsigned char)s[i];
+			h *= 16777619u;
+		}
+		return h;
+	}
+
+	// index of the field with this key, or -1
+	int find(const char *key, int keyLen) const
+	{
+		for(unsigned slot = hashKey(key, keyLen) & (NumSlots-1); slots[slot]; slot = (slot+1) & (NumSlots-1))
+		{
+			const irsdkYamlField<T> &f = fields[slots[slot]-1];
+			if((int)f.key.size() == keyLen && !memcmp(f.key.data(), key, keyLen))
+				return slots[slot]-1;
+		}
+		return -1;
+	}
+
+	// same, at compile time, for picking out fields in the mask decode() returns
+	constexpr int indexOf(std::string_view key) const
+	{
+		for(int i = 0; i < N; i++)
+			if(fields[i].key == key)
+				return i;
+		return -1;
+	}
+
+	// Fill the members of dest that the children of node have keys for, returns a
+	// mask of the fields found (bit i for fields[i]).
+	unsigned long long decode(const irsdkYamlTree &yaml, int node, T &dest, irsdkStringArena *arena = nullptr) const
+	{
+		unsigned long long found = 0;
+		if(node < 0)
+			return found;
+
+		const char *data = yaml.getData();
+		for(int c = yaml.getNode(node).firstChild; c >= 0; c = yaml.getNode(c).nextSibling)
+		{
+			const irsdkYamlTree::Node &n = yaml.getNode(c);
+			const int idx = find(data + n.key, n.keyLen);
+			if(idx < 0 || (found & (1ull << idx)))
+				continue;
+			found |= 1ull << idx;
+			fields[idx].set(dest, data + n.val, n.valLen, arena);
+		}
+		return found;
+	}
+};
+
+template<typename T, int N>
+constexpr irsdkYamlSchema<T, N> irsdk_makeYamlSchema(const irsdkYamlField<T> (&fields)[N])
+{
+	irsdkYamlSchema<T, N> schema;
+	for(int i = 0; i < N; i++)
+	{
+		schema.fields[i] = fields[i];
+
+		unsigned slot = irsdkYamlSchema<T, N>::hashKey(fields[i].key.data(), fields[i].key.size()) & (irsdkYamlSchema<T, N>::NumSlots-1);
+		while(schema.slots[slot])
+			slot = (slot+1) & (irsdkYamlSchema<T, N>::NumSlots-1);
+		schema.slots[slot] = (signed char)(i+1);
+	}
+	return schema;
+}
+
+#endif // IRSDK_YAMLSCHEMA_H
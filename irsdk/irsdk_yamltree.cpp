@@ -0,0 +1,232 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <string.h>
+#include "irsdk_yamltree.h"
+
+void irsdkYamlTree::clear()
+{
+	m_data = 0;
+	m_nodes.clear();
+}
+
+int irsdkYamlTree::addNode(int parent, int *lastChild, int key, int keyLen, int col)
+{
+	Node n;
+	n.key = key;
+	n.keyLen = (short)keyLen;
+	n.col = (short)col;
+	n.val = key + keyLen;
+	n.valLen = 0;
+	n.parent = parent;
+	n.firstChild = -1;
+	n.nextSibling = -1;
+	n.end = key + keyLen;
+
+	const int idx = (int)m_nodes.size();
+	m_nodes.push_back(n);
+	m_lastChild.push_back(-1);
+
+	// link in as the last child of parent
+	int &last = parent >= 0 ? m_lastChild[parent] : *lastChild;
+	if(last >= 0)
+		m_nodes[last].nextSibling = idx;
+	else if(parent >= 0)
+		m_nodes[parent].firstChild = idx;
+	last = idx;
+
+	return idx;
+}
+
+void irsdkYamlTree::parse(const char *data)
+{
+	m_nodes.clear();
+	m_lastChild.clear();
+	m_data = data;
+	if(!data)
+		return;
+
+	// line starts, and every scan within a line, are lookups in this
+	m_index.build(data);
+
+	// Open nodes, innermost last.  A key closes everything at its column or deeper,
+	// a list item only what is deeper or another item at its column, since lists sit
+	// at the same column as their key in the sim's output:
+	//	Drivers:
+	//	- CarIdx: 0
+	//	  UserName: Pace Car
+	int stack[64];
+	int depth = 0;
+	int lastTop = -1;
+
+	const int numLines = m_index.getNumLines();
+	for(int l = 0; l < numLines; l++)
+	{
+		const char *line = m_index.getLine(l);
+
+		// indentation, and an optional list item dash
+		const char *p = m_index.skipSpaces(line);
+		int col = (int)(p - line);
+		bool item = false;
+		if(*p == '-' && (p[1] == ' ' || p[1] == '\n' || p[1] == '\r' || p[1] == '\0'))
+		{
+			item = true;
+			p++;
+			while(*p == ' ')
+				p++;
+		}
+
+		// key up to the first ':'
+		const char *key = p;
+		p = m_index.keyEnd(p);
+		const bool hasKey = *p == ':' && p > key;
+		const int keyLen = (int)(p - key);
+
+		if(item)
+		{
+			while(depth > 0 && (m_nodes[stack[depth-1]].col > col || (m_nodes[stack[depth-1]].col == col && !m_nodes[stack[depth-1]].keyLen)))
+				m_nodes[stack[--depth]].end = (int)(line - data);
+			const int it = addNode(depth ? stack[depth-1] : -1, &lastTop, (int)(line + col - data), 0, col);
+			if(depth < 64)
+				stack[depth++] = it;
+			col = (int)(key - line);
+		}
+
+		if(hasKey)
+		{
+			while(depth > 0 && m_nodes[stack[depth-1]].col >= col)
+				m_nodes[stack[--depth]].end = (int)(line - data);
+			const int n = addNode(depth ? stack[depth-1] : -1, &lastTop, (int)(key - data), keyLen, col);
+			if(depth < 64)
+				stack[depth++] = n;
+
+			// value, from the first non blank after the ':' up to the end of the line
+			const char *val = p + 1;
+			while(*val == ' ')
+				val++;
+			const char *valEnd = m_index.lineEnd(val);
+			m_nodes[n].val = (int)(val - data);
+			m_nodes[n].valLen = (int)(valEnd - val);
+			m_nodes[n].end = (int)(valEnd - data);
+		}
+	}
+
+	while(depth > 0)
+		m_nodes[stack[--depth]].end = (int)(m_index.getEnd() - data);
+
+	m_lastChild.clear();
+	m_index.clear();
+}
+
+unsigned long long irsdkYamlTree::hash(const char *s, int len, unsigned long long h)
+{
+	for(int i=0; i<len; i++)
+	{
+		h ^= (unsigned char)s[i];
+		h *= 1099511628211ull;
+	}
+	return h;
+}
+
+int irsdkYamlTree::findChild(int parent, const char *key, int keyLen, const char *selVal, int selLen, int *container) const
+{
+	int child = parent >= 0 ? m_nodes[parent].firstChild : getFirst();
+	for(; child >= 0; child = m_nodes[child].nextSibling)
+	{
+		const Node &c = m_nodes[child];
+
+		// look through list items at their keys
+		int n = c.keyLen ? child : c.firstChild;
+		const int end = c.keyLen ? child : -1;
+		for(; n >= 0; n = (n == end) ? -1 : m_nodes[n].nextSibling)
+		{
+			const Node &k = m_nodes[n];
+			if(k.keyLen != keyLen || 0 != strncmp(m_data + k.key, key, keyLen))
+				continue;
+			if(selVal && (k.valLen != selLen || 0 != strncmp(m_data + k.val, selVal, selLen)))
+				continue;
+
+			if(container)
+				*container = k.parent;
+			return n;
+		}
+	}
+	return -1;
+}
+
+int irsdkYamlTree::find(const char *path, int from) const
+{
+	if(!path || !m_data)
+		return -1;
+
+	int cur = from;
+	int node = -1;
+	while(*path)
+	{
+		const char *key = path;
+		while(*path && *path != ':')
+			path++;
+		const int keyLen = (int)(path - key);
+		if(*path == ':')
+			path++;
+
+		const char *sel = 0;
+		int selLen = 0;
+		if(*path == '{')
+		{
+			sel = ++path;
+			while(*path && *path != '}')
+				path++;
+			selLen = (int)(path - sel);
+			if(*path == '}')
+				path++;
+		}
+
+		int container = -1;
+		node = findChild(cur, key, keyLen, sel, selLen, &container);
+		if(node < 0)
+			return -1;
+
+		// after a selector, the rest of the path is looked up next to the key it matched
+		cur = sel ? container : node;
+	}
+	return node;
+}
+
+bool irsdkYamlTree::getVal(const char *path, const char **val, int *len, int from) const
+{
+	if(!val || !len)
+		return false;
+
+	*val = NULL;
+	*len = 0;
+
+	const int n = find(path, from);
+	if(n < 0)
+		return false;
+
+	*val = m_data + m_nodes[n].val;
+	*len = m_nodes[n].valLen;
+	return true;
+}
@@ -0,0 +1,94 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef IRSDK_YAMLTREE_H
+#define IRSDK_YAMLTREE_H
+
+#include <vector>
+#include "irsdk_textscan.h"
+
+// The session info string, tokenized once into a flat array of nodes.
+//
+// parseYaml() walks the whole string again for every lookup, which adds up to thousands
+// of passes per session update.  This does one pass, recording one node per key, plus
+// one anonymous node per list item ("- "), linked to its parent, first child and next
+// sibling.  Lookups then only walk the nodes along the path.
+//
+// Paths use the same syntax as parseYaml(), including the {N} selector that picks
+// the list item whose key has the value N:
+//	"DriverInfo:Drivers:CarIdx:{5}UserName:"
+//
+// Keys and values point into the parsed string, it has to stay alive and unchanged.
+class irsdkYamlTree
+{
+public:
+	struct Node
+	{
+		int key;			// offset of the key, without the ':'
+		short keyLen;		// 0 for a list item
+		short col;			// column of the key, or of the '-' for a list item
+		int val;			// offset of the value, up to the end of the line
+		int valLen;
+		int parent;			// -1 for the top level
+		int firstChild;		// -1 if none
+		int nextSibling;	// -1 if none
+		int end;			// offset just past the node's last line, children included
+	};
+
+	// tokenize data, replacing whatever was parsed before
+	void parse(const char *data);
+	void clear();
+
+	int getNumNodes() const { return (int)m_nodes.size(); }
+	const Node &getNode(int idx) const { return m_nodes[idx]; }
+	const char *getData() const { return m_data; }
+
+	// first top level node, or -1
+	int getFirst() const { return m_nodes.empty() ? -1 : 0; }
+
+	// the node at the end of path, or -1; the path starts below node from if given
+	int find(const char *path, int from = -1) const;
+
+	// same contract as parseYaml()
+	bool getVal(const char *path, const char **val, int *len, int from = -1) const;
+
+	// FNV-1a of the node's text, children included, to tell whether a part of the
+	// string changed between updates without decoding it
+	unsigned long long hash(int node) const { return hash(m_data + m_nodes[node].key, m_nodes[node].end - m_nodes[node].key); }
+	static unsigned long long hash(const char *s, int len, unsigned long long h = 14695981039346656037ull);
+
+	// child of parent (-1 for the top level) with this key, looking into list items
+	// too; with selVal only a key with that value matches
+	int findChild(int parent, const char *key, int keyLen, const char *selVal = 0, int selLen = 0, int *container = 0) const;
+
+protected:
+	int addNode(int parent, int *lastChild, int key, int keyLen, int col);
+
+	const char *m_data = 0;
+	std::vector<Node> m_nodes;
+	std::vector<int> m_lastChild;	// per node during parse(), to append siblings in O(1)
+	irsdkTextIndex m_index;			// line breaks, ':'s and ' 's of the data during parse()
+};
+
+#endif // IRSDK_YAMLTREE_H
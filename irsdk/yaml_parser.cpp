@@ -59,6 +59,29 @@ bool parseYaml(const char *data, const char* path, const char **val, int *len)
 
 		while(*data)
 		{
+			// inside a key or a value, everything up to the next separator only adds to
+			// its length, so skip over it without going through the switch per character
+			if(state == key)
+			{
+				const char *end = data;
+				while(*end && *end != ':' && *end != '\n' && *end != '\r')
+					end++;
+				keylen += (int)(end - data);
+				data = end;
+				if(!*data)
+					break;
+			}
+			else if(state == value)
+			{
+				const char *end = data;
+				while(*end && *end != '\n' && *end != '\r')
+					end++;
+				valuelen += (int)(end - data);
+				data = end;
+				if(!*data)
+					break;
+			}
+
 			switch(*data)
 			{
 			case ' ':
@@ -31,11 +31,13 @@ SOFTWARE.
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <string>
 #include <vector>
 #include <windows.h>
 #include "iracing.h"
 #include "Config.h"
+#include "Latency.h"
 #include "OverlayDebug.h"
 #include "OverlayHUD.h"
 #include "OverlayStandings.h"
@@ -49,7 +51,8 @@ enum class Hotkey
     HUD,
     InputTesting,
     Relative,
-    Cover
+    Cover,
+    LatencyDump
 };
 
 static void registerHotkeys()
@@ -58,6 +61,7 @@ static void registerHotkeys()
     UnregisterHotKey( NULL, (int)Hotkey::Standings );
     UnregisterHotKey( NULL, (int)Hotkey::HUD);
     UnregisterHotKey( NULL, (int)Hotkey::InputTesting );
+    UnregisterHotKey( NULL, (int)Hotkey::LatencyDump );
 
     UINT vk, mod;
 
@@ -73,6 +77,9 @@ static void registerHotkeys()
     if (parseHotkey(g_cfg.getString("OverlayHUD", "toggle_hotkey", "ctrl-5"), &mod, &vk))
         RegisterHotKey(NULL, (int)Hotkey::HUD, mod, vk);
 
+    if (parseHotkey(g_cfg.getString("General", "latency_dump_hotkey", "ctrl-shift-l"), &mod, &vk))
+        RegisterHotKey(NULL, (int)Hotkey::LatencyDump, mod, vk);
+
     // TODO log the application hotkeys
 }
 
@@ -100,11 +107,33 @@ static void giveFocusToIracing()
         SetForegroundWindow( hwnd );
 }
 
-int main()
+int main( int argc, char** argv )
 {
     // Bump priority up so we get time from the sim
     SetPriorityClass(GetCurrentProcess(), HIGH_PRIORITY_CLASS);
 
+    // Optionally replay a telemetry file instead of connecting to the sim:
+    //   iron.exe --replay file.ibt [--speed N]    (N=1 real time, 0 as fast as possible)
+    const char* replayFile  = nullptr;
+    double      replaySpeed = 1.0;
+    for( int i=1; i<argc-1; ++i )
+    {
+        if( !strcmp(argv[i],"--replay") )
+            replayFile = argv[i+1];
+        else if( !strcmp(argv[i],"--speed") )
+            replaySpeed = atof( argv[i+1] );
+    }
+    if( replayFile )
+    {
+        if( !irsdkClient::instance().openFile(replayFile) )
+            return 1;
+        irsdkClient::instance().setPlaybackSpeed( replaySpeed );
+        printf("Replaying %s, speed %g\n", replayFile, replaySpeed);
+    }
+
+    // Read telemetry on its own thread so a slow frame doesn't hold up the next read (and vice versa)
+    ir_startAcquisition();
+
     // Load the config and watch it for changes
     g_cfg.load();
     g_cfg.watchForChanges();
@@ -135,14 +164,22 @@ int main()
 
 	ConnectionStatus    prevStatus      = status;
     SessionType         prevSessionType = SessionType::UNKNOWN;
+    bool                replayFinished  = false;
 
     while( true )
     {
         prevStatus = status;
-		prevSessionType = ir_session.sessionType;
+		prevSessionType = ir_session->sessionType;
 
         // Refresh connection and session info
+        const long long tickStart = LatencyTracker::now();
         status = ir_tick();
+        {
+            int tickCount = 0;
+            long long lineTime = 0;
+            ir_getLineTiming( &tickCount, &lineTime );
+            g_latency.beginFrame( tickCount, lineTime, tickStart, LatencyTracker::now() );
+        }
         if( status != prevStatus )
         {
             if( status == ConnectionStatus::DISCONNECTED )
@@ -154,11 +191,34 @@ int main()
             handleConfigChange( overlays, status );
         }
 
-        dbg( "connection status: %s, session type: %s, session state: %d, pace mode: %d, on track: %d, flags: 0x%X", ConnectionStatusStr[(int)status], SessionTypeStr[(int)ir_session.sessionType], ir_SessionState.getInt(), ir_PaceMode.getInt(), (int)ir_IsOnTrackCar.getBool(), ir_SessionFlags.getInt() );
+        if( replayFile && !replayFinished && ir_isFileFinished() )
+        {
+            printf("Replay finished\n");
+            replayFinished = true;
+        }
+
+        dbg( "connection status: %s, session type: %s, session state: %d, pace mode: %d, on track: %d, flags: 0x%X", ConnectionStatusStr[(int)status], SessionTypeStr[(int)ir_session->sessionType], ir_SessionState.getInt(), ir_PaceMode.getInt(), (int)ir_IsOnTrackCar.getBool(), ir_SessionFlags.getInt() );
+
+        const TelemetryStaleness& staleness = ir_getStaleness();
+        dbg( "telemetry age: %.1f ms (avg %.1f, max %.1f), skipped snapshots: %lld", staleness.lastAgeMs, staleness.avgAgeMs, staleness.maxAgeMs, staleness.skipped );
+        g_latency.dbgPrint();
+        const irsdkClient::BindStats& bindStats = irsdkClient::instance().getBindStats();
+        dbg( "var binding: %d of %d irsdkCVars bound against %d vars in %.3f ms", bindStats.numBound, bindStats.numCVars, bindStats.numVars, bindStats.ms );
+        const SessionDecodeStats decodeStats = ir_getSessionDecodeStats();
+        dbg( "session string: %lld updates, last one decoded %d of %d records (%d skipped), text: %d bytes (%d missed)", decodeStats.updates, decodeStats.decoded, decodeStats.records, decodeStats.skipped, decodeStats.textBytes, decodeStats.textMisses );
+        {
+            long long drawn = 0, skipped = 0;
+            for( const Overlay* o : overlays )
+            {
+                drawn += o->getDisplayStats().drawn;
+                skipped += o->getDisplayStats().skipped;
+            }
+            dbg( "overlay frames: %lld drawn, %lld skipped as unchanged", drawn, skipped );
+        }
 
-        if( ir_session.sessionType != prevSessionType )
+        if( ir_session->sessionType != prevSessionType )
         {
-            dbg("Session Type Changed from (%d) to (%d)\n", prevSessionType, ir_session.sessionType);
+            dbg("Session Type Changed from (%d) to (%d)\n", prevSessionType, ir_session->sessionType);
 
             for( Overlay* o : overlays )
                 o->sessionChanged();
@@ -210,6 +270,13 @@ int main()
                     if( !uiEdit )
                         giveFocusToIracing();
                 }
+                else if( msg.wParam == (int)Hotkey::LatencyDump )
+                {
+                    // Machine-readable snapshot of the latency stats, then start over
+                    if( g_latency.dump("latency.json") )
+                        printf("Latency stats written to latency.json\n");
+                    g_latency.reset();
+                }
                 else
                 {
                     switch( msg.wParam )
@@ -237,6 +304,8 @@ int main()
         frameCnt++;
     }
 
+    ir_stopAcquisition();
+
     for( Overlay* o : overlays )
         delete o;
 }
@@ -0,0 +1,266 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <wchar.h>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include "irtool.h"
+#include "../CellCache.h"
+#include "../DisplayList.h"
+
+// Standings cell cache benchmark.
+//
+// Plays a long race through the standings' nine text columns for every car. Names, numbers,
+// license and iRating stay put, positions change now and then, best and last laps once a
+// lap, gaps several times a second, and the pit age counts laps. Each frame is recorded into
+// a DisplayList twice: once formatting every cell, and once through CellCache, which only
+// formats the cells whose values changed. Reports the time per frame both ways and how many
+// cells got formatted per frame. Then every cell's text layout is looked up in a
+// TextLayoutCache, hashing the text each time as the backend would, and with the hash the
+// cell kept since it was last formatted. Fails if a cell from the cache ever has different
+// text from the one formatted from scratch.
+//
+// Nothing here needs Windows, so this also builds on its own, e.g. on Linux:
+//   g++ -O2 -std=c++17 -DIRTOOL_CELLBENCH_MAIN tools/cmd_cellbench.cpp -o cellbench
+//   ./cellbench --frames 216000 --cars 64
+
+enum Column { POSITION, CAR_NUMBER, NAME, DELTA, BEST, LAST, LICENSE, IRATING, PIT, NUM_COLUMNS };
+
+struct BenchCar
+{
+    int     position = 0;
+    char    number[12] = {};
+    char    name[32] = {};
+    char    licenseChar = 'A';
+    float   licenseSR = 0;
+    int     irating = 0;
+    float   best = 0;
+    float   last = 0;
+    int     lapDelta = 0;
+    float   delta = 0;
+    int     pitAge = 0;
+    bool    onPitRoad = false;
+};
+
+static void initCar( int car, BenchCar& c )
+{
+    snprintf( c.number, sizeof(c.number), "%d", car * 3 + 1 );
+    snprintf( c.name, sizeof(c.name), "Driver Number %d", car + 1 );
+    c.licenseChar = "RDCBAP"[car % 6];
+    c.licenseSR = 1.0f + (car % 30) * 0.13f;
+    c.irating = 1200 + car * 137;
+}
+
+static void updateCar( long long frame, int car, int numCars, BenchCar& c )
+{
+    const float lapTime = 90.0f + car * 0.37f;
+    const float secs = frame / 60.0f;
+    const int lap = int( secs / lapTime );
+    const float lapPct = secs / lapTime - lap;
+
+    // The field shuffles a little every few laps
+    c.position = (car + lap/7) % numCars + 1;
+
+    // A new last lap when crossing the line, best is the fastest so far
+    if( lap > 0 )
+    {
+        const float last = lapTime + float( (car * 7919 + lap * 104729) % 2000 ) / 1000.0f;
+        if( c.last != last )
+        {
+            c.last = last;
+            c.best = c.best > 0 ? std::min( c.best, last ) : last;
+        }
+    }
+
+    // Gap to the leader to the thousandth, updated at 6 Hz as the timing does; backmarkers
+    // are a lap or more down
+    c.lapDelta = car > numCars*3/4 ? -(car - numCars*3/4) / 4 : 0;
+    c.delta = c.lapDelta ? 0 : car * 1.7f + 0.001f * float( (frame/10 * (car+1)) % 997 );
+
+    // In the pits once every 30 laps, for 40 seconds
+    const int stint = (lap + car) % 30;
+    c.onPitRoad = stint == 0 && lapPct < 40.0f / lapTime;
+    c.pitAge = stint;
+}
+
+// The text for one cell, as the standings overlay formats it
+static void formatCell( const BenchCar& c, int col, FormatBuffer& t )
+{
+    switch( col )
+    {
+        case POSITION:      appendPosition( t, c.position ); break;
+        case CAR_NUMBER:    t.ch( L'#' ).chars( c.number ); break;
+        case NAME:          t.chars( c.name ); break;
+        case DELTA:         c.lapDelta < 0 ? appendLapDelta( t, c.lapDelta ) : appendDelta( t, c.delta ); break;
+        case BEST:          if( c.best > 0 ) appendLaptime( t, c.best ); break;
+        case LAST:          if( c.last > 0 ) appendLaptime( t, c.last ); break;
+        case LICENSE:       t.ch( (wchar_t)(unsigned char)c.licenseChar ).ch( L' ' ).fixed( c.licenseSR, 1 ); break;
+        case IRATING:       t.fixed( (float)c.irating/1000.0f, 1 ).ch( L'k' ); break;
+        case PIT:           c.onPitRoad ? t.chars( L"PIT" ) : t.integer( c.pitAge ); break;
+    }
+}
+
+// The raw values the text of a cell is made from. Name and number stand in for the string
+// ids the overlay uses, which don't change within a session string update.
+static CellCache::Key cellKey( const BenchCar& c, int car, int col )
+{
+    switch( col )
+    {
+        case POSITION:      return c.position;
+        case CAR_NUMBER:    return car;
+        case NAME:          return car;
+        case DELTA:         return CellCache::Key( c.lapDelta, CellCache::bits(c.delta) );
+        case BEST:          return CellCache::bits( c.best );
+        case LAST:          return CellCache::bits( c.last );
+        case LICENSE:       return CellCache::Key( c.licenseChar, CellCache::bits(c.licenseSR) );
+        case IRATING:       return c.irating;
+        case PIT:           return CellCache::Key( c.onPitRoad, c.pitAge );
+    }
+    return CellCache::Key();
+}
+
+static int s_format;    // stand in for the text format
+
+// Layouts that are just the length of their text, the lookup is what's measured
+struct BenchLayoutFactory
+{
+    typedef int Format;
+    typedef int Layout;
+
+    Layout* create( const wchar_t*, int len, Format*, float ) { return new int( len ); }
+    void    release( Layout* layout ) { delete layout; }
+};
+
+int cmd_cellbench( int argc, char** argv )
+{
+    const long long numFrames = (long long)getArgDouble( argc, argv, "--frames", 72000 );
+    const int numCars = std::min( 64, getArgInt( argc, argv, "--cars", 64 ) );
+
+    std::vector<BenchCar> cars( numCars );
+    for( int car=0; car<numCars; ++car )
+        initCar( car, cars[car] );
+    CellCache cells( numCars, NUM_COLUMNS );
+    DisplayList dlAll, dlCached;
+    double allSecs = 0, cachedSecs = 0;
+    BenchLayoutFactory layoutFactory;
+    TextLayoutCache<BenchLayoutFactory> layouts;
+    layouts.setFactory( &layoutFactory );
+    double rehashSecs = 0, cellHashSecs = 0;
+    long long layoutSum = 0;
+    std::vector<FormatBuffer*> cellText( numCars * NUM_COLUMNS );
+    long long wrong = 0;
+
+    for( long long frame=0; frame<numFrames; ++frame )
+    {
+        for( int car=0; car<numCars; ++car )
+            updateCar( frame, car, numCars, cars[car] );
+
+        // Every cell formatted
+        auto t0 = std::chrono::steady_clock::now();
+        dlAll.clear();
+        for( int car=0; car<numCars; ++car )
+        {
+            for( int col=0; col<NUM_COLUMNS; ++col )
+            {
+                FormatBuffer t;
+                formatCell( cars[car], col, t );
+                dlAll.text( t.c_str(), &s_format, 16, (float)col*60, (float)col*60+55, car*22.0f, 1 );
+            }
+        }
+        allSecs += std::chrono::duration<double>( std::chrono::steady_clock::now() - t0 ).count();
+
+        // Only the cells that changed formatted
+        t0 = std::chrono::steady_clock::now();
+        dlCached.clear();
+        cells.beginFrame();
+        for( int car=0; car<numCars; ++car )
+        {
+            for( int col=0; col<NUM_COLUMNS; ++col )
+            {
+                FormatBuffer* t;
+                if( !cells.get( car, col, cellKey(cars[car], car, col), t ) )
+                    formatCell( cars[car], col, *t );
+                cellText[car * NUM_COLUMNS + col] = t;
+                dlCached.text( t->c_str(), &s_format, 16, (float)col*60, (float)col*60+55, car*22.0f, 1 );
+            }
+        }
+        cachedSecs += std::chrono::duration<double>( std::chrono::steady_clock::now() - t0 ).count();
+
+        // Every cell's layout, hashing its text again
+        t0 = std::chrono::steady_clock::now();
+        layouts.beginFrame();
+        for( const DisplayList::Cmd& c : dlCached )
+            layoutSum += *layouts.get( dlCached.getText(c), (int)c.textLen, &s_format, c.x1 - c.x0, c.align );
+        rehashSecs += std::chrono::duration<double>( std::chrono::steady_clock::now() - t0 ).count();
+
+        // ...and with the hash the cell kept
+        t0 = std::chrono::steady_clock::now();
+        for( int car=0; car<numCars; ++car )
+        {
+            for( int col=0; col<NUM_COLUMNS; ++col )
+            {
+                const FormatBuffer* t = cellText[car * NUM_COLUMNS + col];
+                layoutSum -= *layouts.get( t->c_str(), t->size(), &s_format, 55, 1, cells.textHash(car, col) );
+            }
+        }
+        cellHashSecs += std::chrono::duration<double>( std::chrono::steady_clock::now() - t0 ).count();
+
+        if( dlAll != dlCached )
+        {
+            if( !wrong )
+                printf( "frame %lld: cached cells differ from freshly formatted ones\n", frame );
+            wrong++;
+        }
+    }
+
+    const CellCache::Stats& st = cells.getStats();
+    printf( "all cells:    %6.2f us/frame, %d cells formatted per frame\n", allSecs * 1e6 / numFrames, numCars * NUM_COLUMNS );
+    printf( "cell cache:   %6.2f us/frame, %.2f cells formatted per frame (%.2f%%)\n",
+        cachedSecs * 1e6 / numFrames, double(st.formatted) / st.frames, 100.0 * st.formatted / st.cells );
+    printf( "layouts:      %6.2f us/frame hashing the text, %6.2f us/frame with the cell's hash\n",
+        rehashSecs * 1e6 / numFrames, cellHashSecs * 1e6 / numFrames );
+    printf( "%lld frames (%.1f h at 60 Hz), %d cars\n", numFrames, numFrames / 216000.0, numCars );
+
+    if( wrong )
+    {
+        printf( "FAILED: %lld frames had cells that differ\n", wrong );
+        return 1;
+    }
+    if( layoutSum )
+    {
+        printf( "FAILED: the cell's hash found different layouts\n" );
+        return 1;
+    }
+    return 0;
+}
+
+#ifdef IRTOOL_CELLBENCH_MAIN
+int main( int argc, char** argv )
+{
+    return cmd_cellbench( argc-1, argv+1 );
+}
+#endif
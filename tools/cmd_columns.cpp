@@ -0,0 +1,210 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <windows.h>
+#include "irtool.h"
+#include "../irsdk/irsdk_defines.h"
+#include "../irsdk/irsdk_diskclient.h"
+#include "../irsdk/irsdk_columns.h"
+#include "../iracing.h"
+#include "../FuelEstimator.h"
+
+static bool endsWith( const std::string& s, const char* suffix )
+{
+    const size_t n = strlen( suffix );
+    return s.length() >= n && _stricmp( s.c_str() + s.length() - n, suffix ) == 0;
+}
+
+static std::vector<std::string> splitList( const char* s )
+{
+    std::vector<std::string> out;
+    std::string cur;
+    for( ; s && *s; ++s )
+    {
+        if( *s == ',' ) {
+            if( !cur.empty() )
+                out.push_back( cur );
+            cur.clear();
+        }
+        else
+            cur += *s;
+    }
+    if( !cur.empty() )
+        out.push_back( cur );
+    return out;
+}
+
+static double secondsSince( const LARGE_INTEGER& start )
+{
+    LARGE_INTEGER now, freq;
+    QueryPerformanceCounter( &now );
+    QueryPerformanceFrequency( &freq );
+    return (double)(now.QuadPart - start.QuadPart) / freq.QuadPart;
+}
+
+// Load a .ibtc as is, or transcode an .ibt keeping only the given vars (all if empty).
+static bool loadColumns( irsdkColumns& columns, const char* path, const std::vector<std::string>& vars )
+{
+    if( endsWith(path, ".ibtc") )
+        return columns.load( path );
+
+    irsdkDiskClient disk;
+    if( !disk.openFile(path) )
+        return false;
+
+    std::vector<const char*> names;
+    for( const std::string& v : vars )
+        names.push_back( v.c_str() );
+
+    return columns.transcode( disk, names.empty() ? nullptr : names.data(), (int)names.size() );
+}
+
+int cmd_transcode( int argc, char** argv )
+{
+    if( argc < 2 || argv[0][0] == '-' || argv[1][0] == '-' )
+    {
+        printf( "usage: irtool transcode <in.ibt> <out.ibtc> [--vars Lap,FuelLevel,...]\n" );
+        return 1;
+    }
+
+    LARGE_INTEGER start;
+    QueryPerformanceCounter( &start );
+
+    irsdkColumns columns;
+    if( !loadColumns(columns, argv[0], splitList(getArg(argc, argv, "--vars", nullptr))) )
+        return 1;
+
+    const double transcodeSecs = secondsSince( start );
+
+    if( !columns.save(argv[1]) )
+        return 1;
+
+    printf( "%d records, %d vars, %d laps, %d sessions, transcoded in %.3f s\n",
+        columns.getRecordCount(), columns.getNumVars(), (int)columns.getLaps().size(), (int)columns.getSessions().size(), transcodeSecs );
+    return 0;
+}
+
+// Per-lap summary of the player's car, with the HUD's fuel estimator replayed over it,
+// and optionally the running order at the end of each session.
+int cmd_laps( int argc, char** argv )
+{
+    if( argc < 1 || argv[0][0] == '-' )
+    {
+        printf( "usage: irtool laps <file.ibt|file.ibtc> [--green-laps-only] [--avg 5] [--standings]\n" );
+        return 1;
+    }
+
+    const std::vector<std::string> vars = {
+        "SessionTime", "FuelLevel", "CarIdxPosition", "CarIdxLap", "CarIdxLapCompleted", "CarIdxLapDistPct"
+    };
+
+    irsdkColumns columns;
+    if( !loadColumns(columns, argv[0], vars) )
+        return 1;
+
+    LARGE_INTEGER start;
+    QueryPerformanceCounter( &start );
+
+    const double* sessionTime = columns.getColumn<double>( "SessionTime", irsdk_double );
+    const float*  fuelLevel   = columns.getColumn<float>( "FuelLevel", irsdk_float );
+    if( !sessionTime || !fuelLevel )
+    {
+        printf( "file has no SessionTime/FuelLevel\n" );
+        return 1;
+    }
+
+    FuelEstimator fuel;
+    fuel.configure( !hasArg(argc, argv, "--green-laps-only"), getArgInt(argc, argv, "--avg", 5) );
+
+    printf( "session  lap      time    used    avg  flags\n" );
+
+    const std::vector<irsdkLapIndex>& laps = columns.getLaps();
+    for( size_t i=0; i<laps.size(); ++i )
+    {
+        const irsdkLapIndex& l = laps[i];
+
+        // the lap ends where the next one starts, or at the end of the session
+        const bool hasNext = i+1 < laps.size() && laps[i+1].sessionNum == l.sessionNum;
+        const int  end     = hasNext ? laps[i+1].firstRecord : l.endRecord-1;
+
+        if( i == 0 || laps[i-1].sessionNum != l.sessionNum )
+            fuel.reset( fuelLevel[l.firstRecord] );
+
+        const double lapTime = sessionTime[end] - sessionTime[l.firstRecord];
+
+        if( hasNext )
+            fuel.onLapChanged( fuelLevel[end], l.sessionFlags, l.onPitRoad );
+
+        printf( "%7d %4d %9s %7.2f %6.2f  %s%s%s\n", l.sessionNum, l.lap, formatLaptime((float)lapTime).c_str(),
+            std::max(0.0f, fuelLevel[l.firstRecord] - fuelLevel[end]), fuel.avgPerLap(),
+            (l.sessionFlags & FuelEstimator::InvalidLapFlags) ? "caution " : "",
+            l.onPitRoad ? "pit " : "",
+            hasNext ? "" : "(partial)" );
+    }
+
+    if( hasArg(argc, argv, "--standings") )
+    {
+        const int*   position = columns.getColumn<int>( "CarIdxPosition", irsdk_int );
+        const int*   carLap   = columns.getColumn<int>( "CarIdxLap", irsdk_int );
+        const int*   carLapC  = columns.getColumn<int>( "CarIdxLapCompleted", irsdk_int );
+        const float* carPct   = columns.getColumn<float>( "CarIdxLapDistPct", irsdk_float );
+        const int    idx      = columns.getVarIdx( "CarIdxPosition" );
+        const int    numCars  = idx >= 0 ? columns.getVarHeader(idx)->count : 0;
+
+        if( !position || !carLap || !carLapC || !carPct )
+        {
+            printf( "\nno CarIdx data in this file\n" );
+        }
+        else
+        {
+            for( const irsdkSessionIndex& s : columns.getSessions() )
+            {
+                const int r = s.endRecord - 1;
+                const size_t row = (size_t)r * numCars;
+
+                std::vector<int> order;
+                for( int c=0; c<numCars; ++c )
+                    if( position[row+c] > 0 )
+                        order.push_back( c );
+                std::sort( order.begin(), order.end(), [&]( int a, int b ) { return position[row+a] < position[row+b]; } );
+
+                printf( "\nsession %d, final order\n", s.sessionNum );
+                for( int c : order )
+                {
+                    const int ldr = order[0];
+                    const int lapDelta = ir_computeLapDelta( std::max(carLap[row+c], carLapC[row+c]), carPct[row+c], std::max(carLap[row+ldr], carLapC[row+ldr]), carPct[row+ldr] );
+                    printf( "  P%-3d car %-3d laps %-4d %+d L\n", position[row+c], c, carLapC[row+c], lapDelta );
+                }
+            }
+        }
+    }
+
+    printf( "\n%d records, %d laps, queried in %.3f ms\n", columns.getRecordCount(), (int)laps.size(), secondsSince(start) * 1000.0 );
+    return 0;
+}
@@ -0,0 +1,355 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <wchar.h>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include "irtool.h"
+#include "../DisplayList.h"
+
+// Display list benchmark.
+//
+// Records what the standings, inputs and HUD overlays draw over a long session into a
+// DisplayList each frame, the way Overlay::update() does, and presents it through
+// DisplayListPresenter to a DisplayListRecorder. Reports how many frames each overlay really
+// had to draw and what recording and comparing the lists costs. Every frame is also compared
+// against a copy kept here, to check that a frame gets skipped exactly when it's identical to
+// the last one drawn, and that the backend got exactly the frame that was recorded. Fails if not.
+//
+// The session alternates between driving and sitting in the pits, where the inputs stay
+// put and the standings only change when someone crosses the line.
+//
+// The overlays here are synthetic: hand-written stand-ins that roughly follow the layout
+// of OverlayStandings, OverlayInputTesting and OverlayHUD and change at made-up rates, so
+// the skip rates they give say as much about the stand-ins as about the presenter. The
+// real overlays need DirectWrite and can't run here. For their real skip rates, turn on
+// General/record_frames, drive or replay a session in iRon, and read the dumps back with
+// --replay, which reports what each overlay drew and skipped up to its last drawn frame.
+//
+// Nothing here needs Windows, so this also builds on its own, e.g. on Linux:
+//   g++ -O2 -std=c++14 -DIRTOOL_DLBENCH_MAIN tools/cmd_dlbench.cpp -o dlbench
+//   ./dlbench --frames 216000 --dump frames.txt
+//   ./dlbench --replay Standings.frames.txt
+
+struct FakeFormat
+{
+    float   size;
+    float   GetFontSize() const { return size; }
+};
+
+struct Rgba
+{
+    float r, g, b, a;
+};
+
+static FakeFormat   s_format = { 16 };
+static FakeFormat   s_formatSmall = { 11 };
+static FakeFormat   s_formatLarge = { 22 };
+static int          s_inputsBoxes;      // stand in for the overlays' box path geometries
+static int          s_hudBoxes;
+
+static const Rgba   TextCol = { 1, 1, 1, 0.9f };
+static const Rgba   HeaderCol = { 0.7f, 0.7f, 0.7f, 0.9f };
+static const Rgba   OutlineCol = { 0.7f, 0.7f, 0.7f, 0.9f };
+static const Rgba   AltLineCol = { 0.5f, 0.5f, 0.5f, 0.08f };
+static const Rgba   BackgroundCol = { 0, 0, 0, 0.7f };
+
+static unsigned nextRand( unsigned& state )
+{
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+// Driving for 20 minutes, then 5 in the pits
+static bool isDriving( long long frame )
+{
+    return frame % (25*3600) < 20*3600;
+}
+
+static void background( DisplayList& dl, float w, float h )
+{
+    dl.clear();
+    dl.setColor( BackgroundCol );
+    dl.fillRoundedRect( 0.5f, 0.5f, w-0.5f, h-0.5f, 6, 6 );
+}
+
+static void recordStandings( long long frame, int numCars, DisplayList& dl )
+{
+    const float w = 600, lineHeight = 22;
+    wchar_t s[64];
+
+    background( dl, w, lineHeight * (numCars + 2) );
+    dl.setColor( HeaderCol );
+    dl.text( L"Pos.", &s_format, 4, 40, 11, 2 );
+    dl.text( L"Driver", &s_format, 90, 290, 11, 0 );
+    dl.text( L"Last", &s_format, 420, 500, 11, 1 );
+    dl.text( L"Delta", &s_format, 510, 590, 11, 1 );
+
+    // Cars run their own lap times and cross the line at different times. While we're in the
+    // pits, the field sits still, as in a practice session between runs.
+    const long long driveFrame = frame / (25*3600) * (20*3600) + std::min( frame % (25*3600), 20LL*3600 );
+    const float secs = driveFrame / 60.0f;
+    for( int car=0; car<numCars; ++car )
+    {
+        const float lapTime = 90.0f + car * 0.37f;
+        const int lap = int( secs / lapTime );
+        unsigned state = (unsigned)(car * 7919 + lap * 104729);
+        const float last = lapTime + (nextRand(state) % 2000) / 1000.0f;
+        const float y = lineHeight * (car + 1.5f);
+
+        if( car & 1 )
+        {
+            dl.setColor( AltLineCol );
+            dl.fillRect( 0, y - lineHeight/2, w, y + lineHeight/2 );
+        }
+
+        dl.setColor( TextCol );
+        swprintf( s, 64, L"P%d", (car + lap/7) % numCars + 1 );
+        dl.text( s, &s_format, 4, 40, y, 1 );
+        dl.fillRoundedRect( 44, y - lineHeight/2 + 1, 86, y + lineHeight/2 - 1, 3, 3 );
+        swprintf( s, 64, L"Driver %d", car + 1 );
+        dl.text( s, &s_format, 90, 290, y, 0 );
+        swprintf( s, 64, L"%d:%06.3f", int(last/60), last - int(last/60)*60 );
+        dl.text( s, &s_format, 420, 500, y, 1 );
+
+        // Gaps to the car ahead go by the tenth, and change a few times a second while driving
+        const float delta = car * 1.7f + 0.1f * float( (driveFrame/15 + car*13) % 40 );
+        swprintf( s, 64, L"%.1f", delta );
+        dl.text( s, &s_format, 510, 590, y, 1 );
+    }
+
+    dl.setColor( Rgba{ 1, 1, 1, 0.4f } );
+    dl.drawLine( 0, lineHeight * (numCars + 1), w, lineHeight * (numCars + 1) );
+}
+
+static void recordInputs( long long frame, DisplayList& dl )
+{
+    wchar_t s[32];
+    background( dl, 300, 120 );
+    dl.setColor( OutlineCol );
+    dl.drawGeometry( &s_inputsBoxes );
+    dl.text( L"Brake", &s_formatSmall, 0, 100, 10, 2 );
+    dl.text( L"Throttle", &s_formatSmall, 100, 200, 10, 2 );
+
+    // Pedals move nearly every frame while driving, and rest in the pits
+    int throttle = 0, brake = 0;
+    if( isDriving(frame) )
+    {
+        unsigned state = (unsigned)(frame / 2);
+        throttle = nextRand(state) % 101;
+        brake = throttle > 50 ? 0 : nextRand(state) % 101;
+    }
+    swprintf( s, 32, L"%d%%", brake );
+    dl.setColor( Rgba{ 0.8f, 0, 0, 0.6f } );
+    dl.text( s, &s_formatLarge, 0, 100, 60, 2 );
+    swprintf( s, 32, L"%d%%", throttle );
+    dl.setColor( Rgba{ 0, 0.8f, 0, 0.6f } );
+    dl.text( s, &s_formatLarge, 100, 200, 60, 2 );
+}
+
+static void recordHud( long long frame, DisplayList& dl )
+{
+    wchar_t s[32];
+    background( dl, 400, 150 );
+    dl.setColor( OutlineCol );
+    dl.drawGeometry( &s_hudBoxes );
+
+    // Clock ticks once a second, fuel readout changes once a lap
+    const int secs = int( frame / 60 );
+    swprintf( s, 32, L"%02d:%02d:%02d", 14 + secs/3600, secs/60 % 60, secs % 60 );
+    dl.setColor( TextCol );
+    dl.text( s, &s_format, 300, 400, 20, 2 );
+    swprintf( s, 32, L"%3.1f lt", 60.0f - 2.5f * float( frame / (92*60) % 24 ) );
+    dl.text( s, &s_format, 0, 150, 40, 1 );
+    dl.setColor( HeaderCol );
+    dl.text( L"Fuel", &s_formatSmall, 0, 150, 5, 2 );
+}
+
+// Outline of a box with a gap for its title at the top, as addBoxFigure() makes them
+static void addBox( std::vector<float>& segs, float x0, float y0, float x1, float y1, float titleWidth )
+{
+    const float hctr = (x0 + x1) * 0.5f;
+    const float pts[] = { hctr - titleWidth/2, y0, x0, y0, x0, y1, x1, y1, x1, y0, hctr + titleWidth/2, y0 };
+    for( int i=0; i+2<12; i+=2 )
+        segs.insert( segs.end(), { pts[i], pts[i+1], pts[i+2], pts[i+3] } );
+}
+
+struct BenchOverlay
+{
+    const char*             name;
+    DisplayList             dl;
+    DisplayList             lastDrawn;      // our own copy, to check the presenter
+    bool                    haveLast = false;
+    DisplayListPresenter    presenter;
+    DisplayListRecorder     recorder;
+    double                  recordSecs = 0;
+    double                  presentSecs = 0;
+    long long               wrong = 0;
+
+    BenchOverlay( const char* _name, FILE* fp ) : name(_name), recorder(fp,_name) {}
+};
+
+// Drawn and skipped frames per overlay, as recorded by iRon with General/record_frames
+static int replayDump( const char* path )
+{
+    FILE* fp = fopen( path, "r" );
+    if( !fp )
+    {
+        printf( "Could not open %s\n", path );
+        return 1;
+    }
+
+    struct Counts
+    {
+        std::string name;
+        long long   drawn = 0;
+        long long   skipped = 0;
+        long long   cmds = 0;
+    };
+    std::vector<Counts> counts;
+
+    DisplayListDumpReader reader( fp );
+    std::string name;
+    DisplayList dl;
+    while( reader.readFrame( name, dl ) )
+    {
+        auto it = std::find_if( counts.begin(), counts.end(), [&]( const Counts& c ) { return c.name == name; } );
+        if( it == counts.end() )
+        {
+            counts.emplace_back();
+            counts.back().name = name;
+            it = counts.end() - 1;
+        }
+        it->drawn++;
+        it->skipped += reader.getSkippedBefore();
+        it->cmds += dl.size();
+    }
+    fclose( fp );
+
+    for( const Counts& c : counts )
+    {
+        const long long frames = c.drawn + c.skipped;
+        printf( "%-10s measured: %lld frames, %lld drawn, %lld skipped (%.1f%%), %.1f commands per drawn frame\n",
+            c.name.empty() ? "(unnamed)" : c.name.c_str(), frames, c.drawn, c.skipped, frames ? 100.0 * c.skipped / frames : 0.0,
+            c.drawn ? double(c.cmds) / c.drawn : 0.0 );
+    }
+    if( counts.empty() )
+        printf( "no frames in %s\n", path );
+    return counts.empty() ? 1 : 0;
+}
+
+int cmd_dlbench( int argc, char** argv )
+{
+    if( const char* replayPath = getArg( argc, argv, "--replay", nullptr ) )
+        return replayDump( replayPath );
+
+    const long long numFrames = (long long)getArgDouble( argc, argv, "--frames", 72000 );
+    const int numCars = getArgInt( argc, argv, "--cars", 40 );
+    const char* dumpPath = getArg( argc, argv, "--dump", nullptr );
+
+    FILE* fp = nullptr;
+    if( dumpPath && !(fp = fopen( dumpPath, "w" )) )
+    {
+        printf( "Could not open %s\n", dumpPath );
+        return 1;
+    }
+
+    BenchOverlay overlays[3] = { { "standings", fp }, { "inputs", fp }, { "hud", fp } };
+
+    std::vector<float> segs;
+    addBox( segs, 5, 10, 95, 110, 40 );
+    addBox( segs, 105, 10, 195, 110, 50 );
+    overlays[1].recorder.defineGeometry( &s_inputsBoxes, segs );
+    segs.clear();
+    addBox( segs, 5, 5, 150, 145, 30 );
+    addBox( segs, 300, 20, 395, 70, 40 );
+    overlays[2].recorder.defineGeometry( &s_hudBoxes, segs );
+    long long wrong = 0;
+
+    for( long long frame=0; frame<numFrames; ++frame )
+    {
+        for( int i=0; i<3; ++i )
+        {
+            BenchOverlay& o = overlays[i];
+
+            const auto t0 = std::chrono::steady_clock::now();
+            if( i == 0 )
+                recordStandings( frame, numCars, o.dl );
+            else if( i == 1 )
+                recordInputs( frame, o.dl );
+            else
+                recordHud( frame, o.dl );
+            o.recordSecs += std::chrono::duration<double>( std::chrono::steady_clock::now() - t0 ).count();
+
+            const DisplayList recorded = o.dl;
+            const long long drawnBefore = o.recorder.getFrames();
+            const auto t1 = std::chrono::steady_clock::now();
+            o.presenter.present( o.dl, o.recorder );
+            o.presentSecs += std::chrono::duration<double>( std::chrono::steady_clock::now() - t1 ).count();
+
+            // Drawn if and only if it differs from what was last drawn, and then exactly what was recorded
+            const bool drawn = o.recorder.getFrames() != drawnBefore;
+            const bool changed = !o.haveLast || recorded != o.lastDrawn;
+            if( drawn != changed || (drawn && o.recorder.getLast() != recorded) )
+                o.wrong++;
+            if( drawn )
+            {
+                o.lastDrawn = recorded;
+                o.haveLast = true;
+            }
+            else
+                o.recorder.skip();
+        }
+    }
+
+    for( BenchOverlay& o : overlays )
+    {
+        const DisplayListPresenter::Stats& st = o.presenter.getStats();
+        printf( "%-10s synthetic: record %6.2f us/frame, present %5.2f us/frame, %lld drawn, %lld skipped (%.1f%%), %.1f commands per drawn frame\n",
+            o.name, o.recordSecs * 1e6 / numFrames, o.presentSecs * 1e6 / numFrames, st.drawn, st.skipped, 100.0 * st.skipped / st.frames,
+            st.drawn ? double(o.recorder.getCommands()) / st.drawn : 0.0 );
+        wrong += o.wrong;
+    }
+    printf( "%lld frames (%.1f h at 60 Hz), %d cars\n", numFrames, numFrames / 216000.0, numCars );
+
+    if( fp )
+        fclose( fp );
+
+    if( wrong )
+    {
+        printf( "FAILED: %lld frames drawn or skipped wrongly\n", wrong );
+        return 1;
+    }
+    return 0;
+}
+
+#ifdef IRTOOL_DLBENCH_MAIN
+int main( int argc, char** argv )
+{
+    return cmd_dlbench( argc-1, argv+1 );
+}
+#endif
@@ -0,0 +1,225 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <wchar.h>
+#include <math.h>
+#include <time.h>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include "irtool.h"
+#include "../ValueFormat.h"
+
+// Overlay text formatting benchmark.
+//
+// Formats the values the HUD and standings show (lap times, deltas, fuel, temperatures,
+// clock and session times, positions, license and iRating) the way the overlays used to,
+// with swprintf, wstringstream and formatLaptime(), and with the append* functions in
+// ValueFormat.h. Reports the time per string for each, and fails if the two ever produce
+// different text.
+//
+// Nothing here needs Windows, so this also builds on its own, e.g. on Linux:
+//   g++ -O2 -std=c++17 -DIRTOOL_FMTBENCH_MAIN tools/cmd_fmtbench.cpp -o fmtbench
+//   ./fmtbench --values 100000
+
+// The old util.h formatLaptime(), which allocated a std::string that then got widened
+static std::string oldFormatLaptime( float secs )
+{
+    char s[32];
+    const int mins = int(secs/60.0f);
+    if( mins )
+        snprintf( s, sizeof(s), "%d:%06.3f", mins, fmodf(secs,60.0f) );
+    else
+        snprintf( s, sizeof(s), "%.03f", secs );
+    return std::string( s );
+}
+
+static std::wstring toWide( const std::string& narrow )
+{
+    return std::wstring( narrow.begin(), narrow.end() );
+}
+
+// Deterministic values in [lo,hi), so every run formats the same strings
+struct Values
+{
+    unsigned    seed = 12345;
+
+    float next( float lo, float hi )
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return lo + (hi - lo) * (float)(seed >> 8) / (float)(1u << 24);
+    }
+};
+
+struct Case
+{
+    const char*         name;
+    // Both write the text for value i into out
+    void (*old)( const float* v, std::wstring& out );
+    void (*now)( const float* v, std::wstring& out );
+    float               lo, hi;     // range of the values
+    double              oldSecs = 0;
+    double              nowSecs = 0;
+    long long           mismatches = 0;
+};
+
+static const bool Imperial = false;
+
+static Case s_cases[] =
+{
+    { "laptime",
+        []( const float* v, std::wstring& out ) { out = toWide( oldFormatLaptime(*v) ); },
+        []( const float* v, std::wstring& out ) { FormatBuffer b; out = appendLaptime( b, *v ).c_str(); },
+        20, 200 },
+    { "delta",
+        []( const float* v, std::wstring& out ) { wchar_t s[32]; swprintf( s, 32, L"%.03f", *v ); out = s; },
+        []( const float* v, std::wstring& out ) { FormatBuffer b; out = appendDelta( b, *v ).c_str(); },
+        -30, 300 },
+    { "lap delta",
+        []( const float* v, std::wstring& out ) { wchar_t s[32]; swprintf( s, 32, L"%d L", (int)*v ); out = s; },
+        []( const float* v, std::wstring& out ) { FormatBuffer b; out = appendLapDelta( b, (int)*v ).c_str(); },
+        -40, 0 },
+    { "fuel",
+        []( const float* v, std::wstring& out ) { wchar_t s[32]; swprintf( s, 32, Imperial ? L"%3.1f gl" : L"%3.1f lt", *v ); out = s; },
+        []( const float* v, std::wstring& out ) { FormatBuffer b; out = appendFuel( b, *v, Imperial ).c_str(); },
+        -5, 120 },
+    { "fuel per lap",
+        []( const float* v, std::wstring& out ) { wchar_t s[64]; swprintf( s, 64, L"%5.2f [%5.2f] lt", v[0], v[1] ); out = s; },
+        []( const float* v, std::wstring& out ) { FormatBuffer b; out = b.fixed( v[0], 2, 5 ).chars( " [" ).fixed( v[1], 2, 5 ).chars( "] lt" ).c_str(); },
+        0, 12 },
+    { "temperature",
+        []( const float* v, std::wstring& out ) { std::wstringstream ss; ss.precision( 3 ); ss << *v; ss << "C"; out = ss.str(); },
+        []( const float* v, std::wstring& out ) { FormatBuffer b; out = appendTemperature( b, *v, false ).c_str(); },
+        -10, 140 },
+    { "clock",
+        []( const float* v, std::wstring& out ) {
+            struct tm t = {};
+            t.tm_hour = (int)*v / 60;
+            t.tm_min = (int)*v % 60;
+            char s[9];
+            strftime( s, sizeof(s), "%H:%M", &t );
+            std::wstringstream ss;
+            ss << s;
+            out = ss.str();
+        },
+        []( const float* v, std::wstring& out ) { FormatBuffer b; out = appendClock( b, (int)*v / 60, (int)*v % 60 ).c_str(); },
+        0, 24*60 },
+    { "session time",
+        []( const float* v, std::wstring& out ) {
+            const double t = *v;
+            std::wstringstream ss;
+            const int hours = int(t / 3600.0);
+            const int mins = int(t / 60.0) % 60;
+            const int secs = (int)fmod(t, 60.0);
+            if( hours )
+                ss << hours << ":";
+            ss << std::setfill(L'0') << std::setw(2) << mins << ":";
+            ss << std::setfill(L'0') << std::setw(2) << secs;
+            out = ss.str();
+        },
+        []( const float* v, std::wstring& out ) { FormatBuffer b; out = appendDuration( b, *v ).c_str(); },
+        0, 6*3600 },
+    { "position",
+        []( const float* v, std::wstring& out ) { wchar_t s[32]; swprintf( s, 32, L"P%d", (int)*v ); out = s; },
+        []( const float* v, std::wstring& out ) { FormatBuffer b; out = appendPosition( b, (int)*v ).c_str(); },
+        1, 64 },
+    { "license",
+        []( const float* v, std::wstring& out ) { wchar_t s[32]; swprintf( s, 32, L"%lc %.1f", L'A', *v ); out = s; },
+        []( const float* v, std::wstring& out ) { FormatBuffer b; out = b.ch( L'A' ).ch( L' ' ).fixed( *v, 1 ).c_str(); },
+        0, 4.99f },
+    { "irating",
+        []( const float* v, std::wstring& out ) { wchar_t s[32]; swprintf( s, 32, L"%.1fk", (float)(int)*v/1000.0f ); out = s; },
+        []( const float* v, std::wstring& out ) { FormatBuffer b; out = b.fixed( (float)(int)*v/1000.0f, 1 ).ch( L'k' ).c_str(); },
+        0, 12000 },
+    { "incidents",
+        []( const float* v, std::wstring& out ) { std::wstringstream ss; ss << (int)*v << "x"; out = ss.str(); },
+        []( const float* v, std::wstring& out ) { FormatBuffer b; out = b.integer( (int)*v ).ch( L'x' ).c_str(); },
+        0, 40 },
+};
+
+int cmd_fmtbench( int argc, char** argv )
+{
+    const int numValues = getArgInt( argc, argv, "--values", 100000 );
+    const int passes = getArgInt( argc, argv, "--passes", 5 );
+
+    // The strings get copied out so the comparison can't be optimized away, which costs the
+    // same for both and is part of both times
+    std::wstring oldOut, nowOut;
+    long long totalMismatches = 0;
+    for( Case& c : s_cases )
+    {
+        Values gen;
+        std::vector<float> values( (size_t)numValues * 2 );
+        for( float& v : values )
+            v = gen.next( c.lo, c.hi );
+
+        for( int pass=0; pass<passes; ++pass )
+        {
+            auto t0 = std::chrono::steady_clock::now();
+            for( int i=0; i<numValues; ++i )
+                c.old( &values[i*2], oldOut );
+            c.oldSecs += std::chrono::duration<double>( std::chrono::steady_clock::now() - t0 ).count();
+
+            t0 = std::chrono::steady_clock::now();
+            for( int i=0; i<numValues; ++i )
+                c.now( &values[i*2], nowOut );
+            c.nowSecs += std::chrono::duration<double>( std::chrono::steady_clock::now() - t0 ).count();
+        }
+
+        for( int i=0; i<numValues; ++i )
+        {
+            c.old( &values[i*2], oldOut );
+            c.now( &values[i*2], nowOut );
+            if( oldOut != nowOut )
+            {
+                if( !c.mismatches )
+                    printf( "%s: %ls instead of %ls for %.9g\n", c.name, nowOut.c_str(), oldOut.c_str(), values[i*2] );
+                c.mismatches++;
+            }
+        }
+        totalMismatches += c.mismatches;
+
+        const double n = (double)numValues * passes;
+        printf( "%-14s old %7.1f ns/string, new %6.1f ns/string (%5.1fx), %lld differ\n",
+            c.name, c.oldSecs * 1e9 / n, c.nowSecs * 1e9 / n, c.oldSecs / c.nowSecs, c.mismatches );
+    }
+
+    if( totalMismatches )
+    {
+        printf( "FAILED: %lld strings differ from the old formatting\n", totalMismatches );
+        return 1;
+    }
+    return 0;
+}
+
+#ifdef IRTOOL_FMTBENCH_MAIN
+int main( int argc, char** argv )
+{
+    return cmd_fmtbench( argc-1, argv+1 );
+}
+#endif
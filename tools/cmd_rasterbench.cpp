@@ -0,0 +1,297 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <algorithm>
+#include <chrono>
+#include "irtool.h"
+#include "../DisplayList.h"
+#include "../DisplayListRaster.h"
+
+// Software raster benchmark.
+//
+// Renders recorded overlay frames with RasterDisplayBackend and reports the time per frame
+// for each overlay at each scale. Frames come from DisplayListRecorder dumps: iRon writes
+// one per overlay with "record_frames" set in the General section (run it against a
+// telemetry file with --replay), and "irtool dlbench --dump" writes stand-ins for the
+// standings, inputs and HUD overlays. The framebuffer for an overlay is as big as its first
+// frame's shapes, times the scale.
+//
+// With --golden, every Nth frame of each overlay is compared against an image in that
+// directory, or written there with --write-golden (the directory has to exist). The run
+// fails if any pixel is off by more than the tolerance in any channel. Images are PAM files
+// (RGB_ALPHA, premultiplied).
+//
+// Nothing here needs Windows, so this also builds on its own, e.g. on Linux:
+//   g++ -O2 -std=c++14 -DIRTOOL_RASTERBENCH_MAIN tools/cmd_rasterbench.cpp DisplayListRaster.cpp -o rasterbench
+//   ./dlbench --frames 3600 --dump frames.txt
+//   mkdir golden && ./rasterbench frames.txt --scale 1,2 --golden golden --write-golden
+
+struct GoldenStats
+{
+    int         compared = 0;
+    int         differ = 0;
+    int         missing = 0;
+    int         written = 0;
+    int         maxDelta = 0;
+    long long   badPixels = 0;
+};
+
+struct RasterTarget
+{
+    float                   scale = 1;
+    RasterDisplayBackend    backend;
+    double                  secs = 0;
+    double                  maxSecs = 0;
+    GoldenStats             golden;
+};
+
+struct RasterOverlay
+{
+    long long                                   frames = 0;
+    std::vector<std::unique_ptr<RasterTarget>>  targets;
+};
+
+static bool writePam( const std::string& path, const RasterDisplayBackend& rb )
+{
+    FILE* fp = fopen( path.c_str(), "wb" );
+    if( !fp )
+        return false;
+    fprintf( fp, "P7\nWIDTH %d\nHEIGHT %d\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n", rb.getWidth(), rb.getHeight() );
+    const size_t sz = (size_t)rb.getWidth() * rb.getHeight() * 4;
+    const bool ok = fwrite( rb.getPixels(), 1, sz, fp ) == sz;
+    fclose( fp );
+    return ok;
+}
+
+static bool readPam( const std::string& path, int& width, int& height, std::vector<uint8_t>& pixels )
+{
+    FILE* fp = fopen( path.c_str(), "rb" );
+    if( !fp )
+        return false;
+
+    char line[256];
+    int depth = 0;
+    width = height = 0;
+    while( fgets( line, sizeof(line), fp ) && strncmp( line, "ENDHDR", 6 ) )
+    {
+        sscanf( line, "WIDTH %d", &width );
+        sscanf( line, "HEIGHT %d", &height );
+        sscanf( line, "DEPTH %d", &depth );
+    }
+    pixels.resize( (size_t)std::max(width,0) * std::max(height,0) * 4 );
+    const bool ok = depth == 4 && fread( pixels.data(), 1, pixels.size(), fp ) == pixels.size();
+    fclose( fp );
+    return ok;
+}
+
+static void checkGolden( const std::string& path, bool write, int tolerance, RasterTarget& t )
+{
+    const RasterDisplayBackend& rb = t.backend;
+    GoldenStats& g = t.golden;
+    if( write )
+    {
+        if( writePam( path, rb ) )
+            g.written++;
+        else
+            printf( "Could not write %s\n", path.c_str() );
+        return;
+    }
+
+    int width = 0, height = 0;
+    std::vector<uint8_t> golden;
+    if( !readPam( path, width, height, golden ) )
+    {
+        g.missing++;
+        return;
+    }
+
+    g.compared++;
+    if( width != rb.getWidth() || height != rb.getHeight() )
+    {
+        printf( "%s: golden image is %dx%d, rendered %dx%d\n", path.c_str(), width, height, rb.getWidth(), rb.getHeight() );
+        g.differ++;
+        return;
+    }
+
+    long long bad = 0;
+    const uint8_t* px = rb.getPixels();
+    for( size_t i=0; i<golden.size(); i+=4 )
+    {
+        int delta = 0;
+        for( int ch=0; ch<4; ++ch )
+            delta = std::max( delta, abs( (int)px[i+ch] - (int)golden[i+ch] ) );
+        g.maxDelta = std::max( g.maxDelta, delta );
+        bad += delta > tolerance;
+    }
+    if( bad )
+    {
+        printf( "%s: %lld pixels differ by more than %d\n", path.c_str(), bad, tolerance );
+        g.differ++;
+        g.badPixels += bad;
+    }
+}
+
+// Size of everything but text, which may run past its column and gets clipped anyway
+static void getExtent( const DisplayList& dl, int& width, int& height )
+{
+    float w = 0, h = 0;
+    for( const DisplayList::Cmd& c : dl )
+    {
+        if( c.op == DisplayList::Op::Text || c.op == DisplayList::Op::DrawGeometry )
+            continue;
+        w = std::max( w, std::max( c.x0, c.x1 ) );
+        h = std::max( h, std::max( c.y0, c.y1 ) );
+    }
+    width = w > 0 ? (int)ceilf( w ) : 400;
+    height = h > 0 ? (int)ceilf( h ) : 300;
+}
+
+int cmd_rasterbench( int argc, char** argv )
+{
+    std::vector<float> scales;
+    for( const char* s = getArg( argc, argv, "--scale", "1" ); *s; )
+    {
+        scales.push_back( (float)atof( s ) );
+        s += strcspn( s, "," );
+        s += *s == ',';
+    }
+    const char* goldenDir = getArg( argc, argv, "--golden", nullptr );
+    const bool writeGolden = hasArg( argc, argv, "--write-golden" );
+    const int every = std::max( 1, getArgInt( argc, argv, "--every", 300 ) );
+    const int tolerance = getArgInt( argc, argv, "--tolerance", 8 );
+
+    std::vector<const char*> files;
+    for( int i=0; i<argc; ++i )
+    {
+        if( argv[i][0] == '-' && argv[i][1] == '-' )
+            i += strcmp( argv[i], "--write-golden" ) != 0;     // skip the option's value
+        else
+            files.push_back( argv[i] );
+    }
+    if( files.empty() )
+    {
+        printf( "No frame dumps given (see irtool dlbench --dump)\n" );
+        return 1;
+    }
+
+    std::map<std::string,RasterOverlay> overlays;
+    DisplayList dl;
+    std::string name;
+    long long undefinedGeometries = 0;
+
+    for( const char* file : files )
+    {
+        FILE* fp = fopen( file, "r" );
+        if( !fp )
+        {
+            printf( "Could not open %s\n", file );
+            return 1;
+        }
+
+        DisplayListDumpReader reader( fp );
+        while( reader.readFrame( name, dl ) )
+        {
+            if( name.empty() )
+                name = "frames";
+            RasterOverlay& o = overlays[name];
+            if( o.targets.empty() )
+            {
+                int width = 0, height = 0;
+                getExtent( dl, width, height );
+                for( float scale : scales )
+                {
+                    o.targets.emplace_back( new RasterTarget );
+                    o.targets.back()->scale = scale;
+                    o.targets.back()->backend.resize( (int)ceilf( width * scale ), (int)ceilf( height * scale ), scale );
+                }
+            }
+
+            for( auto& t : o.targets )
+            {
+                for( const DisplayList::Cmd& c : dl )
+                    if( c.op == DisplayList::Op::DrawGeometry )
+                        if( const std::vector<float>* segments = reader.getGeometry( c.handle ) )
+                            t->backend.defineGeometry( c.handle, *segments );
+
+                const auto t0 = std::chrono::steady_clock::now();
+                t->backend.draw( dl );
+                const double secs = std::chrono::duration<double>( std::chrono::steady_clock::now() - t0 ).count();
+                t->secs += secs;
+                t->maxSecs = std::max( t->maxSecs, secs );
+
+                if( goldenDir && o.frames % every == 0 )
+                {
+                    char path[1024];
+                    snprintf( path, sizeof(path), "%s/%s-%gx-%06lld.pam", goldenDir, name.c_str(), t->scale, o.frames );
+                    checkGolden( path, writeGolden, tolerance, *t );
+                }
+            }
+            o.frames++;
+        }
+        fclose( fp );
+    }
+
+    int differ = 0;
+    for( auto& it : overlays )
+    {
+        for( auto& t : it.second.targets )
+        {
+            const GoldenStats& g = t->golden;
+            printf( "%-18s %4dx%-4d %7lld frames %9.1f us/frame (max %.1f)",
+                it.first.c_str(), t->backend.getWidth(), t->backend.getHeight(), it.second.frames,
+                t->secs * 1e6 / std::max( it.second.frames, 1LL ), t->maxSecs * 1e6 );
+            if( goldenDir && writeGolden )
+                printf( ", %d golden images written", g.written );
+            else if( goldenDir )
+                printf( ", golden: %d compared, %d differ (max delta %d), %d missing", g.compared, g.differ, g.maxDelta, g.missing );
+            printf( "\n" );
+            differ += g.differ;
+            undefinedGeometries += t->backend.getUndefinedGeometries();
+        }
+    }
+    if( undefinedGeometries )
+        printf( "%lld geometries without an outline in the dump were left out\n", undefinedGeometries );
+
+    if( differ )
+    {
+        printf( "FAILED: %d frames differ from their golden images\n", differ );
+        return 1;
+    }
+    return 0;
+}
+
+#ifdef IRTOOL_RASTERBENCH_MAIN
+int main( int argc, char** argv )
+{
+    return cmd_rasterbench( argc-1, argv+1 );
+}
+#endif
@@ -0,0 +1,80 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <windows.h>
+#include "irtool.h"
+#include "../irsdk/irsdk_defines.h"
+#include "../irsdk/irsdk_client.h"
+#include "../iracing.h"
+
+// Feeds a telemetry file through ir_tick() and reports how long it took.
+int cmd_replay( int argc, char** argv )
+{
+    if( argc < 1 || argv[0][0] == '-' )
+    {
+        printf( "usage: irtool replay <file.ibt> [--speed 0] [--tick N | --time S]\n" );
+        return 1;
+    }
+
+    irsdkClient& irsdk = irsdkClient::instance();
+    if( !irsdk.openFile(argv[0]) )
+        return 1;
+
+    irsdk.setPlaybackSpeed( getArgDouble(argc, argv, "--speed", 0.0) );
+
+    if( hasArg(argc, argv, "--tick") && !irsdk.seekToTick(getArgInt(argc, argv, "--tick", 0)) )
+        printf( "could not seek to tick\n" );
+    if( hasArg(argc, argv, "--time") && !irsdk.seekToSessionTime(getArgDouble(argc, argv, "--time", 0.0)) )
+        printf( "could not seek to session time\n" );
+
+    LARGE_INTEGER freq, start, end;
+    QueryPerformanceFrequency( &freq );
+    QueryPerformanceCounter( &start );
+
+    int ticks = 0;
+    int lastTick = -1;
+    while( !irsdk.isFileFinished() )
+    {
+        ir_tick();
+
+        const int tick = ir_SessionTick.getInt();
+        if( tick != lastTick )
+        {
+            lastTick = tick;
+            ticks++;
+        }
+    }
+
+    QueryPerformanceCounter( &end );
+    const double secs = (double)(end.QuadPart - start.QuadPart) / freq.QuadPart;
+
+    printf( "%d records in %.3f s, %.0f records/s, %.2f us per record\n", ticks, secs, ticks / secs, ticks ? secs * 1e6 / ticks : 0.0 );
+
+    ir_syncSession();
+    printf( "ended at session time %.1f s, %s, SoF %d\n", ir_SessionTime.getDouble(), SessionTypeStr[(int)ir_session->sessionType], ir_session->sof );
+
+    irsdk.closeFile();
+    return 0;
+}
@@ -0,0 +1,274 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <vector>
+#include <algorithm>
+#ifdef _WIN32
+#include <conio.h>
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#include "irtool.h"
+#include "../irsdk/irsdk_defines.h"
+#include "../irsdk/irsdk_sim.h"
+#ifdef _WIN32
+#include "../irsdk/irsdk_client.h"
+#include "../iracing.h"
+#endif
+
+// The sim stand-in and the raw reader also run on Linux, so simbench builds on its own there:
+//   g++ -O2 -std=c++17 -DIRTOOL_SIMBENCH_MAIN tools/cmd_sim.cpp irsdk/irsdk_sim.cpp
+//       irsdk/irsdk_sim_posix.cpp irsdk/irsdk_utils.cpp -o simbench -pthread
+//   ./simbench --client raw --rate 360 --seconds 10
+// irsdkClient and ir_tick() need Windows, so the client and tick modes are irtool only.
+
+static irsdkSimConfig simConfigFromArgs( int argc, char** argv )
+{
+    irsdkSimConfig cfg;
+    cfg.tickRate          = getArgInt( argc, argv, "--rate", cfg.tickRate );
+    cfg.numCars           = getArgInt( argc, argv, "--cars", cfg.numCars );
+    cfg.numVars           = getArgInt( argc, argv, "--vars", cfg.numVars );
+    cfg.numBuf            = getArgInt( argc, argv, "--bufs", cfg.numBuf );
+    cfg.numClasses        = getArgInt( argc, argv, "--classes", cfg.numClasses );
+    cfg.teamEvent         = hasArg( argc, argv, "--team" );
+    cfg.sessionNum        = getArgInt( argc, argv, "--session", cfg.sessionNum );
+    cfg.sessionUpdateSecs = getArgInt( argc, argv, "--session-update", cfg.sessionUpdateSecs );
+    return cfg;
+}
+
+#ifdef _WIN32
+static double fileTimeSecs( const FILETIME& ft )
+{
+    return (double)(((unsigned long long)ft.dwHighDateTime << 32) | ft.dwLowDateTime) * 1e-7;
+}
+
+static double threadCpuSecs()
+{
+    FILETIME creation, exited, kernel, user;
+    GetThreadTimes( GetCurrentThread(), &creation, &exited, &kernel, &user );
+    return fileTimeSecs(kernel) + fileTimeSecs(user);
+}
+#else
+static double threadCpuSecs()
+{
+    struct timespec t;
+    clock_gettime( CLOCK_THREAD_CPUTIME_ID, &t );
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+#endif
+
+#ifdef _WIN32
+int cmd_sim( int argc, char** argv )
+{
+    const irsdkSimConfig cfg = simConfigFromArgs( argc, argv );
+
+    irsdkSim sim;
+    if( !sim.start(cfg) )
+        return 1;
+
+    printf( "Publishing %d cars at %d Hz, press any key to stop.\n", cfg.numCars, cfg.tickRate );
+
+    while( !_kbhit() )
+    {
+        Sleep( 1000 );
+        printf( "\rtick %d", sim.getTickCount() );
+    }
+    _getch();
+    printf( "\n" );
+
+    sim.stop();
+    return 0;
+}
+#endif
+
+// Runs the simulator on its own thread and consumes from it on this one, through one of
+// three layers of the client path:
+//
+//   raw     irsdk_waitForDataReady() into a private buffer
+//   client  irsdkClient::waitForData()
+//   tick    ir_tick(), i.e. the whole per-frame telemetry and session update iRon does
+//
+// and reports publish-to-consume latency, dropped ticks and the CPU time spent consuming.
+int cmd_simbench( int argc, char** argv )
+{
+    const irsdkSimConfig cfg     = simConfigFromArgs( argc, argv );
+    const double         seconds = getArgDouble( argc, argv, "--seconds", 10.0 );
+    const std::string    mode    = getArg( argc, argv, "--client", "client" );
+    const bool           partial = hasArg( argc, argv, "--partial" );
+
+#ifdef _WIN32
+    if( mode != "raw" && mode != "client" && mode != "tick" )
+    {
+        printf( "unknown client mode '%s', expected raw, client or tick\n", mode.c_str() );
+        return 1;
+    }
+#else
+    if( mode != "raw" )
+    {
+        printf( "client mode '%s' needs Windows, only raw runs here\n", mode.c_str() );
+        return 1;
+    }
+    (void)partial;
+#endif
+
+    irsdkSim sim;
+    if( !sim.start(cfg) )
+        return 1;
+
+    // the sim's clock, so publish times and ours compare directly
+    const long long freq = irsdkSim::clockFreq();
+    long long       start = 0;
+    long long       now = 0;
+
+    // raw mode reads into its own line copy
+    std::vector<char> rawData;
+    int               rawTickOffset = -1;
+
+    // wait for the connection before starting the clock
+    for( int i=0; i<200 && !irsdk_isConnected(); ++i )
+        irsdk_waitForDataReady( 10, NULL );
+    if( !irsdk_isConnected() )
+    {
+        printf( "could not connect to the simulator\n" );
+        return 1;
+    }
+    if( mode == "raw" )
+    {
+        rawData.resize( irsdk_getHeader()->bufLen );
+        rawTickOffset = irsdk_varNameToOffset( "SessionTick" );
+    }
+
+    std::vector<float> latencyUs;
+    latencyUs.reserve( (size_t)(seconds * cfg.tickRate) + 16 );
+
+    int       firstTick  = -1;
+    int       lastTick   = -1;
+    int       consumed   = 0;
+    int       dropped    = 0;
+    int       wakeups    = 0;
+    const int maxLatency = 1000000;
+
+#ifdef _WIN32
+    irsdkClient::instance().setPartialCopy( partial );
+    irsdkClient::instance().resetCopyStats();
+#endif
+    irsdk_resetReadStats();
+    const double cpuStart = threadCpuSecs();
+    start = irsdkSim::clockNow();
+
+    while( true )
+    {
+        now = irsdkSim::clockNow();
+        if( (double)(now - start) / freq >= seconds )
+            break;
+
+        bool gotData = false;
+        int  tick    = -1;
+
+        if( mode == "raw" )
+        {
+            gotData = irsdk_waitForDataReady( 16, rawData.data() );
+            if( gotData )
+                tick = *(int*)(rawData.data() + rawTickOffset);
+        }
+#ifdef _WIN32
+        else if( mode == "client" )
+        {
+            irsdkClient& client = irsdkClient::instance();
+            gotData = client.waitForData( 16 );
+            if( gotData )
+                tick = client.getVarInt( "SessionTick" );
+        }
+        else
+        {
+            gotData = ir_tick() != ConnectionStatus::DISCONNECTED;
+            if( gotData )
+                tick = ir_SessionTick.getInt();
+        }
+#endif
+
+        now = irsdkSim::clockNow();
+        wakeups++;
+
+        // ir_tick() reports the connection status even when it timed out without new data
+        if( !gotData || tick <= lastTick )
+            continue;
+
+        if( lastTick >= 0 )
+            dropped += tick - lastTick - 1;
+        else
+            firstTick = tick;
+        lastTick = tick;
+        consumed++;
+
+        const long long published = sim.getPublishTime( tick );
+        if( published )
+        {
+            const double us = (double)(now - published) * 1e6 / freq;
+            latencyUs.push_back( (float)std::min(us, (double)maxLatency) );
+        }
+    }
+
+    const double elapsed = (double)(now - start) / freq;
+    const double cpu     = threadCpuSecs() - cpuStart;
+
+    sim.stop();
+
+    std::sort( latencyUs.begin(), latencyUs.end() );
+    auto percentile = [&latencyUs]( double p ) -> float {
+        if( latencyUs.empty() )
+            return 0;
+        return latencyUs[ std::min(latencyUs.size()-1, (size_t)(p * latencyUs.size())) ];
+    };
+
+    const irsdk_readStats* rs = irsdk_getReadStats();
+
+    printf( "mode %s, %d Hz, %d cars, %d vars, %d buffers, %.1f s\n", mode.c_str(), cfg.tickRate, cfg.numCars, irsdk_getHeader() ? irsdk_getHeader()->numVars : cfg.numVars, cfg.numBuf, elapsed );
+    printf( "  ticks     consumed %d (first %d, last %d), dropped %d, wakeups %d\n", consumed, firstTick, lastTick, dropped, wakeups );
+    printf( "  latency   p50 %.1f us, p99 %.1f us, max %.1f us\n", percentile(0.5), percentile(0.99), percentile(1.0) );
+    printf( "  cpu       %.3f s consuming, %.2f%% of one core, %.2f us per tick\n", cpu, 100.0 * cpu / elapsed, consumed ? cpu * 1e6 / consumed : 0.0 );
+    printf( "  reads     %d, torn %d, fallback %d, failed %d\n", rs->reads, rs->tornReads, rs->fallbackReads, rs->failedReads );
+
+#ifdef _WIN32
+    if( mode != "raw" )
+    {
+        const irsdkClient::CopyStats& cs = irsdkClient::instance().getCopyStats();
+        printf( "  copied    %.1f%% of %lld bytes (%d ranges, %d of %d bytes per line)%s\n",
+            cs.bytesFull ? 100.0 * cs.bytesCopied / cs.bytesFull : 0.0, cs.bytesFull, cs.numRanges, cs.rangeBytes,
+            irsdk_getHeader() ? irsdk_getHeader()->bufLen : 0, partial ? "" : ", partial copy off" );
+    }
+#endif
+
+    irsdk_shutdown();
+    return 0;
+}
+
+#ifdef IRTOOL_SIMBENCH_MAIN
+int main( int argc, char** argv )
+{
+    return cmd_simbench( argc-1, argv+1 );
+}
+#endif
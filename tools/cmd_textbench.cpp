@@ -0,0 +1,269 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <wchar.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include "irtool.h"
+#include "../TextLayoutCache.h"
+
+// Text layout cache benchmark.
+//
+// Plays back what the standings overlay draws over a long race (positions, car numbers,
+// names, lap times that change once a lap, deltas that change nearly every frame) through
+// TextLayoutCache with a fake layout factory, and through the scheme TextCache used before:
+// a map keyed by a 32 bit hash only, that never lets go of a layout. Reports time per
+// lookup, hit rate, evictions and how many layouts each ends up holding, and checks that
+// every layout handed out really is for the text, format, width and alignment asked for.
+// Fails if one isn't.
+//
+// Nothing here needs Windows, so this also builds on its own, e.g. on Linux:
+//   g++ -O2 -std=c++14 -DIRTOOL_TEXTBENCH_MAIN tools/cmd_textbench.cpp -o textbench
+//   ./textbench --frames 216000 --cars 60
+
+struct FakeFormat
+{
+    int         id = 0;
+};
+
+struct FakeLayout
+{
+    std::wstring        text;
+    const FakeFormat*   format = nullptr;
+    float               width = 0;
+};
+
+// Layouts that remember what they were made for, and a count of the live ones
+struct FakeLayoutFactory
+{
+    typedef FakeFormat  Format;
+    typedef FakeLayout  Layout;
+
+    int     live = 0;
+    int     peak = 0;
+
+    Layout* create( const wchar_t* str, int len, Format* format, float width )
+    {
+        live++;
+        peak = live > peak ? live : peak;
+        Layout* layout = new Layout;
+        layout->text.assign( str, len );
+        layout->format = format;
+        layout->width = width;
+        return layout;
+    }
+
+    void release( Layout* layout )
+    {
+        live--;
+        delete layout;
+    }
+};
+
+// TextCache before the LRU: keyed by a hash of the key, never released
+class HashOnlyCache
+{
+public:
+
+    ~HashOnlyCache()
+    {
+        for( auto& it : m_cache )
+            m_factory.release( it.second );
+    }
+
+    FakeLayout* get( const wchar_t* str, int len, FakeFormat* format, float width, int align )
+    {
+        unsigned hash = 2166136261u;
+        for( int i=0; i<len; ++i )
+            hash = (hash ^ (unsigned)str[i]) * 16777619u;
+        unsigned widthBits;
+        memcpy( &widthBits, &width, sizeof(widthBits) );
+        hash ^= (unsigned)(size_t)format;
+        hash ^= widthBits;
+        hash ^= (unsigned)align;
+
+        auto it = m_cache.find( hash );
+        if( it != m_cache.end() )
+            return it->second;
+
+        FakeLayout* layout = m_factory.create( str, len, format, width );
+        m_cache.insert( std::make_pair(hash, layout) );
+        return layout;
+    }
+
+    FakeLayoutFactory   m_factory;
+
+private:
+
+    std::unordered_map<unsigned,FakeLayout*>   m_cache;
+};
+
+// One frame's worth of cells, see fillFrame()
+struct Cell
+{
+    wchar_t     text[32];
+    int         len;
+    FakeFormat* format;
+    float       width;
+    int         align;
+};
+
+static unsigned nextRand( unsigned& state )
+{
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+static void formatLapTime( wchar_t* s, size_t n, float t )
+{
+    const int mins = int( t / 60 );
+    swprintf( s, n, L"%d:%06.3f", mins, t - mins*60 );
+}
+
+// What a standings overlay with numCars rows draws in the given frame (60 per second)
+static void fillFrame( long long frame, int numCars, FakeFormat* formats, std::vector<Cell>& cells )
+{
+    cells.clear();
+    auto add = [&]( FakeFormat* format, float width, int align ) -> Cell& {
+        cells.emplace_back();
+        Cell& c = cells.back();
+        c.format = format;
+        c.width = width;
+        c.align = align;
+        return c;
+    };
+
+    const float secs = frame / 60.0f;
+    for( int car=0; car<numCars; ++car )
+    {
+        // Every car runs its own lap time, a few tenths apart
+        const float lapTime = 90.0f + car * 0.37f;
+        const int lap = int( secs / lapTime );
+        unsigned state = (unsigned)(car * 7919 + lap * 104729);
+        const float lastLap = lapTime + (nextRand(state) % 2000) / 1000.0f;
+        const float bestLap = lapTime - 0.5f + (nextRand(state) % 500) / 1000.0f;
+
+        Cell* c = &add( &formats[0], 40, 2 );
+        c->len = swprintf( c->text, 32, L"P%d", (car + lap/7) % numCars + 1 );
+        c = &add( &formats[0], 40, 1 );
+        c->len = swprintf( c->text, 32, L"#%d", car * 3 + 1 );
+        c = &add( &formats[0], 200, 0 );
+        c->len = swprintf( c->text, 32, L"Driver %d", car + 1 );
+        c = &add( &formats[1], 30, 1 );
+        c->len = swprintf( c->text, 32, L"%d", lap );
+        c = &add( &formats[0], 80, 2 );
+        formatLapTime( c->text, 32, lastLap );
+        c->len = (int)wcslen( c->text );
+        c = &add( &formats[0], 80, 2 );
+        formatLapTime( c->text, 32, bestLap );
+        c->len = (int)wcslen( c->text );
+
+        // The gap ahead changes by the tenth, every few frames
+        const float delta = car * 1.7f + 0.1f * float( (frame/5 + car*13) % 40 );
+        c = &add( &formats[0], 60, 2 );
+        c->len = swprintf( c->text, 32, L"%.1f", delta );
+    }
+
+    Cell* c = &add( &formats[0], 300, 0 );
+    c->len = swprintf( c->text, 32, L"SoF: %d", 2500 + int(frame / 216000) );
+}
+
+static bool matches( const FakeLayout* layout, const Cell& c )
+{
+    return layout && layout->format == c.format && layout->width == c.width &&
+           (int)layout->text.size() == c.len && !wmemcmp( layout->text.data(), c.text, c.len );
+}
+
+int cmd_textbench( int argc, char** argv )
+{
+    const long long numFrames = (long long)getArgDouble( argc, argv, "--frames", 72000 );
+    const int numCars = getArgInt( argc, argv, "--cars", 40 );
+    const int capacity = getArgInt( argc, argv, "--capacity", 1024 );
+    const int maxIdleFrames = getArgInt( argc, argv, "--idle", 600 );
+
+    FakeFormat formats[2];
+    formats[1].id = 1;
+    std::vector<Cell> cells;
+
+    FakeLayoutFactory factory;
+    long long wrong = 0, gets = 0;
+    double lruSecs = 0, hashSecs = 0;
+    {
+        TextLayoutCache<FakeLayoutFactory> cache( capacity, maxIdleFrames );
+        cache.setFactory( &factory );
+
+        for( long long frame=0; frame<numFrames; ++frame )
+        {
+            fillFrame( frame, numCars, formats, cells );
+
+            const auto t0 = std::chrono::steady_clock::now();
+            cache.beginFrame();
+            for( const Cell& c : cells )
+                wrong += !matches( cache.get(c.text, c.len, c.format, c.width, c.align), c );
+            lruSecs += std::chrono::duration<double>( std::chrono::steady_clock::now() - t0 ).count();
+            gets += cells.size();
+        }
+
+        const TextLayoutCache<FakeLayoutFactory>::Stats& st = cache.getStats();
+        printf( "lru:       %6.1f ns/get, %.2f%% hits, %lld misses, %lld evicted, %lld expired, %d held (peak %d, capacity %d)\n",
+            lruSecs * 1e9 / gets, 100.0 * st.hits / gets, st.misses, st.evictions, st.expired, st.size, factory.peak, capacity );
+    }
+
+    long long hashWrong = 0;
+    int hashHeld = 0;
+    {
+        HashOnlyCache cache;
+        for( long long frame=0; frame<numFrames; ++frame )
+        {
+            fillFrame( frame, numCars, formats, cells );
+
+            const auto t0 = std::chrono::steady_clock::now();
+            for( const Cell& c : cells )
+                hashWrong += !matches( cache.get(c.text, c.len, c.format, c.width, c.align), c );
+            hashSecs += std::chrono::duration<double>( std::chrono::steady_clock::now() - t0 ).count();
+        }
+        hashHeld = cache.m_factory.live;
+    }
+
+    printf( "hash only: %6.1f ns/get, %d held, %lld wrong layouts\n", hashSecs * 1e9 / gets, hashHeld, hashWrong );
+    printf( "%lld frames (%.1f h at 60 Hz), %d cars, %lld lookups\n", numFrames, numFrames / 216000.0, numCars, gets );
+
+    if( wrong || factory.live )
+    {
+        printf( "FAILED: %lld wrong layouts, %d not released\n", wrong, factory.live );
+        return 1;
+    }
+    return 0;
+}
+
+#ifdef IRTOOL_TEXTBENCH_MAIN
+int main( int argc, char** argv )
+{
+    return cmd_textbench( argc-1, argv+1 );
+}
+#endif
@@ -0,0 +1,396 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <ctype.h>
+#include "irtool.h"
+#include "../irsdk/yaml_parser.h"
+#include "../irsdk/irsdk_yamltree.h"
+#include "../irsdk/irsdk_textscan.h"
+#include "../irsdk/irsdk_sim.h"
+#include "../SessionDecode.h"
+
+// Session string parsing benchmark.
+//
+// Times parseYaml() per query, then irsdkYamlTree parsing and lookups and the whole
+// session decode of ir_tick() at every scan level the cpu supports, over a corpus of
+// session strings.  Also checks that parseYaml() and the tree agree on every query,
+// and fails if they don't.
+//
+// The standard set in tools/corpus (practice, qualify, a 60 car race, multiclass and a
+// team event) is not captured from iRacing: irsdkSim generates it, and --write-corpus
+// writes it again.  It has the layout and the sizes of the real thing, but its values
+// are regular, so it is no stand-in for real captures when the numbers matter.
+//
+// To capture the real thing, run a debug build of iRon through a session.  ir_tick()
+// appends every session string update to sessionYaml.txt in its working directory, and
+// that file can be passed in as it is: files holding several strings that way are split
+// into them, anything else counts as one session string.
+//   irtool yamlbench sessionYaml.txt
+//
+// None of this needs Windows, so it also builds on its own, e.g. on Linux:
+//   g++ -O2 -std=c++17 -DIRTOOL_YAMLBENCH_MAIN tools/cmd_yamlbench.cpp SessionDecode.cpp
+//       irsdk/yaml_parser.cpp irsdk/irsdk_yamltree.cpp irsdk/irsdk_textscan.cpp
+//       irsdk/irsdk_stringarena.cpp irsdk/irsdk_sim.cpp irsdk/irsdk_sim_posix.cpp -o yamlbench
+//   ./yamlbench --corpus tools/corpus
+
+static const char* const CorpusFiles[] =
+{
+    "practice.yaml",
+    "qualify.yaml",
+    "race60.yaml",
+    "multiclass.yaml",
+    "team.yaml",
+};
+
+struct CorpusString
+{
+    std::string name;
+    std::string yaml;
+};
+
+typedef std::chrono::steady_clock Clock;
+
+static double secsSince( Clock::time_point t0 )
+{
+    return std::chrono::duration<double>( Clock::now() - t0 ).count();
+}
+
+// Run fn until minSecs have passed, return seconds per call
+template<typename F>
+static double timeIt( double minSecs, F fn )
+{
+    fn();   // warm up
+
+    int calls = 0;
+    const Clock::time_point t0 = Clock::now();
+    double secs = 0;
+    do
+    {
+        fn();
+        calls++;
+        secs = secsSince( t0 );
+    } while( secs < minSecs );
+    return secs / calls;
+}
+
+static bool sameNoCase( const char* a, const char* b )
+{
+    for( ; *a && *b; ++a, ++b )
+        if( tolower(*a) != tolower(*b) )
+            return false;
+    return *a == *b;
+}
+
+static bool readFile( const char* path, std::string& s )
+{
+    FILE* fp = fopen( path, "rb" );
+    if( !fp )
+        return false;
+
+    char buf[64*1024];
+    size_t n;
+    s.clear();
+    while( (n = fread(buf, 1, sizeof(buf), fp)) > 0 )
+        s.append( buf, n );
+    fclose( fp );
+    return true;
+}
+
+// Split a sessionYaml.txt style capture into its session strings
+static void addCorpusFile( const std::string& name, const std::string& data, std::vector<CorpusString>& corpus )
+{
+    static const char* const Marker = "==== NEW SESSION STRING";
+
+    size_t pos = data.find( Marker );
+    if( pos == std::string::npos )
+    {
+        corpus.push_back( { name, data } );
+        return;
+    }
+
+    int idx = 0;
+    while( pos != std::string::npos )
+    {
+        const size_t start = data.find( '\n', pos );
+        if( start == std::string::npos )
+            break;
+        const size_t next = data.find( Marker, start );
+        std::string yaml = data.substr( start+1, next == std::string::npos ? std::string::npos : next-start-1 );
+
+        // the dump puts two newlines in front of every marker
+        while( !yaml.empty() && yaml.back() == '\n' )
+            yaml.pop_back();
+        yaml += '\n';
+
+        char suffix[16];
+        sprintf( suffix, " #%d", ++idx );
+        corpus.push_back( { name + suffix, yaml } );
+        pos = next;
+    }
+}
+
+// The lookups ir_tick() did per session string update before it went to a tree
+static std::vector<std::string> buildQueries( const irsdkYamlTree& tree )
+{
+    std::vector<std::string> q;
+    char path[256];
+
+    q.push_back( "WeekendInfo:SubSessionID:" );
+    q.push_back( "WeekendInfo:SeriesID:" );
+    q.push_back( "WeekendInfo:WeekendOptions:IsFixedSetup:" );
+    q.push_back( "DriverInfo:DriverCarIdx:" );
+    q.push_back( "DriverInfo:DriverCarFuelMaxLtr:" );
+    q.push_back( "DriverInfo:DriverCarIdleRPM:" );
+    q.push_back( "DriverInfo:DriverCarRedLine:" );
+    q.push_back( "DriverInfo:DriverCarSLFirstRPM:" );
+    q.push_back( "DriverInfo:DriverCarSLShiftRPM:" );
+    q.push_back( "DriverInfo:DriverCarSLLastRPM:" );
+    q.push_back( "DriverInfo:DriverCarSLBlinkRPM:" );
+
+    static const char* const carKeys[] = { "UserName", "CarNumber", "CarNumberRaw", "LicString", "LicColor", "IRating",
+                                           "CarIsPaceCar", "IsSpectator", "CurDriverIncidentCount", "CarClassEstLapTime" };
+    for( int carIdx=0; carIdx<64; ++carIdx )
+    {
+        for( const char* key : carKeys )
+        {
+            sprintf( path, "DriverInfo:Drivers:CarIdx:{%d}%s:", carIdx, key );
+            q.push_back( path );
+        }
+    }
+
+    for( int pos=0; pos<64; ++pos )
+    {
+        sprintf( path, "QualifyResultsInfo:Results:Position:{%d}CarIdx:", pos );
+        q.push_back( path );
+        sprintf( path, "QualifyResultsInfo:Results:Position:{%d}FastestTime:", pos );
+        q.push_back( path );
+    }
+
+    const int sessions = tree.find( "SessionInfo:Sessions:" );
+    int numSessions = 0;
+    for( int n = sessions>=0 ? tree.getNode(sessions).firstChild : -1; n>=0; n = tree.getNode(n).nextSibling )
+        numSessions++;
+
+    for( int session=0; session<numSessions; ++session )
+    {
+        sprintf( path, "SessionInfo:Sessions:SessionNum:{%d}SessionName:", session );
+        q.push_back( path );
+        sprintf( path, "SessionInfo:Sessions:SessionNum:{%d}SessionTime:", session );
+        q.push_back( path );
+        sprintf( path, "SessionInfo:Sessions:SessionNum:{%d}SessionLaps:", session );
+        q.push_back( path );
+        for( int pos=1; pos<=64; ++pos )
+        {
+            sprintf( path, "SessionInfo:Sessions:SessionNum:{%d}ResultsPositions:Position:{%d}CarIdx:", session, pos );
+            q.push_back( path );
+        }
+    }
+    return q;
+}
+
+static int lastSessionNum( const irsdkYamlTree& tree )
+{
+    int sessionNum = 0;
+    const int sessions = tree.find( "SessionInfo:Sessions:" );
+    for( int n = sessions>=0 ? tree.getNode(sessions).firstChild : -1; n>=0; n = tree.getNode(n).nextSibling )
+    {
+        const char* val;
+        int len;
+        if( tree.getVal("SessionNum:", &val, &len, n) )
+            sessionNum = atoi( std::string(val, len).c_str() );
+    }
+    return sessionNum;
+}
+
+static int writeCorpus( const char* dir )
+{
+    struct Entry { const char* file; int cars; int classes; bool team; int sessionNum; double sessionTime; };
+    static const Entry entries[] =
+    {
+        { "practice.yaml",   24, 1, false, 0, 1800 },
+        { "qualify.yaml",    32, 1, false, 1,  900 },
+        { "race60.yaml",     60, 1, false, 2, 2400 },
+        { "multiclass.yaml", 45, 3, false, 2, 2400 },
+        { "team.yaml",       36, 2, true,  2, 5400 },
+    };
+    static_assert( sizeof(entries)/sizeof(entries[0]) == sizeof(CorpusFiles)/sizeof(CorpusFiles[0]), "corpus out of sync" );
+
+    for( const Entry& e : entries )
+    {
+        irsdkSimConfig cfg;
+        cfg.numCars    = e.cars;
+        cfg.numClasses = e.classes;
+        cfg.teamEvent  = e.team;
+        cfg.sessionNum = e.sessionNum;
+        const std::string s = irsdkSim::buildSessionStr( cfg, e.sessionTime );
+
+        const std::string path = std::string(dir) + "/" + e.file;
+        FILE* fp = fopen( path.c_str(), "wb" );
+        if( !fp )
+        {
+            printf( "could not write %s\n", path.c_str() );
+            return 1;
+        }
+        fwrite( s.data(), 1, s.size(), fp );
+        fclose( fp );
+        printf( "wrote %s, %d bytes\n", path.c_str(), (int)s.size() );
+    }
+    return 0;
+}
+
+int cmd_yamlbench( int argc, char** argv )
+{
+    if( hasArg(argc, argv, "--write-corpus") )
+        return writeCorpus( getArg(argc, argv, "--write-corpus", "tools/corpus") );
+
+    const std::string dir = getArg( argc, argv, "--corpus", "tools/corpus" );
+    const double minSecs  = getArgDouble( argc, argv, "--seconds", 0.2 );
+    const char* scanArg   = getArg( argc, argv, "--scan", "all" );
+
+    // corpus: the files given on the command line, or the standard set
+    std::vector<CorpusString> corpus;
+    std::string data;
+    for( int i=0; i<argc; ++i )
+    {
+        if( argv[i][0] == '-' )
+        {
+            ++i;    // skip the option's value
+            continue;
+        }
+        if( readFile(argv[i], data) )
+            addCorpusFile( argv[i], data, corpus );
+        else
+            printf( "could not read %s\n", argv[i] );
+    }
+    if( corpus.empty() )
+    {
+        for( const char* file : CorpusFiles )
+        {
+            if( readFile((dir + "/" + file).c_str(), data) )
+                addCorpusFile( file, data, corpus );
+        }
+    }
+    if( corpus.empty() )
+    {
+        printf( "no session strings in %s\n", dir.c_str() );
+        return 1;
+    }
+
+    // scan levels to run at
+    std::vector<irsdk_ScanLevel> levels;
+    for( int lvl=irsdk_ScanScalar; lvl<=irsdk_getBestScanLevel(); ++lvl )
+    {
+        if( !strcmp(scanArg, "all") || sameNoCase(scanArg, irsdk_getScanLevelStr((irsdk_ScanLevel)lvl)) )
+            levels.push_back( (irsdk_ScanLevel)lvl );
+    }
+
+    int mismatches = 0;
+    for( const CorpusString& cs : corpus )
+    {
+        const char* yaml = cs.yaml.c_str();
+        const double mb = cs.yaml.size() / (1024.0 * 1024.0);
+
+        irsdk_setScanLevel( irsdk_getBestScanLevel() );
+        irsdkYamlTree tree;
+        tree.parse( yaml );
+        const std::vector<std::string> queries = buildQueries( tree );
+
+        printf( "%s: %.1f KB, %d lines, %d nodes, %d queries\n", cs.name.c_str(), cs.yaml.size() / 1024.0,
+                (int)std::count(cs.yaml.begin(), cs.yaml.end(), '\n'), tree.getNumNodes(), (int)queries.size() );
+
+        // both parsers have to find the same thing
+        for( const std::string& q : queries )
+        {
+            const char *a, *b;
+            int lenA, lenB;
+            const bool foundA = parseYaml( yaml, q.c_str(), &a, &lenA );
+            const bool foundB = tree.getVal( q.c_str(), &b, &lenB );
+            if( foundA != foundB || (foundA && (a != b || lenA != lenB)) )
+            {
+                if( mismatches++ < 10 )
+                    printf( "    MISMATCH %s: parseYaml %s '%.*s', tree %s '%.*s'\n", q.c_str(),
+                            foundA ? "found" : "not found", foundA ? lenA : 0, foundA ? a : "",
+                            foundB ? "found" : "not found", foundB ? lenB : 0, foundB ? b : "" );
+            }
+        }
+
+        // parseYaml() is a plain byte loop, the scan level doesn't change it
+        const double tQueries = timeIt( minSecs, [&]() {
+            const char* val;
+            int len;
+            for( const std::string& q : queries )
+                parseYaml( yaml, q.c_str(), &val, &len );
+        });
+        printf( "    %-7s parseYaml    %9.0f ns/query  %8.1f us all queries  %8.1f MB/s\n", "",
+                tQueries * 1e9 / queries.size(), tQueries * 1e6, mb / tQueries );
+
+        for( irsdk_ScanLevel level : levels )
+        {
+            irsdk_setScanLevel( level );
+            const char* lvl = irsdk_getScanLevelStr( level );
+
+            const double tParse = timeIt( minSecs, [&]() { tree.parse( yaml ); } );
+            printf( "    %-7s tree parse                    %8.1f us              %8.1f MB/s\n", lvl,
+                    tParse * 1e6, mb / tParse );
+
+            const double tLookups = timeIt( minSecs, [&]() {
+                const char* val;
+                int len;
+                for( const std::string& q : queries )
+                    tree.getVal( q.c_str(), &val, &len );
+            });
+            printf( "    %-7s tree lookup  %9.0f ns/query  %8.1f us all queries\n", lvl,
+                    tLookups * 1e9 / queries.size(), tLookups * 1e6 );
+
+            // what the session decoder thread does with an update, with every record
+            // new (cold) and with none of them changed (warm)
+            const int sessionNum = lastSessionNum( tree );
+            Session session;
+            const double tCold = timeIt( minSecs, [&]() { ir_decodeSessionStr( yaml, sessionNum, session, true ); } );
+            const double tWarm = timeIt( minSecs, [&]() { ir_decodeSessionStr( yaml, sessionNum, session, false ); } );
+            printf( "    %-7s decode cold                   %8.1f us              %8.1f MB/s\n", lvl, tCold * 1e6, mb / tCold );
+            printf( "    %-7s decode warm                   %8.1f us              %8.1f MB/s\n", lvl, tWarm * 1e6, mb / tWarm );
+        }
+    }
+
+    if( mismatches )
+    {
+        printf( "%d queries where parseYaml and the tree disagree\n", mismatches );
+        return 1;
+    }
+    return 0;
+}
+
+#ifdef IRTOOL_YAMLBENCH_MAIN
+int main( int argc, char** argv )
+{
+    return cmd_yamlbench( argc-1, argv+1 );
+}
+#endif
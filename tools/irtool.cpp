@@ -0,0 +1,87 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "irtool.h"
+
+struct Command
+{
+    const char* name;
+    int         (*fn)( int argc, char** argv );
+    const char* help;
+};
+
+static const Command commands[] =
+{
+    { "sim",        cmd_sim,        "sim [--rate 60] [--cars 20] [--vars 0] [--bufs 3] [--classes 1] [--team] [--session 2]\n"
+                                    "        publish simulated telemetry until a key is pressed" },
+    { "simbench",   cmd_simbench,   "simbench [--rate 60] [--cars 20] [--vars 0] [--seconds 10] [--client raw|client|tick] [--partial]\n"
+                                    "        run the simulator and measure the telemetry client path against it" },
+    { "replay",     cmd_replay,     "replay <file.ibt> [--speed 0] [--tick N | --time S]\n"
+                                    "        feed a telemetry file through ir_tick() and time it" },
+    { "transcode",  cmd_transcode,  "transcode <in.ibt> <out.ibtc> [--vars Lap,FuelLevel,...]\n"
+                                    "        transpose a telemetry file into per-variable columns with a lap index" },
+    { "laps",       cmd_laps,       "laps <file.ibt|file.ibtc> [--green-laps-only] [--avg 5] [--standings]\n"
+                                    "        per-lap times and fuel use, with the HUD's fuel estimate" },
+    { "yamlbench",  cmd_yamlbench,  "yamlbench [files...] [--corpus tools/corpus] [--seconds 0.2] [--scan all|scalar|sse2|avx2] [--write-corpus dir]\n"
+                                    "        time the session string parsers and decode over captured (sessionYaml.txt) or generated session strings" },
+    { "textbench",  cmd_textbench,  "textbench [--frames 72000] [--cars 40] [--capacity 1024] [--idle 600]\n"
+                                    "        play a long race's standings text through the text layout cache" },
+    { "dlbench",    cmd_dlbench,    "dlbench [--frames 72000] [--cars 40] [--dump frames.txt] | --replay <name.frames.txt>\n"
+                                    "        record synthetic overlay frames into display lists and count the ones that need drawing,\n"
+                                    "        or count the frames iRon drew and skipped in a General/record_frames dump" },
+    { "rasterbench", cmd_rasterbench, "rasterbench <frames.txt...> [--scale 1,2] [--golden dir] [--write-golden] [--every 300] [--tolerance 8]\n"
+                                    "        draw recorded overlay frames with the software rasterizer and time them" },
+    { "fmtbench",   cmd_fmtbench,   "fmtbench [--values 100000] [--passes 5]\n"
+                                    "        time overlay number and time formatting against swprintf and wstringstream" },
+    { "cellbench",  cmd_cellbench,  "cellbench [--frames 72000] [--cars 64]\n"
+                                    "        play a race through the standings cells, formatting only the ones that changed" },
+};
+
+static void usage()
+{
+    printf( "usage: irtool <command> [options]\n\n" );
+    for( const Command& c : commands )
+        printf( "    %s\n", c.help );
+}
+
+int main( int argc, char** argv )
+{
+    if( argc < 2 )
+    {
+        usage();
+        return 1;
+    }
+
+    for( const Command& c : commands )
+    {
+        if( !strcmp(argv[1],c.name) )
+            return c.fn( argc-2, argv+2 );
+    }
+
+    printf( "unknown command '%s'\n\n", argv[1] );
+    usage();
+    return 1;
+}
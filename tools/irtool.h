@@ -0,0 +1,74 @@
+/*
+MIT License
+
+Copyright (c) 2021-2022 L. E. Spalt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+// irtool: command line companion to iRon for running the sim stand-in, benchmarks and
+// data conversions without the overlays.  Each command is a cmd_* function taking the
+// arguments that follow the command name.
+
+int cmd_sim( int argc, char** argv );
+int cmd_simbench( int argc, char** argv );
+int cmd_replay( int argc, char** argv );
+int cmd_transcode( int argc, char** argv );
+int cmd_laps( int argc, char** argv );
+int cmd_yamlbench( int argc, char** argv );
+int cmd_textbench( int argc, char** argv );
+int cmd_dlbench( int argc, char** argv );
+int cmd_rasterbench( int argc, char** argv );
+int cmd_fmtbench( int argc, char** argv );
+int cmd_cellbench( int argc, char** argv );
+
+// Returns the value following "name" (e.g. "--rate 360"), or def if it isn't there.
+inline const char* getArg( int argc, char** argv, const char* name, const char* def )
+{
+    for( int i=0; i<argc-1; ++i )
+        if( !strcmp(argv[i],name) )
+            return argv[i+1];
+    return def;
+}
+
+inline int getArgInt( int argc, char** argv, const char* name, int def )
+{
+    const char* s = getArg( argc, argv, name, nullptr );
+    return s ? atoi(s) : def;
+}
+
+inline double getArgDouble( int argc, char** argv, const char* name, double def )
+{
+    const char* s = getArg( argc, argv, name, nullptr );
+    return s ? atof(s) : def;
+}
+
+inline bool hasArg( int argc, char** argv, const char* name )
+{
+    for( int i=0; i<argc; ++i )
+        if( !strcmp(argv[i],name) )
+            return true;
+    return false;
+}
@@ -2,6 +2,7 @@
 
 #include <windows.h>
 #include <string>
+#include <vector>
 #include <dxgi1_6.h>
 #include <d3d11_4.h>
 #include <d2d1_3.h>
@@ -52,26 +53,30 @@ void getDimensions(const int idx, const int totCols, const int divs, const int t
 	offset = (divOffset * divWidth) + (idx + 1) * gap;
 }
 
-void addBoxFigure(TextCache title, Microsoft::WRL::ComPtr<IDWriteTextFormat> textFormat, ID2D1GeometrySink* geometrySink, const Box& box)
+// Outline of a box with a gap for its title at the top. If segments is given, the outline is also
+// appended to it as lines (x0,y0,x1,y1 each), for backends that can't look inside the geometry.
+void addBoxFigure(TextCache& title, Microsoft::WRL::ComPtr<IDWriteTextFormat> textFormat, ID2D1GeometrySink* geometrySink, const Box& box, std::vector<float>* segments = nullptr)
 {
+	std::vector<float2> pts;
 	if (!box.title.empty())
 	{
 		const float hctr = (box.x0 + box.x1) * 0.5f;
 		const float titleWidth = std::min(box.w, 6 + title.getExtent(toWide(box.title).c_str(), textFormat.Get(), box.x0, box.x1, DWRITE_TEXT_ALIGNMENT_CENTER).x);
-		geometrySink->BeginFigure(float2(hctr - titleWidth / 2, box.y0), D2D1_FIGURE_BEGIN_HOLLOW);
-		geometrySink->AddLine(float2(box.x0, box.y0));
-		geometrySink->AddLine(float2(box.x0, box.y1));
-		geometrySink->AddLine(float2(box.x1, box.y1));
-		geometrySink->AddLine(float2(box.x1, box.y0));
-		geometrySink->AddLine(float2(hctr + titleWidth / 2, box.y0));
-		geometrySink->EndFigure(D2D1_FIGURE_END_OPEN);
+		pts = { float2(hctr - titleWidth / 2, box.y0), float2(box.x0, box.y0), float2(box.x0, box.y1), float2(box.x1, box.y1), float2(box.x1, box.y0), float2(hctr + titleWidth / 2, box.y0) };
 	}
 	else
 	{
-		geometrySink->BeginFigure(float2(box.x0, box.y0), D2D1_FIGURE_BEGIN_HOLLOW);
-		geometrySink->AddLine(float2(box.x0, box.y1));
-		geometrySink->AddLine(float2(box.x1, box.y1));
-		geometrySink->AddLine(float2(box.x1, box.y0));
-		geometrySink->EndFigure(D2D1_FIGURE_END_CLOSED);
+		pts = { float2(box.x0, box.y0), float2(box.x0, box.y1), float2(box.x1, box.y1), float2(box.x1, box.y0), float2(box.x0, box.y0) };
+	}
+
+	geometrySink->BeginFigure(pts[0], D2D1_FIGURE_BEGIN_HOLLOW);
+	for (size_t i = 1; i < pts.size(); ++i)
+		geometrySink->AddLine(pts[i]);
+	geometrySink->EndFigure(box.title.empty() ? D2D1_FIGURE_END_CLOSED : D2D1_FIGURE_END_OPEN);
+
+	if (segments)
+	{
+		for (size_t i = 1; i < pts.size(); ++i)
+			segments->insert(segments->end(), { pts[i - 1].x, pts[i - 1].y, pts[i].x, pts[i].y });
 	}
 }
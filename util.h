@@ -33,6 +33,8 @@ SOFTWARE.
 #include <d2d1_3.h>
 #include <dwrite.h>
 #include <unordered_map>
+#include "TextLayoutCache.h"
+#include "VecTypes.h"
 #include <ctype.h>
 
 #define HRCHECK( x_ ) do{ \
@@ -42,32 +44,6 @@ SOFTWARE.
         exit(1); \
     } } while(0)
 
-struct float2
-{
-    union { float r; float x; };
-    union { float g; float y; };
-    float2() = default;
-    float2( float _x, float _y ) : x(_x), y(_y) {}
-    float2( const D2D1_POINT_2F& p ) : x(p.x), y(p.y) {}
-    operator D2D1_POINT_2F() const { return {x,y}; }
-    float* operator&() { return &x; }
-    const float* operator&() const { return &x; }
-};
-
-struct float4
-{
-    union { float r; float x; };
-    union { float g; float y; };
-    union { float b; float z; };
-    union { float a; float w; };
-    float4() = default;
-    float4( float _x, float _y, float _z, float _w ) : x(_x), y(_y), z(_z), w(_w) {}
-    float4( const D2D1_COLOR_F& c ) : r(c.r), g(c.g), b(c.b), a(c.a) {}
-    operator D2D1_COLOR_F() const { return {r,g,b,a}; }
-    float* operator&() { return &x; }
-    const float* operator&() const { return &x; }
-};
-
 inline bool loadFile( const std::string& fname, std::string& output )
 {
     FILE* fp = fopen( fname.c_str(), "rb" );
@@ -266,22 +242,56 @@ inline unsigned int MurmurHash2 ( const void * key, int len, unsigned int seed )
 // End MurmurHash2
 //-----------------------------------------------------------------------------
 
+// Makes DirectWrite text layouts for TextLayoutCache
+struct DWriteLayoutFactory
+{
+    typedef IDWriteTextFormat   Format;
+    typedef IDWriteTextLayout   Layout;
+
+    IDWriteFactory* factory = nullptr;
+
+    // Single-line text, see TextCache::render()
+    Layout* create( const wchar_t* str, int len, Format* format, float width )
+    {
+        IDWriteTextLayout* textLayout = nullptr;
+        if( factory )
+            factory->CreateTextLayout( str, len, format, width, format->GetFontSize()*2, &textLayout );
+        return textLayout;
+    }
+
+    void release( Layout* layout )
+    {
+        layout->Release();
+    }
+};
+
 class TextCache
 {
     public:
 
-        ~TextCache()
+        TextCache()
         {
-            reset();
+            m_cache.setFactory( &m_factory );
         }
 
+        TextCache( const TextCache& ) = delete;
+        TextCache& operator=( const TextCache& ) = delete;
+
         void reset( IDWriteFactory* factory=nullptr )
         {
-            for( auto& it : m_cache )
-                it.second->Release();
-
             m_cache.clear();
-            m_factory = factory;
+            m_factory.factory = factory;
+        }
+
+        // Once per frame, lets go of layouts that haven't been drawn in a while
+        void beginFrame()
+        {
+            m_cache.beginFrame();
+        }
+
+        const TextLayoutCache<DWriteLayoutFactory>::Stats& getStats() const
+        {
+            return m_cache.getStats();
         }
 
         //
@@ -289,22 +299,23 @@ class TextCache
         // This works around spending ungodly amount of CPU cycles on ID2D1RenderTarget::DrawText.
         //
         // Assumption: all values stored in 'textFormat' are invariant between calls to this function, except horizontal alignment.
-        // Which is why we're including alignment in the hash explicitly, and otherwise just include the text format pointer.
+        // Which is why we're including alignment in the key explicitly, and otherwise just include the text format pointer.
         // This isn't bullet proof, since a user could get the same address again for a newly (re-)created text format. But in our usage
         // patterns, recreating text formats always implies nuking this cache anyway, so don't bother with a more complicated design.
         //
         // Assumption: textFormat is set to DWRITE_PARAGRAPH_ALIGNMENT_CENTER, so ycenter +/- fontSize is enough vertical room in all
         // cases. I.e. we only care about rendering single-line text.
         //
-        void render( ID2D1RenderTarget* renderTarget, const wchar_t* str, IDWriteTextFormat* textFormat, float xmin, float xmax, float ycenter, ID2D1SolidColorBrush* brush, DWRITE_TEXT_ALIGNMENT align )
+        // len and textHash (hashLayoutText()) save going over the string again when the caller already has them.
+        //
+        void render( ID2D1RenderTarget* renderTarget, const wchar_t* str, IDWriteTextFormat* textFormat, float xmin, float xmax, float ycenter, ID2D1SolidColorBrush* brush, DWRITE_TEXT_ALIGNMENT align, int len=-1, unsigned long long textHash=0 )
         {
-            IDWriteTextLayout* textLayout = getOrCreateTextLayout( str, textFormat, xmin, xmax, align );
+            IDWriteTextLayout* textLayout = getOrCreateTextLayout( str, textFormat, xmin, xmax, align, len, textHash );
             if( !textLayout )
                 return;
 
             const float fontSize = textFormat->GetFontSize();
 
-            const D2D1_RECT_F r = { xmin, ycenter-fontSize, xmax, ycenter+fontSize };
             renderTarget->DrawTextLayout( float2(xmin,ycenter-fontSize), textLayout, brush, D2D1_DRAW_TEXT_OPTIONS_CLIP );
         }
 
@@ -325,42 +336,22 @@ class TextCache
 
     private:
 
-        IDWriteTextLayout* getOrCreateTextLayout( const wchar_t* str, IDWriteTextFormat* textFormat, float xmin, float xmax, DWRITE_TEXT_ALIGNMENT align )
+        IDWriteTextLayout* getOrCreateTextLayout( const wchar_t* str, IDWriteTextFormat* textFormat, float xmin, float xmax, DWRITE_TEXT_ALIGNMENT align, int len=-1, unsigned long long textHash=0 )
         {
             if( xmax < xmin )
                 return nullptr;
 
-            const float fontSize = textFormat->GetFontSize();
-            const float width = xmax - xmin;
-
             textFormat->SetTextAlignment( align );
 
-            const int len = (int)wcslen( str );
-            unsigned hash = MurmurHash2( str, len*sizeof(wchar_t), 0x12341234 );
-            hash ^= (unsigned)(uint64_t(textFormat) & 0xffffffff);
-            hash ^= (unsigned)(uint64_t(textFormat) >> 32);
-            hash ^= *((unsigned*)&width);
-            hash ^= (unsigned)align;
-
-            IDWriteTextLayout* textLayout = nullptr;
-
-            auto it = m_cache.find( hash );
-
-            if( it == m_cache.end() )
-            {
-                m_factory->CreateTextLayout( str, len, textFormat, width, fontSize*2, &textLayout );
-                m_cache.insert( std::make_pair(hash, textLayout) );
-            }
-            else
-            {
-                textLayout = it->second;
-            }
-
-            return textLayout;
+            if( len < 0 )
+                len = (int)wcslen( str );
+            if( !textHash )
+                textHash = hashLayoutText( str, len );
+            return m_cache.get( str, len, textFormat, xmax - xmin, (int)align, textHash );
         }
 
-        std::unordered_map<unsigned int,IDWriteTextLayout*>  m_cache;
-        IDWriteFactory*                                      m_factory = nullptr;
+        DWriteLayoutFactory                     m_factory;
+        TextLayoutCache<DWriteLayoutFactory>    m_cache;
 };
 
 inline float2 computeTextExtent( const wchar_t* str, IDWriteFactory* factory, IDWriteTextFormat* textFormat )